@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef MIDGARD_BIOMETABLE_HPP
+#define MIDGARD_BIOMETABLE_HPP
+
+#include <RaZ/Data/Image.hpp>
+#include <RaZ/Math/Vector.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/// Range of attributes a biome covers, with the colors & material it gives to the texels in it.
+struct Biome {
+  float minHeight   = 0.f; ///< Minimal height before the terrain's flatness is applied, between 0 & 1, so that the biomes stay put whatever the flatness.
+  float maxHeight   = 1.f; ///< Maximal height before the terrain's flatness is applied, between 0 & 1.
+  float minSlope    = 0.f; ///< Minimal slope strength, as stored in the terrain's slope map.
+  float maxSlope    = std::numeric_limits<float>::max(); ///< Maximal slope strength, as stored in the terrain's slope map.
+  float minMoisture = 0.f; ///< Minimal moisture, between 0 & 1.
+  float maxMoisture = 1.f; ///< Maximal moisture, between 0 & 1.
+  Raz::Vec3b lowColor  = Raz::Vec3b(255); ///< Color at the biome's minimal height.
+  Raz::Vec3b highColor = Raz::Vec3b(255); ///< Color at the biome's maximal height; colors are interpolated linearly in between.
+  uint8_t materialId {};
+};
+
+/// Classifies terrain texels into biomes according to their height, slope strength & moisture.
+/// The biomes are baked into a lookup table, so that classifying a texel is a single fetch, whatever the number of biomes.
+/// The table is stored as a 2D image, each row holding all heights for a given slope & moisture, to be used identically on the CPU & the GPU.
+class BiomeTable {
+public:
+  static constexpr unsigned int heightResolution   = 512;
+  static constexpr unsigned int slopeResolution    = 16;
+  static constexpr unsigned int moistureResolution = 4;
+  static constexpr float maxSlopeStrength          = 2.f; ///< Slope strength of the table's last slope cells; any steeper slope is classified as them.
+
+  /// Creates a table holding the default biomes: water, grass, ground, rock & snow by increasing height, and bare rock on steep slopes.
+  BiomeTable();
+
+  const std::vector<Biome>& getBiomes() const noexcept { return m_biomes; }
+  /// Gets the baked lookup table, whose RGB channels hold the biomes' colors & alpha channel their material IDs.
+  /// \return Lookup table of heightResolution x (slopeResolution * moistureResolution) texels.
+  const Raz::Image& getLookupTable() const noexcept { return m_lookupTable; }
+  /// Checks if any biome depends on the moisture; if none does, the moisture does not need to be computed.
+  /// \return True if the moisture is used, false otherwise.
+  bool isMoistureUsed() const noexcept { return m_isMoistureUsed; }
+  float getMoistureFactor() const noexcept { return m_moistureFactor; }
+
+  /// Sets the biomes to classify texels into, baking the lookup table again. When ranges overlap, the last biome takes precedence.
+  /// Texels in no biome's range are classified as black, with a material ID of 0.
+  /// \param biomes Biomes of the table.
+  void setBiomes(std::vector<Biome> biomes);
+  /// Sets the factor applied to the texels' coordinates before computing the moisture noise.
+  /// \param moistureFactor Moisture noise factor; the lower, the larger the moist & dry areas.
+  void setMoistureFactor(float moistureFactor);
+
+  /// Computes the moisture at the given texel.
+  /// \param x Horizontal texel coordinate.
+  /// \param z Vertical texel coordinate.
+  /// \return Moisture, between 0 & 1.
+  float computeMoisture(float x, float z) const;
+  /// Classifies a texel, fetching its biome's color & material ID in the lookup table.
+  /// \param height Height before the terrain's flatness is applied, between 0 & 1.
+  /// \param slopeStrength Slope strength, as stored in the terrain's slope map.
+  /// \param moisture Moisture, between 0 & 1.
+  /// \return Pointer to the RGB color & material ID of the texel's biome.
+  const uint8_t* classify(float height, float slopeStrength, float moisture) const noexcept {
+    const std::size_t heightIndex   = computeCellIndex(height, heightResolution);
+    const std::size_t slopeIndex    = computeCellIndex(slopeStrength * (1.f / maxSlopeStrength), slopeResolution);
+    const std::size_t moistureIndex = computeCellIndex(moisture, moistureResolution);
+
+    return static_cast<const uint8_t*>(m_lookupTable.getDataPtr()) + ((moistureIndex * slopeResolution + slopeIndex) * heightResolution + heightIndex) * 4;
+  }
+
+private:
+  static std::size_t computeCellIndex(float value, unsigned int resolution) noexcept {
+    const float cellValue = std::min(std::max(value * static_cast<float>(resolution), 0.f), static_cast<float>(resolution - 1));
+    return static_cast<std::size_t>(cellValue);
+  }
+
+  void bake();
+
+  std::vector<Biome> m_biomes {};
+  Raz::Image m_lookupTable {};
+  bool m_isMoistureUsed = false;
+  float m_moistureFactor = 0.002f;
+};
+
+#endif // MIDGARD_BIOMETABLE_HPP
@@ -3,11 +3,21 @@
 #ifndef MIDGARD_DYNAMICTERRAIN_HPP
 #define MIDGARD_DYNAMICTERRAIN_HPP
 
+#include "Midgard/BiomeTable.hpp"
+#include "Midgard/GpuTimer.hpp"
+#include "Midgard/NoiseGraph.hpp"
 #include "Midgard/Terrain.hpp"
 
 #include <RaZ/Render/ShaderProgram.hpp>
 #include <RaZ/Render/Texture.hpp>
 
+#include <string>
+#include <vector>
+
+/// Terrain whose heights are generated on the GPU & applied by tessellation shaders.
+/// It can either cover a fixed area with a single heightmap, or follow the camera as a geometry clipmap: nested rings of patches,
+///  each twice as coarse as the previous one & sampling its own heightmap, which is updated toroidally as the camera moves.
+/// Each level is morphed toward the next coarser one's heights before reaching its border, along which both levels' edges are stitched.
 class DynamicTerrain final : public Terrain {
 public:
   explicit DynamicTerrain(Raz::Entity& entity);
@@ -16,10 +26,40 @@ public:
   const Raz::Texture2D& getNoiseMap() const noexcept { return *m_noiseMap; }
   const Raz::Texture2D& getColorMap() const noexcept { return *m_colorMap; }
   const Raz::Texture2D& getSlopeMap() const noexcept { return *m_slopeMap; }
+  /// Gets the biomes' material IDs of every texel, computed along with the color map.
+  /// \return Single channel texture of material IDs, normalized between 0 & 1.
+  const Raz::Texture2D& getMaterialMap() const noexcept { return *m_materialMap; }
+  const BiomeTable& getBiomeTable() const noexcept { return m_biomeTable; }
+  bool isClipmapEnabled() const noexcept { return m_isClipmapEnabled; }
+  /// Gets the amount of heightmap texels which have been computed by the last clipmap update.
+  /// \return Number of texels updated, for all levels.
+  std::size_t getLastUpdatedTexelCount() const noexcept { return m_lastUpdatedTexelCount; }
+  /// Gets the number of patches sent to the tessellation shaders, for all clipmap levels if enabled.
+  /// \return Number of patches.
+  std::size_t getPatchCount() const;
+  /// Gets the timer measuring the GPU durations of the noise map's computations.
+  /// \return Noise map's timer.
+  GpuTimer& getNoiseMapTimer() noexcept { return m_noiseMapTimer; }
+  GpuTimer& getColorMapTimer() noexcept { return m_colorMapTimer; }
+  GpuTimer& getSlopeMapTimer() noexcept { return m_slopeMapTimer; }
+  /// Gets the timer measuring the GPU durations of the clipmap's updates, each covering the noise & colors of every level's exposed texels.
+  /// \return Clipmap update's timer.
+  GpuTimer& getClipmapUpdateTimer() noexcept { return m_clipmapUpdateTimer; }
 
   void setMinTessellationLevel(float minTessLevel) { setParameters(minTessLevel, m_heightFactor, m_flatness); }
   void setParameters(float heightFactor, float flatness) override { setParameters(m_minTessLevel, heightFactor, flatness); }
   void setParameters(float minTessLevel, float heightFactor, float flatness);
+  /// Sets the biomes from which the color & material maps are computed, uploading the new table & computing these maps again.
+  /// \param biomeTable Biome table to classify the texels with.
+  void setBiomeTable(BiomeTable biomeTable);
+  /// Sets the noise graph the heights are computed from, generating its GLSL function & computing the maps again.
+  /// The graph is evaluated at the texels' coordinates multiplied by the noise factor; by default, it is an 8 octaves Perlin noise.
+  /// \param noiseGraph Noise graph to compute the heights with.
+  template <typename NodeT>
+  void setNoiseGraph(const NodeT& noiseGraph) { setNoiseGraphFunction(NoiseGraph::generateGlsl(noiseGraph)); }
+  /// Sets the GLSL function the heights are computed from, computing the maps again.
+  /// \param noiseGraphFunction Code of a function named computeNoiseGraph, taking the coordinates as a vec2 & returning a float between 0 & 1.
+  void setNoiseGraphFunction(std::string noiseGraphFunction);
 
   /// Generates a dynamic terrain using tessellation shaders.
   /// \param width Width of the terrain.
@@ -35,11 +75,46 @@ public:
   /// \param minTessLevel Minimal tessellation level to render the terrain with.
   void generate(unsigned int width, unsigned int depth, float heightFactor, float flatness, float minTessLevel);
   const Raz::Texture2D& computeNoiseMap(float factor);
+  /// Computes the color & material maps, classifying each texel into a biome according to its height before flattening, slope strength & moisture.
+  /// The slope strengths are read from the slope map, which must thus be computed first whenever the heights change.
+  /// \return Color map.
   const Raz::Texture2D& computeColorMap();
   const Raz::Texture2D& computeSlopeMap();
+  /// Renders the terrain as a geometry clipmap centered on the camera, unbounded in all horizontal directions.
+  /// The levels are only filled when first updated; update() must then be called whenever the camera moves.
+  /// \param levelCount Number of nested levels; the finest covers 80 units & each following one doubles it.
+  void enableClipmap(unsigned int levelCount = 6);
+  /// Renders the terrain over its fixed area again, as before the clipmap was enabled.
+  void disableClipmap();
+  /// Recenters the clipmap's levels on the camera. Only the heightmap texels exposed since the last update are computed,
+  ///  making the cost proportional to the distance traveled; the patches are rebuilt whenever a level's grid is shifted.
+  /// Does nothing if the clipmap is not enabled.
+  /// \param cameraPos Position of the camera.
+  void update(const Raz::Vec3f& cameraPos);
 
 private:
+  struct ClipmapLevel {
+    Raz::Texture2DPtr noiseMap {};
+    Raz::Texture2DPtr colorMap {};
+    Raz::Texture2DPtr materialMap {};
+    Raz::ComputeShaderProgram noiseProgram {};
+    Raz::ComputeShaderProgram colorProgram {};
+    float texelSize {};            ///< World distance between two texels of the level's maps.
+    Raz::Vec2i texelOrigin {};     ///< Coordinates of the first texel held by the maps, in the whole (unbounded) terrain's space.
+    Raz::Vec2f patchGridOrigin {}; ///< World horizontal position of the level's first patch.
+    bool isFilled = false;
+  };
+
+  void setupColorProgram(Raz::ComputeShaderProgram& colorProgram, const Raz::Texture2DPtr& heightmap,
+                         const Raz::Texture2DPtr& colorMap, const Raz::Texture2DPtr& materialMap) const;
+  void sendBiomeAttributes(Raz::ComputeShaderProgram& colorProgram) const;
+  void generateClipmapPatches();
+  /// Computes the noise & colors of a region of a clipmap level, whose coordinates are in texels of the whole terrain's space.
+  void updateClipmapRegion(ClipmapLevel& level, int originX, int originZ, unsigned int width, unsigned int depth);
+
   float m_minTessLevel {};
+  float m_noiseFactor = 0.01f;
+  std::string m_noiseGraphFunction {};
 
   Raz::ComputeShaderProgram m_noiseProgram {};
   Raz::ComputeShaderProgram m_colorProgram {};
@@ -48,6 +123,19 @@ private:
   Raz::Texture2DPtr m_noiseMap {};
   Raz::Texture2DPtr m_colorMap {};
   Raz::Texture2DPtr m_slopeMap {};
+  Raz::Texture2DPtr m_materialMap {};
+
+  BiomeTable m_biomeTable {};
+  Raz::Texture2DPtr m_biomeTableTexture {};
+
+  bool m_isClipmapEnabled = false;
+  std::vector<ClipmapLevel> m_clipmapLevels {};
+  std::size_t m_lastUpdatedTexelCount {};
+
+  GpuTimer m_noiseMapTimer {};
+  GpuTimer m_colorMapTimer {};
+  GpuTimer m_slopeMapTimer {};
+  GpuTimer m_clipmapUpdateTimer {};
 };
 
 #endif // MIDGARD_DYNAMICTERRAIN_HPP
@@ -0,0 +1,69 @@
+#pragma once
+
+#ifndef MIDGARD_FOG_HPP
+#define MIDGARD_FOG_HPP
+
+#include <RaZ/Math/Vector.hpp>
+#include <RaZ/Render/Texture.hpp>
+
+#include <cstdint>
+
+namespace Raz {
+
+class RenderGraph;
+class RenderPass;
+
+} // namespace Raz
+
+enum class FogResolution : uint8_t {
+  FULL,    ///< The fog is evaluated & blended for every pixel in a single pass.
+  HALF,    ///< The fog is evaluated at half the resolution, then upsampled & blended with the scene.
+  QUARTER  ///< The fog is evaluated at a quarter of the resolution, then upsampled & blended with the scene.
+};
+
+/// Fog & sun scattering post-process, added to a render graph after the pass writing the scene's buffers.
+/// At reduced resolutions, the fog is evaluated into its own buffers, then upsampled while taking the scene's depth into account.
+class Fog {
+public:
+  /// Creates the fog's passes & adds them to the render graph as children of the given scene pass, which must write the given buffers.
+  /// \param renderGraph Render graph to add the passes to.
+  /// \param scenePass Pass writing the scene's buffers; usually the render graph's geometry pass.
+  /// \param depthBuffer Depth buffer of the scene.
+  /// \param colorBuffer Color buffer of the scene.
+  /// \param resolution Resolution at which to evaluate the fog.
+  Fog(Raz::RenderGraph& renderGraph, Raz::RenderPass& scenePass, const Raz::Texture2DPtr& depthBuffer, const Raz::Texture2DPtr& colorBuffer,
+      FogResolution resolution = FogResolution::HALF);
+
+  FogResolution getResolution() const noexcept { return m_resolution; }
+
+  /// Sets the resolution at which to evaluate the fog; the fog's buffers are resized accordingly.
+  /// \param resolution Resolution at which to evaluate the fog.
+  void setResolution(FogResolution resolution);
+  void setSunDirection(const Raz::Vec3f& sunDirection);
+  void setDensity(float density);
+  /// Sets the scene's buffers the fog is applied to, replacing those given at construction.
+  /// \param depthBuffer Depth buffer of the scene.
+  /// \param colorBuffer Color buffer of the scene.
+  void setSceneBuffers(const Raz::Texture2DPtr& depthBuffer, const Raz::Texture2DPtr& colorBuffer);
+  /// Resizes the fog's buffers according to the scene's size & the current resolution. Must be called each time the scene's buffers are resized.
+  /// \param width Width of the scene's buffers.
+  /// \param height Height of the scene's buffers.
+  void resizeBuffers(unsigned int width, unsigned int height);
+
+private:
+  Raz::RenderPass& m_fullResPass;
+  Raz::RenderPass& m_scatteringPass;
+  Raz::RenderPass& m_upsamplePass;
+
+  Raz::Texture2DPtr m_sceneDepthBuffer {};
+  Raz::Texture2DPtr m_sceneColorBuffer {};
+
+  Raz::Texture2DPtr m_fogBuffer {};         ///< Low resolution buffer holding the fog's color & amount.
+  Raz::Texture2DPtr m_linearDepthBuffer {}; ///< Low resolution buffer holding the linear depth the fog has been evaluated at.
+
+  FogResolution m_resolution {};
+  unsigned int m_sceneWidth {};
+  unsigned int m_sceneHeight {};
+};
+
+#endif // MIDGARD_FOG_HPP
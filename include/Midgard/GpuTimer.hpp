@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef MIDGARD_GPUTIMER_HPP
+#define MIDGARD_GPUTIMER_HPP
+
+#include "Midgard/TimingHistory.hpp"
+
+#include <deque>
+#include <vector>
+
+/// Measures the GPU duration of commands through timestamp queries, without ever waiting for them.
+/// Each measurement uses its own pair of queries, read back once the GPU has finished with them & then reused; timers can thus be nested or
+///  used several times per frame, their results being available a few frames later.
+class GpuTimer {
+public:
+  GpuTimer() = default;
+  GpuTimer(const GpuTimer&) = delete;
+  /// Moves a timer, taking ownership of all its queries; the moved-from timer is left without any, & thus not running.
+  /// \param timer Timer to be moved.
+  GpuTimer(GpuTimer&& timer) noexcept;
+
+  /// Gets the durations measured so far; only those collected are included.
+  /// \return Timing history of the measurements.
+  const TimingHistory& getHistory() const noexcept { return m_history; }
+  bool isRunning() const noexcept { return m_isRunning; }
+
+  /// Starts a measurement, recording a timestamp once the GPU reaches the commands issued so far. Does nothing if already running.
+  void begin();
+  /// Ends the running measurement, recording a timestamp once the GPU reaches the commands issued so far. Does nothing if not running.
+  void end();
+  /// Adds the measurements finished by the GPU to the history, from the oldest; those still in flight are left for a later call.
+  void collect();
+
+  GpuTimer& operator=(const GpuTimer&) = delete;
+  GpuTimer& operator=(GpuTimer&&) noexcept = delete;
+
+  ~GpuTimer();
+
+private:
+  struct QueryPair {
+    unsigned int beginQuery {};
+    unsigned int endQuery {};
+  };
+
+  std::vector<QueryPair> m_freeQueries {};
+  std::deque<QueryPair> m_pendingQueries {}; ///< Measurements issued & not yet read back, from the oldest.
+  QueryPair m_runningQueries {};
+  bool m_isRunning = false;
+  TimingHistory m_history {};
+};
+
+/// Measures the GPU duration of the commands issued within a scope.
+class ScopedGpuTimer {
+public:
+  explicit ScopedGpuTimer(GpuTimer& timer) : m_timer{ timer } { m_timer.begin(); }
+  ScopedGpuTimer(const ScopedGpuTimer&) = delete;
+  ScopedGpuTimer(ScopedGpuTimer&&) noexcept = delete;
+
+  ScopedGpuTimer& operator=(const ScopedGpuTimer&) = delete;
+  ScopedGpuTimer& operator=(ScopedGpuTimer&&) noexcept = delete;
+
+  ~ScopedGpuTimer() { m_timer.end(); }
+
+private:
+  GpuTimer& m_timer;
+};
+
+#endif // MIDGARD_GPUTIMER_HPP
@@ -0,0 +1,71 @@
+#pragma once
+
+#ifndef MIDGARD_HEADLESSGENERATOR_HPP
+#define MIDGARD_HEADLESSGENERATOR_HPP
+
+#include "Midgard/StaticTerrain.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct HeadlessOptions {
+  unsigned int width = 512;
+  unsigned int depth = 512;
+  float noiseFactor  = 0.01f;
+  int octaveCount    = 8;
+  float heightFactor = 30.f;
+  float flatness     = 3.f;
+  std::string noiseGraph = "perlin"; ///< Noise graph preset to generate the terrain from, among perlin, warped & layered.
+  std::vector<std::string> maps = { "height", "color", "normal", "slope" }; ///< Maps to be exported, among height, color, normal, slope, ao & sun.
+  std::string outputDirectory   = ".";
+  std::size_t threadCount       = 0;  ///< Number of parallel tasks to split the work into; if 0, as many as the system's threads.
+  std::string heightfieldPath {};     ///< Raw 32-bit floating-point heightfield to generate the terrain from, instead of noise.
+  ResidencyPolicy residencyPolicy = ResidencyPolicy::KEEP_CPU_COPIES; ///< Residency policy applied once the maps have been exported.
+  SlopeMapFormat slopeMapFormat   = SlopeMapFormat::RGB_FLOAT;
+  MeshingMode meshingMode         = MeshingMode::UNIFORM_GRID;
+  float maxMeshError              = 0.1f; ///< Maximal vertical error of the adaptive mesh, in world units.
+  bool isUsageRequested = false;      ///< If true, only prints the available arguments.
+  bool isNoiseBenchmarkRequested = false; ///< If true, only compares the evaluation of noise graphs with chained noise calls.
+  bool isMeshErrorCurveRequested = false; ///< If true, only prints the adaptive mesh's triangle count & build time for several maximal errors.
+  bool isVolumetricBenchmarkRequested = false; ///< If true, only prints the volumetric terrain's meshing throughput for several chunk sizes.
+  bool isScatterBenchmarkRequested = false;    ///< If true, only prints the time taken to place & cull a million scattered instances.
+};
+
+/// Generates a static terrain & exports its maps to disk, without any window nor graphics context.
+class HeadlessGenerator {
+public:
+  explicit HeadlessGenerator(HeadlessOptions options) : m_options{ std::move(options) } {}
+
+  /// Checks if the headless mode has been requested on the command line.
+  /// \param argc Number of command-line arguments.
+  /// \param argv Command-line arguments.
+  /// \return True if the --headless argument is present, false otherwise.
+  static bool isRequested(int argc, const char* const* argv) noexcept;
+  /// Parses the command-line arguments into options.
+  /// \param argc Number of command-line arguments.
+  /// \param argv Command-line arguments.
+  /// \return Parsed options.
+  /// \throws std::invalid_argument If an argument is unknown or its value is invalid.
+  static HeadlessOptions parseArguments(int argc, const char* const* argv);
+  static void printUsage();
+
+  /// Generates the terrain & exports the requested maps, printing the duration of each stage & the resulting memory usage.
+  /// \return True if every map has been successfully exported, false otherwise.
+  bool run() const;
+
+private:
+  /// Evaluates warped & layered noises over the terrain's area, both as chained noise calls & as fused noise graphs, printing the time each took.
+  void benchmarkNoise() const;
+  /// Generates the terrain, then builds its adaptive mesh with increasing maximal errors, printing the triangle count & the time each took.
+  void benchmarkMeshing() const;
+  /// Generates a volumetric terrain of the requested size with increasing chunk sizes, printing the time each took & the resulting chunks per second.
+  void benchmarkVolumetric() const;
+  /// Generates the terrain & places about a million instances over it, printing the time the placement & the culling around its center took.
+  void benchmarkScatter() const;
+
+  HeadlessOptions m_options {};
+};
+
+#endif // MIDGARD_HEADLESSGENERATOR_HPP
@@ -0,0 +1,105 @@
+#pragma once
+
+#ifndef MIDGARD_HEIGHTFIELDSOURCE_HPP
+#define MIDGARD_HEIGHTFIELDSOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class HeightfieldSource {
+public:
+  HeightfieldSource(unsigned int width, unsigned int depth) : m_width{ width }, m_depth{ depth } {}
+  HeightfieldSource(const HeightfieldSource&) = delete;
+  HeightfieldSource(HeightfieldSource&&) noexcept = default;
+
+  unsigned int getWidth() const noexcept { return m_width; }
+  unsigned int getDepth() const noexcept { return m_depth; }
+
+  /// Reads a rectangular region of the heightfield.
+  /// \param originX Horizontal index of the region's first texel.
+  /// \param originZ Vertical index of the region's first texel.
+  /// \param width Width of the region.
+  /// \param depth Depth of the region.
+  /// \param heights Array to be filled with normalized heights, row by row; must be able to hold width * depth values.
+  virtual void readRegion(unsigned int originX, unsigned int originZ, unsigned int width, unsigned int depth, float* heights) const = 0;
+  /// Hints that a region is about to be read. Does nothing by default.
+  virtual void prefetchRegion(unsigned int /* originX */, unsigned int /* originZ */, unsigned int /* width */, unsigned int /* depth */) const {}
+  /// Hints that a region will not be read anytime soon, allowing its memory to be reclaimed. Does nothing by default.
+  virtual void releaseRegion(unsigned int /* originX */, unsigned int /* originZ */, unsigned int /* width */, unsigned int /* depth */) const {}
+
+  HeightfieldSource& operator=(const HeightfieldSource&) = delete;
+  HeightfieldSource& operator=(HeightfieldSource&&) noexcept = delete;
+
+  virtual ~HeightfieldSource() = default;
+
+protected:
+  unsigned int m_width {};
+  unsigned int m_depth {};
+};
+
+enum class HeightfieldFormat : uint8_t {
+  UINT16, ///< Unsigned 16-bit integer heights.
+  FLOAT32 ///< 32-bit floating-point heights.
+};
+
+/// Heightfield source reading a raw file through memory mapping; only the pages actually accessed are loaded in memory.
+/// The file can either be stored row by row, or as square tiles stored one after the other, each tile being itself stored row by row.
+class MappedHeightfield final : public HeightfieldSource {
+public:
+  /// Creates a memory-mapped heightfield source.
+  /// \param filePath Path to the raw heightfield file.
+  /// \param width Width of the heightfield.
+  /// \param depth Depth of the heightfield.
+  /// \param format Format of each height in the file.
+  /// \param tileSize Size of the square tiles the file is made of; 0 if the file is stored row by row.
+  MappedHeightfield(const std::string& filePath, unsigned int width, unsigned int depth, HeightfieldFormat format, unsigned int tileSize = 0);
+  MappedHeightfield(MappedHeightfield&&) noexcept = delete;
+
+  /// Sets the range of raw values in the file, used to normalize heights. Defaults to [0; 65535] for 16-bit integers & [0; 1] for floats.
+  /// \param minHeight Raw value mapped to a normalized height of 0.
+  /// \param maxHeight Raw value mapped to a normalized height of 1.
+  void setHeightRange(float minHeight, float maxHeight);
+  /// Sets the number of tile rows to be prefetched past the regions being read.
+  /// \param readAheadTileCount Number of tile rows to read ahead; 0 disables read-ahead.
+  void setReadAheadTileCount(unsigned int readAheadTileCount) noexcept { m_readAheadTileCount = readAheadTileCount; }
+
+  void readRegion(unsigned int originX, unsigned int originZ, unsigned int width, unsigned int depth, float* heights) const override;
+  void prefetchRegion(unsigned int originX, unsigned int originZ, unsigned int width, unsigned int depth) const override;
+  void releaseRegion(unsigned int originX, unsigned int originZ, unsigned int width, unsigned int depth) const override;
+
+  MappedHeightfield& operator=(MappedHeightfield&&) noexcept = delete;
+
+  ~MappedHeightfield() override;
+
+private:
+  enum class PageAdvice : uint8_t { PREFETCH, RELEASE };
+
+  /// Applies an advice to every tile overlapped by the given region, or to the region's span in each row if the file is stored row by row.
+  void adviseRegion(unsigned int originX, unsigned int originZ, unsigned int width, unsigned int depth, PageAdvice advice) const;
+  /// Applies an advice to the pages containing the given byte range.
+  void adviseBytes(std::size_t byteOffset, std::size_t byteCount, PageAdvice advice) const;
+  std::size_t computeByteOffset(unsigned int x, unsigned int z) const noexcept;
+
+  HeightfieldFormat m_format {};
+  std::size_t m_heightSize {};
+  unsigned int m_tileSize {};
+  unsigned int m_tileCountX {};
+  unsigned int m_readAheadTileCount = 1;
+
+  float m_minHeight {};
+  float m_invHeightRange {};
+
+  const std::byte* m_data {};
+  std::size_t m_dataSize {};
+  std::size_t m_pageSize {};
+
+#if defined(MIDGARD_PLATFORM_WINDOWS)
+  void* m_fileHandle {};
+  void* m_mappingHandle {};
+#else
+  int m_fileDescriptor = -1;
+#endif
+};
+
+#endif // MIDGARD_HEIGHTFIELDSOURCE_HPP
@@ -0,0 +1,394 @@
+#pragma once
+
+#ifndef MIDGARD_NOISEGRAPH_HPP
+#define MIDGARD_NOISEGRAPH_HPP
+
+#include <RaZ/Math/PerlinNoise.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/// Composable noise functions, built as a graph of sources (Perlin, simplex, ridged & billow fBm) & operators (warp, add, scale, pow & clamp).
+/// Each node's type holds the whole subgraph below it, so that evaluating a graph compiles into a single fused function per sample, with no
+///  intermediate buffer nor indirection; the same graph can also be turned into GLSL, to be evaluated by compute shaders.
+/// The Perlin-based sources are evaluated with RaZ's Perlin noise, which the shaders' noise functions mirror. RaZ having no simplex noise, the
+///  simplex source looks up the same permutations & gradients itself, so that both give the same values.
+namespace NoiseGraph {
+
+namespace Detail {
+
+// RaZ's permutations & gradients, which its Perlin noise does not expose
+
+constexpr std::array<uint8_t, 256> permutations = {
+  151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225, 140, 36, 103, 30, 69, 142,
+  8, 99, 37, 240, 21, 10, 23, 190, 6, 148, 247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203, 117,
+  35, 11, 32, 57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175, 74, 165, 71,
+  134, 139, 48, 27, 166, 77, 146, 158, 231, 83, 111, 229, 122, 60, 211, 133, 230, 220, 105, 92, 41,
+  55, 46, 245, 40, 244, 102, 143, 54, 65, 25, 63, 161, 1, 216, 80, 73, 209, 76, 132, 187, 208, 89,
+  18, 169, 200, 196, 135, 130, 116, 188, 159, 86, 164, 100, 109, 198, 173, 186, 3, 64, 52, 217, 226,
+  250, 124, 123, 5, 202, 38, 147, 118, 126, 255, 82, 85, 212, 207, 206, 59, 227, 47, 16, 58, 17, 182,
+  189, 28, 42, 223, 183, 170, 213, 119, 248, 152, 2, 44, 154, 163, 70, 221, 153, 101, 155, 167, 43,
+  172, 9, 129, 22, 39, 253, 19, 98, 108, 110, 79, 113, 224, 232, 178, 185, 112, 104, 218, 246, 97,
+  228, 251, 34, 242, 193, 238, 210, 144, 12, 191, 179, 162, 241, 81, 51, 145, 235, 249, 14, 239,
+  107, 49, 192, 214, 31, 181, 199, 106, 157, 184, 84, 204, 176, 115, 121, 50, 45, 127, 4, 150, 254,
+  138, 236, 205, 93, 222, 114, 67, 29, 24, 72, 243, 141, 128, 195, 78, 66, 215, 61, 156, 180
+};
+
+constexpr std::array<std::array<float, 2>, 8> gradients = {{
+  {          1.f,           0.f }, {          -1.f,           0.f },
+  {          0.f,           1.f }, {           0.f,          -1.f },
+  { 0.7071067691f,  0.7071067691f }, { -0.7071067691f,  0.7071067691f },
+  { 0.7071067691f, -0.7071067691f }, { -0.7071067691f, -0.7071067691f }
+}};
+
+/// Computes the dot product between the pseudo-random gradient of a lattice point & the given offset from it.
+inline float computeGradientDot(int x, int y, float offsetX, float offsetY) noexcept {
+  const std::array<float, 2>& gradient = gradients[permutations[static_cast<std::size_t>((permutations[static_cast<std::size_t>(x & 255)] + y) & 255)] % gradients.size()];
+  return gradient[0] * offsetX + gradient[1] * offsetY;
+}
+
+inline float computeSimplex(float x, float y) noexcept {
+  constexpr float skewFactor   = 0.3660254038f; // (sqrt(3) - 1) / 2
+  constexpr float unskewFactor = 0.2113248654f; // (3 - sqrt(3)) / 6
+
+  // Recovering the simplex cell the coordinates are in, & their offset from its first corner
+  const float skew   = (x + y) * skewFactor;
+  const float floorX = std::floor(x + skew);
+  const float floorY = std::floor(y + skew);
+  const auto intX    = static_cast<int>(floorX);
+  const auto intY    = static_cast<int>(floorY);
+  const float unskew = (floorX + floorY) * unskewFactor;
+
+  const float offsetX0 = x - (floorX - unskew);
+  const float offsetY0 = y - (floorY - unskew);
+
+  // The cell being a triangle, its middle corner depends on the half of the skewed square the coordinates are in
+  const int middleX = (offsetX0 > offsetY0 ? 1 : 0);
+  const int middleY = 1 - middleX;
+
+  const float offsetX1 = offsetX0 - static_cast<float>(middleX) + unskewFactor;
+  const float offsetY1 = offsetY0 - static_cast<float>(middleY) + unskewFactor;
+  const float offsetX2 = offsetX0 - 1.f + 2.f * unskewFactor;
+  const float offsetY2 = offsetY0 - 1.f + 2.f * unskewFactor;
+
+  const int x0 = intX & 255;
+  const int y0 = intY & 255;
+
+  const auto computeContribution = [] (int cornerX, int cornerY, float offsetX, float offsetY) noexcept {
+    const float attenuation = 0.5f - offsetX * offsetX - offsetY * offsetY;
+    return (attenuation > 0.f ? attenuation * attenuation * attenuation * attenuation * computeGradientDot(cornerX, cornerY, offsetX, offsetY) : 0.f);
+  };
+
+  // Scaling the sum so that it roughly covers [-1; 1], the gradients being of unit length
+  return 99.2f * (computeContribution(x0, y0, offsetX0, offsetY0)
+                + computeContribution(x0 + middleX, y0 + middleY, offsetX1, offsetY1)
+                + computeContribution(x0 + 1, y0 + 1, offsetX2, offsetY2));
+}
+
+/// Sums octaves of a basis function, each one at twice the frequency & half the amplitude of the previous one.
+/// \return Sum of the octaves, along with the sum of their amplitudes.
+template <typename BasisFuncT>
+std::pair<float, float> accumulateOctaves(float x, float z, int octaveCount, BasisFuncT&& basisFunc) noexcept {
+  float frequency    = 1.f;
+  float amplitude    = 1.f;
+  float total        = 0.f;
+  float amplitudeSum = 0.f;
+
+  for (int octaveIndex = 0; octaveIndex < octaveCount; ++octaveIndex) {
+    total        += basisFunc(x * frequency, z * frequency) * amplitude;
+    amplitudeSum += amplitude;
+
+    frequency *= 2.f;
+    amplitude *= 0.5f;
+  }
+
+  return { total, amplitudeSum };
+}
+
+} // namespace Detail
+
+/// Straight-line GLSL code being generated from a graph, each node storing its result in a new variable.
+class GlslBuilder {
+public:
+  const std::string& getCode() const noexcept { return m_code; }
+
+  /// Adds a variable holding the given expression.
+  /// \param type GLSL type of the variable.
+  /// \param expression Expression to initialize the variable with.
+  /// \return Name of the variable.
+  std::string addVariable(std::string_view type, const std::string& expression) {
+    std::string name = (type == "vec2" ? "coords" : "value") + std::to_string(m_variableCount++);
+    m_code += "  " + std::string(type) + ' ' + name + " = " + expression + ";\n";
+    return name;
+  }
+
+  /// Formats a float as a GLSL literal, keeping every significant digit.
+  /// \param value Value to be formatted.
+  /// \return GLSL float literal.
+  static std::string formatFloat(float value) {
+    std::ostringstream stream;
+    stream.imbue(std::locale::classic());
+    stream << std::showpoint << std::setprecision(9) << value;
+    return stream.str();
+  }
+
+private:
+  std::string m_code {};
+  std::size_t m_variableCount {};
+};
+
+///////////
+// Nodes //
+///////////
+
+// Each node evaluates its value at the given coordinates, & appends the GLSL code computing it, returning the variable holding it
+
+/// Perlin noise fBm, between 0 & 1.
+struct Perlin {
+  float frequency = 1.f;
+  int octaveCount = 8;
+
+  float evaluate(float x, float z) const noexcept {
+    return Raz::PerlinNoise::compute2D(x * frequency, z * frequency, octaveCount, true);
+  }
+
+  std::string generateGlsl(GlslBuilder& builder, const std::string& coords) const {
+    return builder.addVariable("float", "computeFbm(" + coords + " * " + GlslBuilder::formatFloat(frequency) + ", " + std::to_string(octaveCount) + ')');
+  }
+};
+
+/// Simplex noise fBm, between 0 & 1; cheaper than Perlin's for a similar look, & free of its axis-aligned artifacts.
+struct Simplex {
+  float frequency = 1.f;
+  int octaveCount = 8;
+
+  float evaluate(float x, float z) const noexcept {
+    const float total = Detail::accumulateOctaves(x * frequency, z * frequency, octaveCount, Detail::computeSimplex).first;
+    return (total + 1.f) * 0.5f;
+  }
+
+  std::string generateGlsl(GlslBuilder& builder, const std::string& coords) const {
+    return builder.addVariable("float", "computeSimplexFbm(" + coords + " * " + GlslBuilder::formatFloat(frequency) + ", " + std::to_string(octaveCount) + ')');
+  }
+};
+
+/// Ridged multifractal-like fBm, between 0 & 1, forming sharp crests where Perlin noise crosses 0.
+struct Ridged {
+  float frequency = 1.f;
+  int octaveCount = 8;
+
+  float evaluate(float x, float z) const noexcept {
+    const auto [total, amplitudeSum] = Detail::accumulateOctaves(x * frequency, z * frequency, octaveCount, [] (float octaveX, float octaveZ) noexcept {
+      const float ridge = 1.f - std::abs(Raz::PerlinNoise::compute2D(octaveX, octaveZ));
+      return ridge * ridge;
+    });
+
+    return total / amplitudeSum;
+  }
+
+  std::string generateGlsl(GlslBuilder& builder, const std::string& coords) const {
+    return builder.addVariable("float", "computeRidgedFbm(" + coords + " * " + GlslBuilder::formatFloat(frequency) + ", " + std::to_string(octaveCount) + ')');
+  }
+};
+
+/// Billowy fBm, between 0 & 1, forming rounded bumps from the absolute value of Perlin noise.
+struct Billow {
+  float frequency = 1.f;
+  int octaveCount = 8;
+
+  float evaluate(float x, float z) const noexcept {
+    const auto [total, amplitudeSum] = Detail::accumulateOctaves(x * frequency, z * frequency, octaveCount, [] (float octaveX, float octaveZ) noexcept {
+      return std::abs(Raz::PerlinNoise::compute2D(octaveX, octaveZ));
+    });
+
+    return total / amplitudeSum;
+  }
+
+  std::string generateGlsl(GlslBuilder& builder, const std::string& coords) const {
+    return builder.addVariable("float", "computeBillowFbm(" + coords + " * " + GlslBuilder::formatFloat(frequency) + ", " + std::to_string(octaveCount) + ')');
+  }
+};
+
+/// Evaluates a node at coordinates displaced by the value of another one.
+/// The offset node is evaluated twice, the second time at shifted coordinates so that both axes are displaced independently. Its value being
+///  between 0 & 1, each displacement is centered around 0, so that the coordinates do not all drift in the same direction.
+template <typename SourceT, typename OffsetT>
+struct Warp {
+  SourceT source;
+  OffsetT offset;
+  float strength = 1.f;
+
+  // Shift of the coordinates the depth displacement is evaluated at, far enough for both displacements to be decorrelated
+  static constexpr float decorrelationShiftX = 5.2f;
+  static constexpr float decorrelationShiftZ = 1.3f;
+
+  float evaluate(float x, float z) const noexcept {
+    const float displacementX = (offset.evaluate(x, z) - 0.5f) * strength;
+    const float displacementZ = (offset.evaluate(x + decorrelationShiftX, z + decorrelationShiftZ) - 0.5f) * strength;
+    return source.evaluate(x + displacementX, z + displacementZ);
+  }
+
+  std::string generateGlsl(GlslBuilder& builder, const std::string& coords) const {
+    const std::string shiftedCoords = builder.addVariable("vec2", coords + " + vec2(" + GlslBuilder::formatFloat(decorrelationShiftX) + ", "
+                                                                                      + GlslBuilder::formatFloat(decorrelationShiftZ) + ')');
+    const std::string displacementX = offset.generateGlsl(builder, coords);
+    const std::string displacementZ = offset.generateGlsl(builder, shiftedCoords);
+    const std::string warpedCoords  = builder.addVariable("vec2", coords + " + (vec2(" + displacementX + ", " + displacementZ + ") - 0.5) * "
+                                                                + GlslBuilder::formatFloat(strength));
+    return source.generateGlsl(builder, warpedCoords);
+  }
+};
+
+template <typename LeftT, typename RightT>
+struct Add {
+  LeftT left;
+  RightT right;
+
+  float evaluate(float x, float z) const noexcept { return left.evaluate(x, z) + right.evaluate(x, z); }
+
+  std::string generateGlsl(GlslBuilder& builder, const std::string& coords) const {
+    const std::string leftValue  = left.generateGlsl(builder, coords);
+    const std::string rightValue = right.generateGlsl(builder, coords);
+    return builder.addVariable("float", leftValue + " + " + rightValue);
+  }
+};
+
+template <typename SourceT>
+struct Scale {
+  SourceT source;
+  float factor = 1.f;
+
+  float evaluate(float x, float z) const noexcept { return source.evaluate(x, z) * factor; }
+
+  std::string generateGlsl(GlslBuilder& builder, const std::string& coords) const {
+    return builder.addVariable("float", source.generateGlsl(builder, coords) + " * " + GlslBuilder::formatFloat(factor));
+  }
+};
+
+/// Raises a node's value to a power; negative values are clamped to 0 beforehand.
+template <typename SourceT>
+struct Pow {
+  SourceT source;
+  float exponent = 1.f;
+
+  float evaluate(float x, float z) const noexcept { return std::pow(std::max(source.evaluate(x, z), 0.f), exponent); }
+
+  std::string generateGlsl(GlslBuilder& builder, const std::string& coords) const {
+    return builder.addVariable("float", "pow(max(" + source.generateGlsl(builder, coords) + ", 0.0), " + GlslBuilder::formatFloat(exponent) + ')');
+  }
+};
+
+template <typename SourceT>
+struct Clamp {
+  SourceT source;
+  float minValue = 0.f;
+  float maxValue = 1.f;
+
+  float evaluate(float x, float z) const noexcept { return std::clamp(source.evaluate(x, z), minValue, maxValue); }
+
+  std::string generateGlsl(GlslBuilder& builder, const std::string& coords) const {
+    return builder.addVariable("float", "clamp(" + source.generateGlsl(builder, coords) + ", "
+                                                 + GlslBuilder::formatFloat(minValue) + ", " + GlslBuilder::formatFloat(maxValue) + ')');
+  }
+};
+
+///////////////
+// Factories //
+///////////////
+
+inline Perlin perlin(float frequency = 1.f, int octaveCount = 8) noexcept { return Perlin{ frequency, octaveCount }; }
+inline Simplex simplex(float frequency = 1.f, int octaveCount = 8) noexcept { return Simplex{ frequency, octaveCount }; }
+inline Ridged ridged(float frequency = 1.f, int octaveCount = 8) noexcept { return Ridged{ frequency, octaveCount }; }
+inline Billow billow(float frequency = 1.f, int octaveCount = 8) noexcept { return Billow{ frequency, octaveCount }; }
+
+/// Creates a domain warp, evaluating a node at coordinates displaced along both axes by the value of another.
+/// \param source Node to be evaluated at the displaced coordinates.
+/// \param offset Node giving the displacement.
+/// \param strength Factor applied to the displacement.
+/// \return Warp node.
+template <typename SourceT, typename OffsetT>
+Warp<SourceT, OffsetT> warp(SourceT source, OffsetT offset, float strength = 1.f) { return { std::move(source), std::move(offset), strength }; }
+
+template <typename LeftT, typename RightT>
+Add<LeftT, RightT> add(LeftT left, RightT right) { return { std::move(left), std::move(right) }; }
+
+template <typename SourceT>
+Scale<SourceT> scale(SourceT source, float factor) { return { std::move(source), factor }; }
+
+template <typename SourceT>
+Pow<SourceT> pow(SourceT source, float exponent) { return { std::move(source), exponent }; }
+
+template <typename SourceT>
+Clamp<SourceT> clamp(SourceT source, float minValue, float maxValue) { return { std::move(source), minValue, maxValue }; }
+
+/////////////
+// Presets //
+/////////////
+
+/// Creates a Perlin noise warped twice by itself, folding the terrain's features into each other.
+/// \param octaveCount Number of octaves of each noise.
+/// \return Warped noise, between 0 & 1.
+inline auto createWarpedPreset(int octaveCount = 8) { return warp(perlin(1.f, octaveCount), warp(perlin(1.f, octaveCount), perlin(1.f, octaveCount))); }
+
+/// Creates rolling hills of Perlin noise, topped by ridged mountains & roughened by small billows.
+/// \param octaveCount Number of octaves of each noise.
+/// \return Layered noise, between 0 & 1.
+inline auto createLayeredPreset(int octaveCount = 8) {
+  return clamp(add(add(scale(perlin(1.f, octaveCount), 0.6f), scale(ridged(0.5f, octaveCount), 0.3f)), scale(billow(4.f, octaveCount), 0.1f)), 0.f, 1.f);
+}
+
+////////////////
+// Evaluation //
+////////////////
+
+/// Function evaluating a row of samples: first horizontal coordinate, vertical coordinate, horizontal step, output values & sample count.
+using RowEvaluator = std::function<void(float, float, float, float*, std::size_t)>;
+
+/// Evaluates a graph over a row of samples, the whole graph being fused in a single loop.
+/// \param graph Graph to be evaluated.
+/// \param beginX Horizontal coordinate of the first sample.
+/// \param z Vertical coordinate of the samples.
+/// \param stepX Horizontal distance between two samples.
+/// \param values Values to be filled; must hold at least sampleCount elements.
+/// \param sampleCount Number of samples to evaluate.
+template <typename NodeT>
+void evaluateRow(const NodeT& graph, float beginX, float z, float stepX, float* values, std::size_t sampleCount) noexcept {
+  for (std::size_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex)
+    values[sampleIndex] = graph.evaluate(beginX + static_cast<float>(sampleIndex) * stepX, z);
+}
+
+/// Wraps a graph into a row evaluator, so that it can be stored without knowing its type; only one indirection is paid per row.
+/// \param graph Graph to be evaluated.
+/// \return Row evaluator of the graph.
+template <typename NodeT>
+RowEvaluator createRowEvaluator(NodeT graph) {
+  return [graph = std::move(graph)] (float beginX, float z, float stepX, float* values, std::size_t sampleCount) noexcept {
+    evaluateRow(graph, beginX, z, stepX, values, sampleCount);
+  };
+}
+
+/// Generates the GLSL function evaluating a graph. The noise functions (perlin_2d.glsl & noise_graph.glsl) must be defined before it.
+/// \param graph Graph to generate the function of.
+/// \param functionName Name of the function, taking the coordinates as a vec2 & returning the value as a float.
+/// \return GLSL code of the function.
+template <typename NodeT>
+std::string generateGlsl(const NodeT& graph, std::string_view functionName = "computeNoiseGraph") {
+  GlslBuilder builder;
+  const std::string result = graph.generateGlsl(builder, "coords");
+
+  return "float " + std::string(functionName) + "(vec2 coords) {\n" + builder.getCode() + "  return " + result + ";\n}\n";
+}
+
+} // namespace NoiseGraph
+
+#endif // MIDGARD_NOISEGRAPH_HPP
@@ -0,0 +1,108 @@
+#pragma once
+
+#ifndef MIDGARD_PERFORMANCEHUD_HPP
+#define MIDGARD_PERFORMANCEHUD_HPP
+
+#include "Midgard/StaticTerrain.hpp"
+#include "Midgard/TimingHistory.hpp"
+#if !defined(USE_OPENGL_ES)
+#include "Midgard/GpuTimer.hpp"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Raz {
+
+class OverlayLabel;
+class OverlayWindow;
+
+} // namespace Raz
+
+/// Overlay panel showing live performance statistics, so that the terrains can be tuned without attaching a profiler:
+///  rolling averages & percentiles of the frame times & of the measured stages, counts of rendered elements & memory used by buffers.
+/// On desktop OpenGL, the interval between two frames on the GPU's timeline & the number of primitives each frame generates are measured as well,
+///  through queries never waited for. This interval includes the time the GPU spends idle waiting for commands, & is thus not the frame's GPU cost.
+class PerformanceHud {
+public:
+  /// Creates the panel, adding its frame statistics to the given overlay window.
+  /// \param overlay Overlay window to add the panel's labels to; the other elements are added after the previous ones.
+  explicit PerformanceHud(Raz::OverlayWindow& overlay);
+  PerformanceHud(const PerformanceHud&) = delete;
+  PerformanceHud(PerformanceHud&&) noexcept = delete;
+
+  /// Adds a stage measured on the CPU to the panel.
+  /// \param name Name of the stage.
+  /// \param timings Durations of the stage; must outlive the panel.
+  void addCpuStage(std::string name, const TimingHistory& timings);
+#if !defined(USE_OPENGL_ES)
+  /// Adds a stage measured on the GPU to the panel, whose finished measurements are collected each frame.
+  /// \param name Name of the stage.
+  /// \param timer Timer measuring the stage; must outlive the panel.
+  void addGpuStage(std::string name, GpuTimer& timer);
+#endif
+  /// Adds a count of elements to the panel, like triangles or patches.
+  /// \param name Name of the count.
+  /// \param counter Function returning the count, called each time the panel is refreshed.
+  void addCounter(std::string name, std::function<std::size_t()> counter);
+  /// Adds the memory used by a set of buffers to the panel.
+  /// \param name Name of the buffers' owner.
+  /// \param memoryUsageFunc Function returning the memory of each buffer, called each time the panel is refreshed.
+  void addMemoryUsage(std::string name, std::function<std::vector<TerrainBufferMemory>()> memoryUsageFunc);
+  /// Ends the GPU measurements of the previous frame & starts those of the next, then refreshes the panel periodically.
+  /// Must be called once per frame, always at the same point of the frame.
+  /// \param frameTime CPU duration of the last frame, in seconds.
+  void update(float frameTime);
+
+  PerformanceHud& operator=(const PerformanceHud&) = delete;
+  PerformanceHud& operator=(PerformanceHud&&) noexcept = delete;
+
+  ~PerformanceHud();
+
+private:
+  struct Stage {
+    std::string name {};
+    const TimingHistory* timings {};
+    Raz::OverlayLabel* label {};
+  };
+
+  struct Counter {
+    std::string name {};
+    std::function<std::size_t()> counter {};
+    Raz::OverlayLabel* label {};
+  };
+
+  struct MemoryUsage {
+    std::string name {};
+    std::function<std::vector<TerrainBufferMemory>()> memoryUsageFunc {};
+    Raz::OverlayLabel* label {};
+  };
+
+  void refreshLabels();
+
+  Raz::OverlayWindow& m_overlay;
+  Raz::OverlayLabel& m_frameLabel;
+  TimingHistory m_frameTimings {};
+  std::vector<Stage> m_stages {};
+  std::vector<Counter> m_counters {};
+  std::vector<MemoryUsage> m_memoryUsages {};
+  unsigned int m_frameCountSinceRefresh {};
+
+#if !defined(USE_OPENGL_ES)
+  Raz::OverlayLabel& m_gpuFrameLabel;
+  Raz::OverlayLabel& m_primitiveLabel;
+  GpuTimer m_gpuFrameTimer {};
+  std::vector<GpuTimer*> m_gpuTimers {};
+  std::vector<unsigned int> m_freePrimitiveQueries {};
+  std::deque<unsigned int> m_pendingPrimitiveQueries {}; ///< Primitive counts issued & not yet read back, from the oldest.
+  unsigned int m_runningPrimitiveQuery {};
+  bool m_isCountingPrimitives = false;
+  uint64_t m_primitiveCount {}; ///< Number of primitives generated by the last frame read back.
+#endif
+};
+
+#endif // MIDGARD_PERFORMANCEHUD_HPP
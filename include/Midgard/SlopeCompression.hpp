@@ -0,0 +1,34 @@
+#pragma once
+
+#ifndef MIDGARD_SLOPECOMPRESSION_HPP
+#define MIDGARD_SLOPECOMPRESSION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/// Quantization of the half gradients stored in compressed slope maps, shared by the static terrain & its virtual texture.
+namespace SlopeCompression {
+
+/// Byte representing a null gradient.
+constexpr uint8_t zeroByte = 128;
+
+/// Compresses a gradient into a byte. Gradients are unbounded; they are remapped to ]-1; 1[ before being quantized, keeping more precision for gentle slopes.
+/// \param gradient Gradient to compress.
+/// \return Compressed gradient.
+inline uint8_t compressGradient(float gradient) noexcept {
+  const float remappedGradient = gradient / (1.f + std::abs(gradient));
+  return static_cast<uint8_t>(std::lround(remappedGradient * 127.f) + zeroByte);
+}
+
+/// Recovers a gradient from its compressed byte.
+/// \param compressedGradient Compressed gradient.
+/// \return Decompressed gradient.
+inline float decompressGradient(uint8_t compressedGradient) noexcept {
+  const float remappedGradient = static_cast<float>(compressedGradient - zeroByte) / 127.f;
+  return remappedGradient / (1.f - std::min(std::abs(remappedGradient), 0.99f));
+}
+
+} // namespace SlopeCompression
+
+#endif // MIDGARD_SLOPECOMPRESSION_HPP
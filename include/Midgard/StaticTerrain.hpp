@@ -3,34 +3,312 @@
 #ifndef MIDGARD_STATICTERRAIN_HPP
 #define MIDGARD_STATICTERRAIN_HPP
 
+#include "Midgard/BiomeTable.hpp"
+#include "Midgard/NoiseGraph.hpp"
 #include "Midgard/Terrain.hpp"
+#include "Midgard/TimingHistory.hpp"
 
 #include <RaZ/Data/Image.hpp>
+#include <RaZ/Data/Mesh.hpp>
+#include <RaZ/Render/Texture.hpp>
+#include <RaZ/Utils/Threading.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class HeightfieldSource;
+
+/// Data kept on the CPU once the terrain has been uploaded to the GPU.
+enum class ResidencyPolicy : uint8_t {
+  KEEP_CPU_COPIES,     ///< Everything is kept.
+  KEEP_HEIGHTS_ONLY,   ///< Vertices, indices & horizons are released & only the heights are kept, from which they are recomputed on demand.
+  RELEASE_AFTER_UPLOAD ///< Vertices, indices, horizons & heights are released; the terrain must be generated again to be modified.
+};
+
+enum class SlopeMapFormat : uint8_t {
+  RGB_FLOAT, ///< Normalized slope direction & slope strength, as 32-bit floating-point values (12 bytes per texel).
+  RG8        ///< Compressed half gradient, as 8-bit values (2 bytes per texel); slope directions & strengths are recovered from it.
+};
+
+enum class MeshingMode : uint8_t {
+  UNIFORM_GRID, ///< Two triangles per grid cell, whatever the heights.
+  ADAPTIVE      ///< Right-triangulated irregular network, keeping only the triangles needed to stay within a maximal vertical error.
+};
+
+/// Stages whose CPU durations are measured; a stage running within another, like the meshing within the generation, is included in both.
+enum class StaticTerrainStage : uint8_t {
+  GENERATION,
+  MESHING,
+  MESH_UPLOAD,
+  COLOR_MAP,
+  NORMAL_MAP,
+  SLOPE_MAP,
+  HORIZON_MAPS,
+
+  COUNT
+};
+
+struct TerrainBufferMemory {
+  std::string name {};
+  std::size_t cpuByteCount {};
+  std::size_t gpuByteCount {};
+};
 
 class StaticTerrain : public Terrain {
 public:
-  explicit StaticTerrain(Raz::Entity& entity) : Terrain(entity) {}
+  /// Function run by each background regeneration on the regenerated terrain once its maps have been computed, preparing data derived from it
+  ///  on the same worker thread. It returns the function applying the prepared data, called on the rendering thread once the buffers have been swapped.
+  using RegenerationCallback = std::function<std::function<void()>(StaticTerrain&)>;
+
+  /// Creates a static terrain, without generating it.
+  /// \param entity Entity to create the terrain on.
+  /// \param isRenderable True if the terrain must be rendered, false otherwise; if false, the terrain can be generated & its maps computed without any graphics context.
+  explicit StaticTerrain(Raz::Entity& entity, bool isRenderable = true);
   StaticTerrain(Raz::Entity& entity, unsigned int width, unsigned int depth, float heightFactor, float flatness);
+  StaticTerrain(StaticTerrain&&) noexcept;
 
+  const Raz::Image& getColorMap() const noexcept { return m_colorMap; }
+  const Raz::Image& getNormalMap() const noexcept { return m_normalMap; }
+  const Raz::Image& getSlopeMap() const noexcept { return m_slopeMap; }
+  /// Gets the biomes' material IDs of every texel, computed along with the color map.
+  /// \return Single channel image of material IDs.
+  const Raz::Image& getMaterialMap() const noexcept { return m_materialMap; }
+  const BiomeTable& getBiomeTable() const noexcept { return m_biomeTable; }
+  const Raz::Image& getAmbientOcclusionMap() const noexcept { return m_ambientOcclusionMap; }
+  const Raz::Image& getSunVisibilityMap() const noexcept { return m_sunVisibilityMap; }
+
+  ResidencyPolicy getResidencyPolicy() const noexcept { return m_residencyPolicy; }
+  MeshingMode getMeshingMode() const noexcept { return m_meshingMode; }
+  float getMaxMeshError() const noexcept { return m_maxMeshError; }
+  /// Gets the number of triangles the terrain's surface is made of, as last computed.
+  /// \return Number of triangles.
+  std::size_t getTriangleCount() const noexcept { return m_triangleCount; }
+  bool isRegenerating() const noexcept { return (m_regenerationJob != nullptr); }
+  /// Gets the last CPU durations of a stage. Those of the stages run by a background regeneration are added once it has been swapped.
+  /// \param stage Stage to get the durations of.
+  /// \return Timing history of the stage.
+  const TimingHistory& getStageTimings(StaticTerrainStage stage) const noexcept { return m_stageTimings[static_cast<std::size_t>(stage)]; }
+
+  /// Changes the terrain's height factor & flatness. Any background regeneration is first waited for & swapped, so that the change applies to the latest heights.
+  /// \param heightFactor New height factor.
+  /// \param flatness New flatness.
   void setParameters(float heightFactor, float flatness) override;
+  /// Sets the data to be kept on the CPU once uploaded, releasing right away what the policy does not keep.
+  /// \param residencyPolicy Residency policy to apply.
+  void setResidencyPolicy(ResidencyPolicy residencyPolicy);
+  /// Sets the format of the slope map. The slope map must be computed again for it to be taken into account.
+  /// \param slopeMapFormat Format of the slope map.
+  void setSlopeMapFormat(SlopeMapFormat slopeMapFormat) noexcept { m_slopeMapFormat = slopeMapFormat; }
+  /// Sets how the terrain's surface is triangulated, computing the triangles again if the terrain's heights are available.
+  /// The adaptive mesh is built in parallel by square tiles, whose borders are kept identical on both sides so that no crack appears.
+  /// \param meshingMode Meshing mode.
+  /// \param maxError Maximal vertical distance, in world units, between the adaptive mesh & the heights at the vertices it leaves out;
+  ///   ignored for a uniform grid.
+  void setMeshingMode(MeshingMode meshingMode, float maxError = 0.1f);
+  /// Sets the biomes from which the color & material maps are computed. These must be computed again for it to be taken into account.
+  /// \param biomeTable Biome table to classify the texels with.
+  void setBiomeTable(BiomeTable biomeTable) { m_biomeTable = std::move(biomeTable); ++m_biomeTableRevision; }
+  /// Sets the parameters of the noise the terrain is generated from. The terrain must be regenerated for them to be taken into account.
+  /// \param noiseFactor Factor applied to the texels' coordinates before computing the noise; the lower, the larger the terrain's features.
+  /// \param octaveCount Number of octaves of the noise.
+  void setNoiseParameters(float noiseFactor, int octaveCount);
+  /// Sets the noise graph the terrain is generated from, instead of the Perlin noise of the noise parameters' octave count.
+  /// The graph is evaluated at the texels' coordinates multiplied by the noise factor, all its nodes being fused in a single pass.
+  /// The terrain must be regenerated for it to be taken into account.
+  /// \param noiseGraph Noise graph to generate the heights with, whose values should be between 0 & 1.
+  template <typename NodeT>
+  void setNoiseGraph(NodeT noiseGraph) { m_noiseGraphEvaluator = NoiseGraph::createRowEvaluator(std::move(noiseGraph)); }
+  /// Generates the terrain from the Perlin noise of the noise parameters again, instead of a noise graph.
+  void resetNoiseGraph() noexcept { m_noiseGraphEvaluator = nullptr; }
+  /// Sets the number of tasks the terrain's generation & maps computations are split into.
+  /// \param taskCount Number of parallel tasks.
+  void setTaskCount(std::size_t taskCount);
+  /// Sets the number of directions in which the horizon is searched for, baking the horizon maps again if they already have been.
+  /// \param directionCount Number of directions; must be either 4, 8 or 16.
+  void setHorizonDirectionCount(unsigned int directionCount);
+  /// Sets the direction of the sun, recomputing the sun visibility map from the already baked horizons if any.
+  /// \param sunDirection Direction in which the sun's light travels.
+  void setSunDirection(const Raz::Vec3f& sunDirection);
 
-  /// Generates a terrain as a static mesh.
+  /// Generates a terrain as a static mesh, cancelling any background regeneration.
   /// \param width Width of the terrain.
   /// \param depth Depth of the terrain.
   /// \param heightFactor Height factor to apply to vertices.
   /// \param flatness Flatness of the terrain.
   void generate(unsigned int width, unsigned int depth, float heightFactor, float flatness) override;
+  /// Generates a terrain as a static mesh from a region of an heightfield source, cancelling any background regeneration.
+  /// Only the region's data is read, band by band; the source is notified once each band has been read, so that its memory can be reclaimed.
+  /// \param source Heightfield source to read the heights from.
+  /// \param originX Horizontal index of the region's first texel in the source.
+  /// \param originZ Vertical index of the region's first texel in the source.
+  /// \param width Width of the terrain; must not exceed the source's width minus originX.
+  /// \param depth Depth of the terrain; must not exceed the source's depth minus originZ.
+  /// \param heightFactor Height factor to apply to vertices.
+  /// \param flatness Flatness of the terrain.
+  void generate(const HeightfieldSource& source, unsigned int originX, unsigned int originZ,
+                unsigned int width, unsigned int depth, float heightFactor, float flatness);
+  /// Generates the terrain again on worker threads, while the current one keeps being rendered. The mesh & every map already computed are
+  ///  built into a second set of buffers, which swapRegeneratedBuffers() applies once ready. A single regeneration runs at a time: the running one is
+  ///  cancelled & this one launched as soon as it has stopped, only the last request being kept meanwhile.
+  /// \param width Width of the terrain.
+  /// \param depth Depth of the terrain.
+  /// \param heightFactor Height factor to apply to vertices.
+  /// \param flatness Flatness of the terrain.
+  void generateInBackground(unsigned int width, unsigned int depth, float heightFactor, float flatness);
+  /// Changes the terrain's height factor & flatness on worker threads, as generateInBackground() does. The running regeneration is not cancelled but
+  ///  left to be swapped, the change being launched right after; the terrain is thus updated regularly even if changes are requested continuously.
+  /// \param heightFactor New height factor.
+  /// \param flatness New flatness.
+  void setParametersInBackground(float heightFactor, float flatness);
+  /// Applies a finished background regeneration, swapping the buffers, uploading them to the GPU & applying the regeneration callbacks' results,
+  ///  then launches the pending one if any. Every CPU computation having been made by the worker, a regeneration whose buffers have been computed
+  ///  with the biomes, sun direction, meshing mode or maps changed meanwhile is not swapped but launched again.
+  /// Must be called on the rendering thread, between two frames.
+  /// \return True if the regenerated buffers have been swapped, false if no regeneration has finished yet or if it had to be launched again.
+  bool swapRegeneratedBuffers();
+  /// Adds a function to be run by each background regeneration on the regenerated terrain, its result being applied when the buffers are swapped.
+  /// Anything the callback refers to must remain valid until the regenerations have been cancelled.
+  /// \param callback Regeneration callback to add.
+  void addRegenerationCallback(RegenerationCallback callback) { m_regenerationCallbacks.push_back(std::move(callback)); }
+  /// Cancels the running regeneration, waiting for its worker to stop, & discards the pending one.
+  /// Must be called before anything the regeneration callbacks refer to is destroyed.
+  void cancelRegenerations() noexcept;
+  /// Computes the heights of the terrain, between 0 & 1.
+  /// \return Single channel floating-point image of the heights.
+  Raz::Image computeHeightMap() const;
+  /// Computes the color & material maps, classifying each texel into a biome according to its height before flattening, slope strength & moisture.
+  /// The slope strengths are read from the slope map, which must thus be computed first whenever the heights change; it is computed if it never has been.
+  /// \return Color map.
   const Raz::Image& computeColorMap();
   const Raz::Image& computeNormalMap();
   const Raz::Image& computeSlopeMap();
+  /// Bakes the horizon angles of every texel, from which the ambient occlusion & sun visibility maps are derived.
+  /// Both maps are then bound to the terrain's material; they are automatically baked again each time the heights change.
+  /// \param sunDirection Direction in which the sun's light travels.
+  void bakeHorizonMaps(const Raz::Vec3f& sunDirection);
+  /// Bakes the horizon maps again in the area affected by a change of heights in the given region.
+  /// \param originX Horizontal index of the region's first texel.
+  /// \param originZ Vertical index of the region's first texel.
+  /// \param width Width of the region.
+  /// \param depth Depth of the region.
+  void updateHorizonMaps(unsigned int originX, unsigned int originZ, unsigned int width, unsigned int depth);
+  /// Computes the world position of a point on the terrain, its height being interpolated from the closest vertices.
+  /// \param x Horizontal grid coordinate, between 0 & the terrain's width - 1.
+  /// \param z Vertical grid coordinate, between 0 & the terrain's depth - 1.
+  /// \return Position on the terrain's surface.
+  Raz::Vec3f computePosition(float x, float z) const;
+  /// Recovers the slope's strength at the given texel of the slope map, which must have been computed beforehand.
+  /// \param x Horizontal texel index.
+  /// \param z Vertical texel index.
+  /// \return Slope strength, which is half the height difference between the texel's neighbors.
+  float recoverSlopeStrength(unsigned int x, unsigned int z) const;
+  /// Computes the memory used by each of the terrain's buffers, both on the CPU & on the GPU.
+  /// \return Memory used by each buffer.
+  std::vector<TerrainBufferMemory> computeMemoryUsage() const;
+
+  ~StaticTerrain() override;
 
 private:
+  struct RegenerationJob;
+  /// Regeneration requested while another one is running, launched once the latter has been swapped or discarded.
+  /// A job keeps the one it has been launched for, to launch it again if its result is outdated once finished.
+  struct PendingRegeneration {
+    bool isGenerationRequested = false; ///< True if the terrain must be generated again, false if only its parameters must be changed.
+    unsigned int width {};
+    unsigned int depth {};
+    float heightFactor {};
+    float flatness {};
+  };
+
+  /// Launches the pending regeneration if there is one & no other is running.
+  /// \param heights Current heights of the terrain if already copied, for a change of parameters to start from without copying them again.
+  void launchPendingRegeneration(std::vector<float> heights = {});
+  /// Waits for the running regeneration & the pending one to finish & swaps them, so that a direct change applies to the latest heights.
+  void completeRegenerations();
+  /// Checks whether a regenerated terrain has been built with settings changed since on this one, its buffers then having to be computed again.
+  bool isRegenerationOutdated(const StaticTerrain& stagingTerrain) const noexcept;
+  /// Creates a job regenerating the terrain with the same settings; no other job may be running.
+  RegenerationJob& createRegenerationJob();
+  /// Runs a job's generation on a worker thread, followed by the computation of the maps the terrain currently has.
+  template <typename GenerationFuncT>
+  void launchRegeneration(RegenerationJob& job, GenerationFuncT&& generationFunc);
+  /// Checks whether the regeneration this terrain is being built by has been cancelled, for its loops to stop early.
+  bool isCancelled() const noexcept { return (m_cancellationFlag != nullptr && m_cancellationFlag->load(std::memory_order_relaxed)); }
+  TimingHistory& recoverStageTimings(StaticTerrainStage stage) noexcept { return m_stageTimings[static_cast<std::size_t>(stage)]; }
   void computeNormals();
+  void computeIndices();
+  /// Computes the indices of a right-triangulated irregular network, within the maximal mesh error from the heights.
+  void computeAdaptiveIndices();
+  /// Uploads the mesh to the GPU if the terrain is renderable, recomputing its indices if they have been released.
+  void uploadMesh();
+  /// Recomputes the vertices from the kept heights if they have been released.
+  void rehydrateVertices();
+  void applyResidencyPolicy();
+  /// Copies the vertices' heights, to be kept once the vertices have been released.
+  void copyHeights();
+  /// Releases the vertices, indices & horizons once uploaded, as the residency policy requires; the heights are left untouched.
+  void releaseUploadedData();
+  /// Checks that the heights are available, either from the vertices or from the kept heights.
+  void checkHeightsAvailability(const std::vector<Raz::Vertex>& vertices) const;
+  float recoverHeight(const std::vector<Raz::Vertex>& vertices, std::size_t vertexIndex) const noexcept {
+    return (vertices.empty() ? m_heights[vertexIndex] : vertices[vertexIndex].position.y());
+  }
+  /// Computes the normal of an inner vertex from its neighbors' heights, which may be either the vertices' or the kept ones.
+  Raz::Vec3f computeNormal(const std::vector<Raz::Vertex>& vertices, std::size_t widthIndex, std::size_t depthIndex) const noexcept;
   void remapVertices(float newHeightFactor, float newFlatness);
+  /// Computes the horizon of each texel in the given region & derives the horizon maps from them; the region must be valid.
+  void bakeHorizons(unsigned int beginX, unsigned int beginZ, unsigned int endX, unsigned int endZ);
+  void computeSunVisibility(unsigned int beginX, unsigned int beginZ, unsigned int endX, unsigned int endZ);
+  void uploadColorMap();
+  /// Uploads the ambient occlusion & sun visibility maps to the textures bound to the material on construction.
+  void uploadHorizonMaps();
 
   Raz::Image m_colorMap {};
+  Raz::Image m_materialMap {};
   Raz::Image m_normalMap {};
   Raz::Image m_slopeMap {};
+  Raz::Image m_ambientOcclusionMap {};
+  Raz::Image m_sunVisibilityMap {};
+  Raz::Texture2DPtr m_colorTexture {};
+  Raz::Texture2DPtr m_ambientOcclusionTexture {};
+  Raz::Texture2DPtr m_sunVisibilityTexture {};
+
+  float m_noiseFactor = 0.01f;
+  int m_octaveCount   = 8;
+  NoiseGraph::RowEvaluator m_noiseGraphEvaluator {};
+  std::size_t m_taskCount = Raz::Threading::getSystemThreadCount();
+
+  ResidencyPolicy m_residencyPolicy = ResidencyPolicy::KEEP_CPU_COPIES;
+  SlopeMapFormat m_slopeMapFormat   = SlopeMapFormat::RGB_FLOAT;
+  MeshingMode m_meshingMode         = MeshingMode::UNIFORM_GRID;
+  float m_maxMeshError              = 0.1f;
+  std::size_t m_triangleCount {};
+  BiomeTable m_biomeTable {};
+  unsigned int m_biomeTableRevision {}; ///< Incremented each time the biomes change, to know whether a regeneration has used the latest ones.
+  std::vector<float> m_heights {}; ///< Heights kept when the vertices have been released.
+  std::size_t m_uploadedVertexCount {};
+  std::size_t m_uploadedIndexCount {};
+  std::size_t m_colorTextureByteCount {};
+  std::size_t m_ambientOcclusionTextureByteCount {};
+  std::size_t m_sunVisibilityTextureByteCount {};
+  std::array<TimingHistory, static_cast<std::size_t>(StaticTerrainStage::COUNT)> m_stageTimings {};
+
+  bool m_areHorizonMapsBaked = false;
+  unsigned int m_horizonDirectionCount = 8;
+  std::vector<uint16_t> m_horizonSines {}; ///< Quantized sines of the horizon's elevation, stored direction by direction, then row by row.
+  Raz::Vec3f m_sunDirection = Raz::Vec3f(0.f, -1.f, 0.f);
+
+  std::vector<RegenerationCallback> m_regenerationCallbacks {};
+  std::unique_ptr<RegenerationJob> m_regenerationJob {};
+  std::optional<PendingRegeneration> m_pendingRegeneration {};
+  const std::atomic<bool>* m_cancellationFlag {}; ///< Cancellation flag of the job building this terrain, if it is a staging one.
 };
 
 #endif // MIDGARD_STATICTERRAIN_HPP
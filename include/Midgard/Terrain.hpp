@@ -7,10 +7,16 @@ namespace Raz { class Entity; }
 
 class Terrain {
 public:
-  explicit Terrain(Raz::Entity& entity);
+  explicit Terrain(Raz::Entity& entity) : Terrain(entity, true) {}
   Terrain(const Terrain&) = delete;
   Terrain(Terrain&&) noexcept = default;
 
+  Raz::Entity& getEntity() const noexcept { return m_entity; }
+  unsigned int getWidth() const noexcept { return m_width; }
+  unsigned int getDepth() const noexcept { return m_depth; }
+  float getHeightFactor() const noexcept { return m_heightFactor; }
+  float getFlatness() const noexcept { return m_flatness; }
+
   void setHeightFactor(float heightFactor) { setParameters(heightFactor, m_flatness); }
   void setFlatness(float flatness) { setParameters(m_heightFactor, flatness); }
   virtual void setParameters(float heightFactor, float flatness);
@@ -23,6 +29,11 @@ public:
   virtual ~Terrain() = default;
 
 protected:
+  /// Creates a terrain on the given entity, adding the needed components if not already present.
+  /// \param entity Entity to create the terrain on.
+  /// \param isRenderable True if the terrain must be rendered, false otherwise; if false, no rendering component is added, so that no graphics context is needed.
+  Terrain(Raz::Entity& entity, bool isRenderable);
+
   static void checkParameters(float& heightFactor, float& flatness);
 
   Raz::Entity& m_entity;
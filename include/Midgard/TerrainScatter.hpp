@@ -0,0 +1,176 @@
+#pragma once
+
+#ifndef MIDGARD_TERRAINSCATTER_HPP
+#define MIDGARD_TERRAINSCATTER_HPP
+
+#include <RaZ/Data/Mesh.hpp>
+#include <RaZ/Math/Matrix.hpp>
+#include <RaZ/Math/Vector.hpp>
+#include <RaZ/Render/ShaderProgram.hpp>
+#include <RaZ/Render/Texture.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Raz {
+
+class RenderGraph;
+class RenderPass;
+
+} // namespace Raz
+
+class StaticTerrain;
+
+/// Rule deciding where instances of a scatter layer can be placed.
+struct ScatterRule {
+  float minHeight = 0.f;   ///< Minimal height at which to place instances, relative to the terrain's height factor.
+  float maxHeight = 1.f;   ///< Maximal height at which to place instances, relative to the terrain's height factor.
+  float minSlope  = 0.f;   ///< Minimal slope strength, as stored in the terrain's slope map.
+  float maxSlope  = 1.f;   ///< Maximal slope strength, as stored in the terrain's slope map.
+  float spacing   = 4.f;   ///< Approximate distance between two instances, in terrain texels. Two instances are never closer than half of it.
+  float density   = 1.f;   ///< Probability for each valid location to receive an instance, between 0 & 1.
+  float minScale  = 1.f;   ///< Minimal uniform scale applied to instances.
+  float maxScale  = 1.f;   ///< Maximal uniform scale applied to instances.
+  uint32_t seed   = 0;     ///< Seed of the random placement; layers with the same spacing & seed place their instances at the same locations.
+  Raz::Vec3f color = Raz::Vec3f(1.f); ///< Base color of the instances.
+};
+
+struct ScatterInstance {
+  Raz::Vec3f position {};
+  float rotation {}; ///< Rotation around the vertical axis, in radians.
+  float scale = 1.f;
+};
+
+/// Places instances of meshes (vegetation, rocks, ...) on a static terrain according to its heights & slopes.
+/// Instances are sampled on a jittered grid, tile by tile in parallel, & stored in a spatial hash of cells so that
+///  culling only visits the cells around the camera.
+/// When rendered, each layer's prototype is uploaded once & its visible instances are drawn with a single instanced draw call, reading their
+///  transforms from a per-instance buffer; this buffer is only uploaded again when the visible cells change. RaZ's renderer having no instanced
+///  draw, the instances are drawn into their own buffers, which a pass added after the geometry pass then merges with the scene's.
+class TerrainScatter {
+public:
+  /// Creates a scatter only placing & culling its instances, without rendering them.
+  TerrainScatter() = default;
+  /// Creates a scatter rendering its instances, adding the pass merging them with the scene to the render graph as a child of its geometry pass.
+  /// \param renderGraph Render graph to add the merging pass to.
+  /// \param depthBuffer Depth buffer written by the geometry pass.
+  /// \param colorBuffer Color buffer written by the geometry pass.
+  TerrainScatter(Raz::RenderGraph& renderGraph, const Raz::Texture2DPtr& depthBuffer, const Raz::Texture2DPtr& colorBuffer);
+  TerrainScatter(const TerrainScatter&) = delete;
+  TerrainScatter(TerrainScatter&&) noexcept = delete;
+
+  /// Gets the pass merging the instances with the scene, after which the passes reading the merged buffers must be executed. Only available when rendering.
+  /// \return Merging pass.
+  Raz::RenderPass& getCompositePass() noexcept { return *m_compositePass; }
+  /// Gets the depth buffer holding both the scene & the instances. Only available when rendering.
+  /// \return Merged depth buffer, stored as a floating-point color texture.
+  const Raz::Texture2DPtr& getDepthBuffer() const noexcept { return m_compositeDepthBuffer; }
+  /// Gets the color buffer holding both the scene & the instances. Only available when rendering.
+  /// \return Merged color buffer.
+  const Raz::Texture2DPtr& getColorBuffer() const noexcept { return m_compositeColorBuffer; }
+  /// Sets the size of the cells instances are stored into, in terrain texels. The instances must be placed again for it to be taken into account.
+  /// \param cellSize Size of each cell.
+  void setCellSize(unsigned int cellSize);
+  /// Sets the distance from the camera up to which instances are displayed.
+  /// \param viewDistance Maximal distance at which instances are visible, in world units.
+  void setViewDistance(float viewDistance) noexcept { m_viewDistance = viewDistance; }
+  bool isEnabled() const noexcept { return m_isEnabled; }
+  /// Enables or disables the rendering of the instances; when disabled, none is drawn & the merging pass is disabled.
+  /// The passes reading the merged buffers must then read the geometry pass' buffers instead.
+  /// \param enabled True if the instances must be drawn, false otherwise.
+  void enable(bool enabled = true) noexcept;
+  void disable() noexcept { enable(false); }
+  std::size_t getInstanceCount() const noexcept;
+  std::size_t getVisibleInstanceCount() const noexcept;
+  void setSunDirection(const Raz::Vec3f& sunDirection);
+
+  /// Adds a layer of instances, all sharing the same mesh & placement rule.
+  /// \param prototype Mesh of which each instance is a copy; only its first submesh is used, & is uploaded once if rendering.
+  /// \param rule Rule deciding where to place the instances.
+  void addLayer(const Raz::Mesh& prototype, const ScatterRule& rule);
+  /// Places the instances of every layer on the terrain. Its slope map is computed if it has not already been.
+  /// \param terrain Terrain to place the instances on.
+  void place(StaticTerrain& terrain) { preparePlacement(terrain)(); }
+  /// Computes where the instances of every layer are to be placed on the terrain, without replacing the current ones.
+  /// May be called on a worker thread, for instance by a background regeneration of the terrain, as long as no layer is added meanwhile.
+  /// \param terrain Terrain to place the instances on. Its slope map is computed if it has not already been.
+  /// \return Function replacing the instances with those computed, to be called on the rendering thread.
+  std::function<void()> preparePlacement(StaticTerrain& terrain);
+  /// Updates the instances to be rendered according to the camera's position. The visible instances are only gathered again if the visible cells have changed.
+  /// \param cameraPos Position of the camera.
+  void update(const Raz::Vec3f& cameraPos);
+  /// Draws the visible instances of every layer into the scatter's own buffers. Must be called before rendering the frame they are to appear in.
+  /// \param viewProjMatrix View-projection matrix of the camera the frame is rendered with.
+  void render(const Raz::Mat4f& viewProjMatrix);
+  /// Resizes the buffers the instances are drawn into & merged with the scene. Must be called each time the scene's buffers are resized.
+  /// \param width Width of the scene's buffers.
+  /// \param height Height of the scene's buffers.
+  void resizeBuffers(unsigned int width, unsigned int height);
+
+  TerrainScatter& operator=(const TerrainScatter&) = delete;
+  TerrainScatter& operator=(TerrainScatter&&) noexcept = delete;
+
+  ~TerrainScatter();
+
+private:
+  struct CellRange {
+    std::size_t firstInstanceIndex {};
+    std::size_t instanceCount {};
+    Raz::Vec2f minPos {}; ///< Lowest horizontal coordinates of the cell's instances.
+    Raz::Vec2f maxPos {}; ///< Highest horizontal coordinates of the cell's instances.
+  };
+
+  struct ScatterLayer {
+    ScatterRule rule {};
+
+    std::vector<ScatterInstance> instances {};        ///< Instances, grouped by cell.
+    std::unordered_map<uint64_t, CellRange> cells {};
+    std::vector<uint64_t> visibleCellKeys {};
+    std::vector<ScatterInstance> visibleInstances {}; ///< Instances of the visible cells, contiguous to be uploaded at once.
+    bool areVisibleInstancesUploaded = false;
+
+    // OpenGL objects, only created when rendering
+    unsigned int vertexArray {};
+    unsigned int vertexBuffer {};   ///< Prototype's vertices, uploaded once.
+    unsigned int indexBuffer {};    ///< Prototype's indices, uploaded once.
+    unsigned int instanceBuffer {}; ///< Transforms of the visible instances.
+    std::size_t instanceBufferCapacity {};
+    unsigned int prototypeIndexCount {};
+  };
+
+  /// Instances of a layer placed on a terrain, to replace the layer's once applied.
+  struct LayerPlacement {
+    std::vector<ScatterInstance> instances {};
+    std::unordered_map<uint64_t, CellRange> cells {};
+  };
+
+  static uint64_t computeCellKey(unsigned int cellX, unsigned int cellZ) noexcept { return (static_cast<uint64_t>(cellZ) << 32u) | cellX; }
+  LayerPlacement placeLayer(const StaticTerrain& terrain, const ScatterRule& rule, unsigned int cellCountX, unsigned int cellCountZ) const;
+  static void gatherVisibleInstances(ScatterLayer& layer);
+  static void uploadPrototype(ScatterLayer& layer, const Raz::Submesh& prototype);
+  static void uploadVisibleInstances(ScatterLayer& layer);
+
+  std::vector<ScatterLayer> m_layers {};
+
+  Raz::RenderPass* m_compositePass {};
+  std::unique_ptr<Raz::RenderShaderProgram> m_instanceProgram {}; ///< Only created when rendering, a shader program needing a graphics context.
+  unsigned int m_framebuffer {};                ///< Framebuffer the instances are drawn into, holding the two following buffers.
+  Raz::Texture2DPtr m_instanceDepthBuffer {};
+  Raz::Texture2DPtr m_instanceColorBuffer {};
+  Raz::Texture2DPtr m_compositeDepthBuffer {};
+  Raz::Texture2DPtr m_compositeColorBuffer {};
+
+  unsigned int m_cellSize = 64;
+  unsigned int m_cellCountX {};
+  unsigned int m_cellCountZ {};
+  float m_viewDistance = 150.f;
+  bool m_isEnabled = true;
+
+  Raz::Vec2f m_gridOrigin {}; ///< World horizontal position of the terrain's first texel.
+  float m_gridScale = 1.f;     ///< World distance between two terrain texels.
+};
+
+#endif // MIDGARD_TERRAINSCATTER_HPP
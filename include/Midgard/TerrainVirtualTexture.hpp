@@ -0,0 +1,155 @@
+#pragma once
+
+#ifndef MIDGARD_TERRAINVIRTUALTEXTURE_HPP
+#define MIDGARD_TERRAINVIRTUALTEXTURE_HPP
+
+#include "Midgard/StaticTerrain.hpp"
+
+#include <RaZ/Data/Image.hpp>
+#include <RaZ/Math/Vector.hpp>
+#include <RaZ/Render/Texture.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Raz {
+
+class RenderGraph;
+class RenderPass;
+
+} // namespace Raz
+
+/// Software virtual texture holding the static terrain's colors & surface (slopes, ambient occlusion & sun visibility) at a resolution higher than its grid's.
+/// The virtual texture is split into square tiles at every mip level, of which only those visible are resident, in two physical caches of a fixed size:
+///  the GPU memory used thus stays the same whatever the virtual resolution, & no sparse texture extension is needed.
+/// Each frame, a feedback pass renders at a reduced resolution the tile & mip level every pixel of the terrain needs; this buffer is read back
+///  without stalling the GPU, & the missing tiles are generated on a worker thread from the terrain's heights & biomes, coarsest first.
+/// A page table tells the terrain's shader where each tile is in the caches, falling back to the finest resident ancestor of those not yet generated.
+class TerrainVirtualTexture {
+public:
+  static constexpr unsigned int tileSize   = 128; ///< Number of texels per side of a tile, without its border.
+  static constexpr unsigned int tileBorder = 1;   ///< Texels duplicated around each tile, so that filtering never reads a neighboring tile.
+
+  /// Creates the virtual texture of a static terrain, adding its feedback pass to the render graph as a child of its geometry pass.
+  /// The virtual texture is disabled until enable() is called.
+  /// \param renderGraph Render graph to add the feedback pass to.
+  /// \param depthBuffer Depth buffer of the scene, written by the geometry pass.
+  /// \param terrain Static terrain to texture; must be renderable, generated & with its heights available, & must outlive the virtual texture.
+  /// \param texelsPerCell Number of virtual texels along a grid cell of the terrain.
+  /// \param cacheTileCount Number of tiles per side of the physical caches; their size, & thus the memory they use, only depends on it.
+  TerrainVirtualTexture(Raz::RenderGraph& renderGraph, const Raz::Texture2DPtr& depthBuffer, StaticTerrain& terrain,
+                        unsigned int texelsPerCell = 8, unsigned int cacheTileCount = 16);
+  TerrainVirtualTexture(const TerrainVirtualTexture&) = delete;
+  TerrainVirtualTexture(TerrainVirtualTexture&&) noexcept = delete;
+
+  bool isEnabled() const noexcept { return m_isEnabled; }
+  /// Gets the number of virtual texels along the side of the finest mip level.
+  /// \return Virtual resolution, in texels.
+  unsigned int getVirtualResolution() const noexcept { return m_tileCount * tileSize; }
+  unsigned int getMipCount() const noexcept { return m_mipCount; }
+  std::size_t getResidentTileCount() const noexcept { return m_residentTiles.size(); }
+  /// Gets the number of tiles requested by the last feedback which are not yet resident.
+  /// \return Number of missing tiles.
+  std::size_t getPendingTileCount() const noexcept { return m_pendingTiles.size() + m_generatingTiles.size(); }
+
+  /// Renders the terrain from the virtual texture, instead of its color map. Takes a new copy of the terrain's data if it changed while disabled.
+  void enable();
+  /// Renders the terrain from its color map again, stopping the feedback.
+  void disable();
+  /// Sets the direction of the sun lighting the terrain.
+  /// \param sunDirection Direction in which the sun's light travels.
+  void setSunDirection(const Raz::Vec3f& sunDirection);
+  /// Resizes the feedback buffer according to the scene's size. Must be called each time the scene's buffers are resized.
+  /// \param sceneWidth Width of the scene's buffers.
+  /// \param sceneHeight Height of the scene's buffers.
+  void resizeFeedbackBuffer(unsigned int sceneWidth, unsigned int sceneHeight);
+  /// Discards every resident tile & takes a new copy of the terrain's data, the tiles being generated again from it.
+  /// Must be called each time the terrain's heights, biomes or horizon maps change. While disabled, this is deferred until enabled.
+  void invalidate() { prepareInvalidation(m_terrain)(); }
+  /// Takes a new copy of the terrain's data & generates the coarsest tile from it, without touching the virtual texture.
+  /// Can be called from any thread, as long as the given terrain is not modified meanwhile. While disabled, nothing is computed, the
+  ///  returned function only marking the virtual texture as outdated.
+  /// \param terrain Terrain to take the data from; may be one being regenerated instead of the rendered one, as long as it has the same entity.
+  /// \return Function applying the result on the rendering thread, discarding every resident tile & uploading the coarsest one.
+  std::function<void()> prepareInvalidation(const StaticTerrain& terrain);
+  /// Reads back the feedback once available, uploads the tiles generated since the last call & launches the generation of the missing ones.
+  /// Must be called once per frame on the rendering thread; does nothing if the virtual texture is disabled.
+  void update();
+  /// Computes the memory used by the virtual texture's buffers, both on the CPU & on the GPU.
+  /// \return Memory used by each buffer.
+  std::vector<TerrainBufferMemory> computeMemoryUsage() const;
+
+  TerrainVirtualTexture& operator=(const TerrainVirtualTexture&) = delete;
+  TerrainVirtualTexture& operator=(TerrainVirtualTexture&&) noexcept = delete;
+
+  ~TerrainVirtualTexture();
+
+private:
+  struct TerrainSnapshot;
+
+  struct GeneratedTile {
+    uint32_t tileId {};
+    std::vector<uint8_t> colors {};  ///< Colors & material IDs of the tile's texels, border included.
+    std::vector<uint8_t> surfaces {}; ///< Compressed half gradients, ambient occlusion & sun visibility of the tile's texels, border included.
+  };
+
+  struct ResidentTile {
+    unsigned int slotIndex {};
+    uint64_t lastFeedbackIndex {}; ///< Index of the last feedback the tile has been requested by, the least recently requested being evicted first.
+  };
+
+  struct GenerationBatch {
+    std::shared_ptr<const TerrainSnapshot> snapshot {};
+    std::future<std::vector<GeneratedTile>> result {};
+  };
+
+  /// Requests the tiles found in a feedback buffer along with all their ancestors, replacing the tiles previously requested.
+  void requestTiles(const uint8_t* feedbackData, std::size_t feedbackTexelCount);
+  /// Reads back the feedback buffer asynchronously, processing the previous read back once the GPU has finished it.
+  void readFeedback();
+  void collectGeneratedTiles();
+  void launchGeneration();
+  /// Uploads a tile into a free slot of the caches, evicting the least recently requested tile if none is left.
+  /// \return True if the tile has been uploaded, false if every slot holds a tile requested by the last feedback.
+  bool uploadTile(const GeneratedTile& tile);
+  void updatePageTable();
+
+  StaticTerrain& m_terrain;
+  Raz::RenderPass& m_feedbackPass;
+  std::size_t m_materialIndex {};
+
+  unsigned int m_texelsPerCell {};
+  unsigned int m_cacheTileCount {};
+  unsigned int m_tileCount {}; ///< Number of tiles per side of the finest mip level, always a power of two.
+  unsigned int m_mipCount {};
+
+  Raz::Texture2DPtr m_feedbackBuffer {};
+  Raz::Texture2DPtr m_pageTableTexture {};
+  Raz::Texture2DPtr m_colorCache {};
+  Raz::Texture2DPtr m_surfaceCache {};
+  Raz::Image m_pageTable {}; ///< Slot & level of the tile to sample for each tile of each mip level, the levels being laid out side by side.
+
+  std::shared_ptr<const TerrainSnapshot> m_snapshot {};
+  std::unordered_map<uint32_t, ResidentTile> m_residentTiles {};
+  std::vector<unsigned int> m_freeSlots {};
+  std::vector<uint32_t> m_pendingTiles {}; ///< Tiles requested by the last feedback & neither resident nor being generated, coarsest first.
+  std::vector<uint32_t> m_generatingTiles {};
+  GenerationBatch m_generationBatch {};
+
+  unsigned int m_feedbackPixelBuffer {};
+  std::size_t m_feedbackPixelBufferByteCount {};
+  void* m_feedbackFence {}; ///< Fence signaled once the feedback has been copied into the pixel buffer.
+  unsigned int m_frameCountSinceFeedback {};
+  uint64_t m_feedbackIndex {};
+
+  std::atomic<bool> m_isEnabled = false; ///< Read by prepareInvalidation(), which may be called from a regeneration's worker.
+  bool m_isOutdated = true;              ///< Whether the terrain's data changed since its last copy, if any; it is then taken once enabled.
+};
+
+#endif // MIDGARD_TERRAINVIRTUALTEXTURE_HPP
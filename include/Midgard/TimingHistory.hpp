@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef MIDGARD_TIMINGHISTORY_HPP
+#define MIDGARD_TIMINGHISTORY_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+/// Rolling history of the last durations measured for a stage, from which averages & percentiles are computed.
+class TimingHistory {
+public:
+  static constexpr std::size_t capacity = 256; ///< Number of durations kept; the oldest are replaced once it is reached.
+
+  std::size_t getSampleCount() const noexcept { return m_sampleCount; }
+  /// Gets the duration measured last.
+  /// \return Last duration in milliseconds, or 0 if none has been measured yet.
+  float getLastSample() const noexcept { return (m_sampleCount == 0 ? 0.f : m_samples[(m_nextIndex + capacity - 1) % capacity]); }
+
+  void addSample(float milliseconds) noexcept;
+  /// Adds the durations of another history, from the oldest to the most recent.
+  /// \param history History to add the durations of.
+  void addSamples(const TimingHistory& history) noexcept;
+  /// Computes the average of the durations kept.
+  /// \return Average duration in milliseconds, or 0 if none has been measured yet.
+  float computeAverage() const noexcept;
+  /// Computes a percentile of the durations kept, by nearest rank.
+  /// \param percentile Percentile to compute, between 0 & 100.
+  /// \return Duration in milliseconds below which the given percentage of the durations are, or 0 if none has been measured yet.
+  float computePercentile(float percentile) const noexcept;
+  void clear() noexcept;
+
+private:
+  std::array<float, capacity> m_samples {};
+  std::size_t m_sampleCount {};
+  std::size_t m_nextIndex {};
+};
+
+/// Measures the CPU duration of a scope, adding it to a timing history once the scope is left.
+class ScopedCpuTimer {
+public:
+  explicit ScopedCpuTimer(TimingHistory& history) noexcept : m_history{ history }, m_startTime{ std::chrono::steady_clock::now() } {}
+  ScopedCpuTimer(const ScopedCpuTimer&) = delete;
+  ScopedCpuTimer(ScopedCpuTimer&&) noexcept = delete;
+
+  ScopedCpuTimer& operator=(const ScopedCpuTimer&) = delete;
+  ScopedCpuTimer& operator=(ScopedCpuTimer&&) noexcept = delete;
+
+  ~ScopedCpuTimer() { m_history.addSample(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_startTime).count()); }
+
+private:
+  TimingHistory& m_history;
+  std::chrono::steady_clock::time_point m_startTime {};
+};
+
+#endif // MIDGARD_TIMINGHISTORY_HPP
@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef MIDGARD_VOLUMETRICTERRAIN_HPP
+#define MIDGARD_VOLUMETRICTERRAIN_HPP
+
+#include "Midgard/Terrain.hpp"
+
+#if !defined(USE_OPENGL_ES)
+#include <RaZ/Render/ShaderProgram.hpp>
+#include <RaZ/Render/Texture.hpp>
+#endif
+
+#include <memory>
+#include <vector>
+
+/// Terrain defined by a 3D density field, allowing overhangs, arches & caves that an heightfield can't represent.
+/// The field is evaluated & meshed chunk by chunk in parallel, using surface nets (a simplified dual contouring).
+class VolumetricTerrain final : public Terrain {
+public:
+  /// Creates a volumetric terrain, which must then be generated.
+  /// \param entity Entity to create the terrain on.
+  /// \param isRenderable True if the terrain must be rendered, false otherwise; if false, the terrain can be generated without any graphics context.
+  explicit VolumetricTerrain(Raz::Entity& entity, bool isRenderable = true) : Terrain(entity, isRenderable) {}
+  VolumetricTerrain(Raz::Entity& entity, unsigned int width, unsigned int depth, float heightFactor, float flatness);
+
+  float getLastChunksPerSecond() const noexcept { return m_lastChunksPerSecond; }
+  bool isGpuDensityEnabled() const noexcept { return m_useGpuDensity; }
+
+  void setParameters(float heightFactor, float flatness) override;
+  /// Sets the horizontal size of each chunk, in voxels. The terrain must be regenerated for it to be taken into account.
+  /// \param chunkSize Horizontal size of each chunk.
+  void setChunkSize(unsigned int chunkSize);
+  /// Evaluates the density field on the GPU with the 3D noise compute shader, instead of on the CPU. The meshing is always done on the CPU.
+  /// The terrain must be regenerated for it to be taken into account.
+  /// \note Unavailable with OpenGL ES, which has no compute shader; the CPU is used in this case.
+  /// \param enabled True if the density field should be evaluated on the GPU, false otherwise.
+  void enableGpuDensity(bool enabled = true);
+
+  /// Generates a volumetric terrain.
+  /// \param width Width of the terrain.
+  /// \param depth Depth of the terrain.
+  /// \param heightFactor Maximal height of the terrain.
+  /// \param flatness Flatness of the terrain.
+  void generate(unsigned int width, unsigned int depth, float heightFactor, float flatness) override;
+
+private:
+  float computeDensity(float x, float y, float z) const;
+  /// Evaluates the noise of the density field over the whole volume with a compute shader, reading it back into the noise values.
+  /// The shader's program & texture are only created on first use, the latter being reallocated only if the volume's size changes.
+  void computeGpuNoise();
+  /// Computes the densities of the samples needed to mesh a chunk, including an apron of one sample around it.
+  void computeChunkDensities(unsigned int chunkX, unsigned int chunkZ, const std::vector<float>& volumeDensities, std::vector<float>& chunkDensities) const;
+  void meshChunk(unsigned int chunkX, unsigned int chunkZ, const std::vector<float>& chunkDensities, std::size_t submeshIndex);
+
+  unsigned int m_chunkSize = 32;
+  unsigned int m_sampleHeight {};
+  bool m_useGpuDensity = false;
+
+#if !defined(USE_OPENGL_ES)
+  std::unique_ptr<Raz::ComputeShaderProgram> m_noiseProgram {}; ///< Only created once the density is computed on the GPU, a shader program needing a graphics context.
+  Raz::Texture3DPtr m_noiseMap {};
+#endif
+  std::vector<float> m_noiseValues {}; ///< Noise of every sample evaluated on the GPU, stored depth by depth, then row by row; empty if evaluated on the CPU.
+
+  float m_lastChunksPerSecond {};
+};
+
+#endif // MIDGARD_VOLUMETRICTERRAIN_HPP
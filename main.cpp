@@ -1,10 +1,18 @@
+#include "Midgard/Fog.hpp"
+#include "Midgard/HeadlessGenerator.hpp"
+#include "Midgard/NoiseGraph.hpp"
+#include "Midgard/PerformanceHud.hpp"
 #include "Midgard/StaticTerrain.hpp"
+#include "Midgard/TerrainScatter.hpp"
+#include "Midgard/VolumetricTerrain.hpp"
 #if !defined(USE_OPENGL_ES)
 #include "Midgard/DynamicTerrain.hpp"
+#include "Midgard/TerrainVirtualTexture.hpp"
 #endif
 
 #include <RaZ/Application.hpp>
 #include <RaZ/Data/ImageFormat.hpp>
+#include <RaZ/Math/Shape.hpp>
 #include <RaZ/Math/Transform.hpp>
 #include <RaZ/Render/Camera.hpp>
 #include <RaZ/Render/Light.hpp>
@@ -12,6 +20,12 @@
 #include <RaZ/Render/RenderSystem.hpp>
 #include <RaZ/Utils/Logger.hpp>
 
+#include <algorithm>
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
 using namespace Raz::Literals;
 
 namespace {
@@ -19,13 +33,35 @@ namespace {
 constexpr unsigned int terrainWidth = 512;
 constexpr unsigned int terrainDepth = 512;
 
-constexpr std::string_view fogShaderSource = {
-#include "fog.frag.embed"
-};
+constexpr unsigned int volumetricTerrainWidth = 256;
+constexpr unsigned int volumetricTerrainDepth = 256;
+
+// Number of frames to wait for after changing the fog's resolution before measuring, then to measure, when benchmarking it
+constexpr unsigned int fogBenchmarkWarmupFrameCount  = 60;
+constexpr unsigned int fogBenchmarkMeasureFrameCount = 300;
+
+// Number of frames to wait for after changing the static terrain's mesh before measuring, then to measure, when benchmarking it
+// The mesh being recomputed & uploaded at once, fewer frames are waited for than for the fog
+constexpr unsigned int meshBenchmarkWarmupFrameCount  = 30;
+constexpr unsigned int meshBenchmarkMeasureFrameCount = 300;
+
+// Number of times the volumetric terrain is generated with each density evaluation when benchmarking it, only the best throughput being kept
+constexpr unsigned int volumetricBenchmarkRunCount = 5;
 
 } // namespace
 
-int main() {
+int main(int argc, char* argv[]) {
+  // Generating the terrain & exporting its maps without creating any window if requested, which allows running on machines without a display
+  if (HeadlessGenerator::isRequested(argc, argv)) {
+    try {
+      return (HeadlessGenerator(HeadlessGenerator::parseArguments(argc, argv)).run() ? EXIT_SUCCESS : EXIT_FAILURE);
+    } catch (const std::exception& exception) {
+      Raz::Logger::error(exception.what());
+      HeadlessGenerator::printUsage();
+      return EXIT_FAILURE;
+    }
+  }
+
   try {
     ////////////////////
     // Initialization //
@@ -88,15 +124,19 @@ int main() {
     geometryPass.setWriteDepthTexture(depthBuffer);
     geometryPass.addWriteColorTexture(colorBuffer, 0);
 
-    Raz::RenderPass& fogPass = renderGraph.addNode(Raz::FragmentShader::loadFromSource(fogShaderSource), "Fog");
+    // The scattered instances are drawn into their own buffers, merged with the scene's before the fog is applied
+    TerrainScatter scatter(renderGraph, depthBuffer, colorBuffer);
+    scatter.setSunDirection(light.getComponent<Raz::Light>().getDirection());
 
-    fogPass.addReadTexture(depthBuffer, "uniSceneBuffers.depth");
-    fogPass.addReadTexture(colorBuffer, "uniSceneBuffers.color");
-    fogPass.getProgram().setAttribute(light.getComponent<Raz::Light>().getDirection(), "uniSunDir");
-    fogPass.getProgram().setAttribute(0.1f, "uniFogDensity");
-    fogPass.getProgram().sendAttributes();
+    Fog fog(renderGraph, scatter.getCompositePass(), scatter.getDepthBuffer(), scatter.getColorBuffer(), FogResolution::HALF);
+    fog.setSunDirection(light.getComponent<Raz::Light>().getDirection());
+    fog.setDensity(0.1f);
 
-    geometryPass.addChildren(fogPass);
+    // The merging pass being disabled along with the scatter, the fog then reads the geometry pass' buffers
+    const auto enableScatter = [&scatter, &fog, &depthBuffer, &colorBuffer] (bool enabled) {
+      scatter.enable(enabled);
+      fog.setSceneBuffers((enabled ? scatter.getDepthBuffer() : depthBuffer), (enabled ? scatter.getColorBuffer() : colorBuffer));
+    };
 
     /////////////
     // Terrain //
@@ -110,16 +150,81 @@ int main() {
     Raz::Entity& staticTerrainEntity = world.addEntity();
     StaticTerrain staticTerrain(staticTerrainEntity, terrainWidth, terrainDepth, 30.f, 3.f);
 
+    // The volumetric terrain is only generated once requested, its meshing being much more expensive
+    Raz::Entity& volumetricTerrainEntity = world.addEntity(false);
+    VolumetricTerrain volumetricTerrain(volumetricTerrainEntity);
+
+    // The slope map is computed first, the color map reading it
+    const Raz::Image& slopeMap  = staticTerrain.computeSlopeMap();
     const Raz::Image& colorMap  = staticTerrain.computeColorMap();
     const Raz::Image& normalMap = staticTerrain.computeNormalMap();
-    const Raz::Image& slopeMap  = staticTerrain.computeSlopeMap();
+
+    // Baking the ambient occlusion & the sun's shadows, which are then automatically baked again whenever the terrain's heights change
+    staticTerrain.bakeHorizonMaps(light.getComponent<Raz::Light>().getDirection());
+
+#if !defined(USE_OPENGL_ES)
+    // Colors & surface at several texels per grid cell, generated on demand from the heights & biomes; only the visible tiles are kept on the GPU
+    TerrainVirtualTexture virtualTexture(renderGraph, depthBuffer, staticTerrain);
+    virtualTexture.setSunDirection(light.getComponent<Raz::Light>().getDirection());
+#endif
+
+    /////////////
+    // Scatter //
+    /////////////
+
+    ScatterRule treesRule;
+    treesRule.minHeight = 0.04f;
+    treesRule.maxHeight = 0.15f;
+    treesRule.maxSlope  = 0.3f;
+    treesRule.spacing   = 3.f;
+    treesRule.density   = 0.6f;
+    treesRule.minScale  = 0.7f;
+    treesRule.maxScale  = 1.3f;
+    treesRule.color     = Raz::Vec3f(0.1f, 0.3f, 0.05f);
+    scatter.addLayer(Raz::Mesh(Raz::AABB(Raz::Vec3f(-0.2f, 0.f, -0.2f), Raz::Vec3f(0.2f, 2.f, 0.2f))), treesRule);
+
+    ScatterRule rocksRule;
+    rocksRule.minSlope = 0.4f;
+    rocksRule.maxSlope = 100.f;
+    rocksRule.spacing  = 6.f;
+    rocksRule.density  = 0.4f;
+    rocksRule.minScale = 0.5f;
+    rocksRule.maxScale = 1.5f;
+    rocksRule.seed     = 1;
+    rocksRule.color    = Raz::Vec3f(0.35f);
+    scatter.addLayer(Raz::Mesh(Raz::AABB(Raz::Vec3f(-0.5f, -0.2f, -0.5f), Raz::Vec3f(0.5f, 0.5f, 0.5f))), rocksRule);
+
+    scatter.place(staticTerrain);
+
+    for (const TerrainBufferMemory& bufferMemory : staticTerrain.computeMemoryUsage()) {
+      Raz::Logger::debug("[Midgard] Static terrain's " + bufferMemory.name + ": " + std::to_string(bufferMemory.cpuByteCount / 1024) + " KiB on CPU, "
+                                                                                 + std::to_string(bufferMemory.gpuByteCount / 1024) + " KiB on GPU");
+    }
 
 #if !defined(USE_OPENGL_ES)
     Raz::ImageFormat::save("colorMap.png", colorMap);
     Raz::ImageFormat::save("normalMap.png", normalMap);
     Raz::ImageFormat::save("slopeMap.hdr", slopeMap);
+    Raz::ImageFormat::save("ambientOcclusionMap.png", staticTerrain.getAmbientOcclusionMap());
+    Raz::ImageFormat::save("sunVisibilityMap.png", staticTerrain.getSunVisibilityMap());
 #endif
 
+    ////////////
+    // Resize //
+    ////////////
+
+    // RaZ only resizes the buffers of its render graph; those sized according to the scene must be resized along with them
+    window.setWindowResizeCallback([&] (const Raz::Vec2f& windowSize) {
+      const auto sceneWidth  = static_cast<unsigned int>(windowSize.x());
+      const auto sceneHeight = static_cast<unsigned int>(windowSize.y());
+
+      scatter.resizeBuffers(sceneWidth, sceneHeight);
+      fog.resizeBuffers(sceneWidth, sceneHeight);
+#if !defined(USE_OPENGL_ES)
+      virtualTexture.resizeFeedbackBuffer(sceneWidth, sceneHeight);
+#endif
+    });
+
     /////////////////////
     // Camera controls //
     /////////////////////
@@ -200,18 +305,20 @@ int main() {
     Raz::Texture2D colorTexture(colorMap, false);
     Raz::Texture2D normalTexture(normalMap, false);
     Raz::Texture2D slopeTexture(slopeMap, false);
+    Raz::Texture2D sunVisibilityTexture(staticTerrain.getSunVisibilityMap(), false);
 
-    [[maybe_unused]] Raz::OverlayTexture& staticColorTexture  = overlay.addTexture(colorTexture, 125, 125);
-    [[maybe_unused]] Raz::OverlayTexture& staticNormalTexture = overlay.addTexture(normalTexture, 125, 125);
-    [[maybe_unused]] Raz::OverlayTexture& staticSlopeTexture  = overlay.addTexture(slopeTexture, 125, 125);
+    [[maybe_unused]] Raz::OverlayTexture& staticColorTexture         = overlay.addTexture(colorTexture, 125, 125);
+    [[maybe_unused]] Raz::OverlayTexture& staticNormalTexture        = overlay.addTexture(normalTexture, 125, 125);
+    [[maybe_unused]] Raz::OverlayTexture& staticSlopeTexture         = overlay.addTexture(slopeTexture, 125, 125);
+    [[maybe_unused]] Raz::OverlayTexture& staticSunVisibilityTexture = overlay.addTexture(sunVisibilityTexture, 125, 125);
 
     overlay.addSeparator();
 
 #if !defined(USE_OPENGL_ES)
     Raz::OverlaySlider& dynamicNoiseMapFactorSlider = overlay.addSlider("Noise map factor", [&dynamicTerrain] (float value) {
       dynamicTerrain.computeNoiseMap(value);
-      dynamicTerrain.computeColorMap();
       dynamicTerrain.computeSlopeMap();
+      dynamicTerrain.computeColorMap();
     }, 0.001f, 0.1f, 0.01f);
 
     Raz::OverlaySlider& dynamicMinTessLevelSlider = overlay.addSlider("Min tess. level", [&dynamicTerrain] (float value) {
@@ -221,31 +328,226 @@ int main() {
     Raz::OverlaySlider& dynamicHeightFactorSlider = overlay.addSlider("Height factor", [&dynamicTerrain] (float value) {
       dynamicTerrain.setHeightFactor(value);
       dynamicTerrain.computeSlopeMap();
+      dynamicTerrain.computeColorMap();
     }, 0.001f, 50.f, 30.f);
 
     Raz::OverlaySlider& dynamicFlatnessSlider = overlay.addSlider("Flatness", [&dynamicTerrain] (float value) {
       dynamicTerrain.setFlatness(value);
       dynamicTerrain.computeSlopeMap();
+      dynamicTerrain.computeColorMap();
     }, 1.f, 10.f, 3.f);
+
+    Raz::OverlayCheckbox& dynamicClipmapCheckbox = overlay.addCheckbox("Clipmap", [&dynamicTerrain, &cameraTrans] () {
+      dynamicTerrain.enableClipmap();
+      dynamicTerrain.update(cameraTrans.getPosition());
+    }, [&dynamicTerrain] () {
+      dynamicTerrain.disableClipmap();
+    }, false);
+#endif
+
+    const auto uploadStaticMaps = [&] () {
+      colorTexture.load(staticTerrain.getColorMap());
+      normalTexture.load(staticTerrain.getNormalMap());
+      slopeTexture.load(staticTerrain.getSlopeMap());
+      sunVisibilityTexture.load(staticTerrain.getSunVisibilityMap());
+    };
+
+    const auto reloadStaticMaps = [&] () {
+      uploadStaticMaps();
+      scatter.place(staticTerrain);
+#if !defined(USE_OPENGL_ES)
+      virtualTexture.invalidate();
 #endif
+    };
+
+    // The instances & the virtual texture's snapshot are computed from a regenerated terrain by its worker, the swap only applying them
+    staticTerrain.addRegenerationCallback([&scatter] (StaticTerrain& regeneratedTerrain) { return scatter.preparePlacement(regeneratedTerrain); });
+#if !defined(USE_OPENGL_ES)
+    staticTerrain.addRegenerationCallback([&virtualTexture] (StaticTerrain& regeneratedTerrain) { return virtualTexture.prepareInvalidation(regeneratedTerrain); });
+#endif
+
+    // When regenerating in the background, the parameters to be applied are those requested last, not yet those of the terrain
+    bool isStaticTerrainRegeneratedInBackground = true;
+    float staticHeightFactor = 30.f;
+    float staticFlatness     = 3.f;
+
+    [[maybe_unused]] Raz::OverlaySlider& staticHeightFactorSlider = overlay.addSlider("Height factor", [&] (float value) {
+      staticHeightFactor = value;
+
+      if (isStaticTerrainRegeneratedInBackground) {
+        staticTerrain.setParametersInBackground(staticHeightFactor, staticFlatness);
+        return;
+      }
 
-    [[maybe_unused]] Raz::OverlaySlider& staticHeightFactorSlider = overlay.addSlider("Height factor", [&staticTerrain, &normalTexture, &slopeTexture] (float value) {
       staticTerrain.setHeightFactor(value);
-      normalTexture.load(staticTerrain.computeNormalMap());
-      slopeTexture.load(staticTerrain.computeSlopeMap());
+      // The biomes depend on the slopes, which change with the heights
+      staticTerrain.computeSlopeMap();
+      staticTerrain.computeColorMap();
+      staticTerrain.computeNormalMap();
+      reloadStaticMaps();
     }, 0.001f, 50.f, 30.f);
 
-    [[maybe_unused]] Raz::OverlaySlider& staticFlatnessSlider = overlay.addSlider("Flatness", [&staticTerrain, &normalTexture, &slopeTexture] (float value) {
+    [[maybe_unused]] Raz::OverlaySlider& staticFlatnessSlider = overlay.addSlider("Flatness", [&] (float value) {
+      staticFlatness = value;
+
+      if (isStaticTerrainRegeneratedInBackground) {
+        staticTerrain.setParametersInBackground(staticHeightFactor, staticFlatness);
+        return;
+      }
+
       staticTerrain.setFlatness(value);
-      normalTexture.load(staticTerrain.computeNormalMap());
-      slopeTexture.load(staticTerrain.computeSlopeMap());
+      // The biomes depend on the slopes, which change with the heights
+      staticTerrain.computeSlopeMap();
+      staticTerrain.computeColorMap();
+      staticTerrain.computeNormalMap();
+      reloadStaticMaps();
     }, 1.f, 10.f, 3.f);
 
-    overlay.addSlider("Fog density", [&fogPass] (float value) {
-      fogPass.getProgram().setAttribute(value, "uniFogDensity");
-      fogPass.getProgram().sendAttributes();
+    [[maybe_unused]] Raz::OverlayCheckbox& staticBackgroundCheckbox = overlay.addCheckbox("Regenerate in background", [&isStaticTerrainRegeneratedInBackground] () noexcept {
+      isStaticTerrainRegeneratedInBackground = true;
+    }, [&isStaticTerrainRegeneratedInBackground] () noexcept {
+      isStaticTerrainRegeneratedInBackground = false;
+    }, true);
+
+    // Variant of the default biomes in which the driest grasslands are replaced by sand; switching to it only uploads its lookup table
+    BiomeTable dryBiomeTable;
+    {
+      std::vector<Biome> biomes = dryBiomeTable.getBiomes();
+
+      Biome drylands       = biomes[1];
+      drylands.maxMoisture = 0.4f;
+      drylands.lowColor    = Raz::Vec3b(194, 178, 128);
+      drylands.materialId  = 5;
+      biomes.insert(biomes.begin() + 2, drylands);
+
+      dryBiomeTable.setBiomes(std::move(biomes));
+    }
+
+    overlay.addCheckbox("Dry biomes", [&] () {
+      staticTerrain.setBiomeTable(dryBiomeTable);
+      colorTexture.load(staticTerrain.computeColorMap());
+#if !defined(USE_OPENGL_ES)
+      virtualTexture.invalidate();
+      dynamicTerrain.setBiomeTable(dryBiomeTable);
+#endif
+    }, [&] () {
+      staticTerrain.setBiomeTable(BiomeTable());
+      colorTexture.load(staticTerrain.computeColorMap());
+#if !defined(USE_OPENGL_ES)
+      virtualTexture.invalidate();
+      dynamicTerrain.setBiomeTable(BiomeTable());
+#endif
+    }, false);
+
+    // The static terrain is generated again from its new noise, while the dynamic one only recompiles its noise shaders
+    const auto regenerateStaticTerrain = [&] () {
+      if (isStaticTerrainRegeneratedInBackground) {
+        staticTerrain.generateInBackground(staticTerrain.getWidth(), staticTerrain.getDepth(), staticHeightFactor, staticFlatness);
+        return;
+      }
+
+      staticTerrain.generate(staticTerrain.getWidth(), staticTerrain.getDepth(), staticHeightFactor, staticFlatness);
+      staticTerrain.computeSlopeMap();
+      staticTerrain.computeColorMap();
+      staticTerrain.computeNormalMap();
+      reloadStaticMaps();
+    };
+
+    overlay.addCheckbox("Warped noise", [&] () {
+      staticTerrain.setNoiseGraph(NoiseGraph::createWarpedPreset());
+      regenerateStaticTerrain();
+#if !defined(USE_OPENGL_ES)
+      dynamicTerrain.setNoiseGraph(NoiseGraph::createWarpedPreset());
+#endif
+    }, [&] () {
+      staticTerrain.resetNoiseGraph();
+      regenerateStaticTerrain();
+#if !defined(USE_OPENGL_ES)
+      dynamicTerrain.setNoiseGraph(NoiseGraph::perlin());
+#endif
+    }, false);
+
+    // Only the triangles are computed again, the vertices & maps being left untouched
+    float staticMaxMeshError = 0.1f;
+
+    overlay.addCheckbox("Adaptive mesh", [&] () {
+      staticTerrain.setMeshingMode(MeshingMode::ADAPTIVE, staticMaxMeshError);
+    }, [&] () {
+      staticTerrain.setMeshingMode(MeshingMode::UNIFORM_GRID);
+    }, false);
+
+    overlay.addSlider("Mesh max error", [&] (float value) {
+      staticMaxMeshError = value;
+
+      if (staticTerrain.getMeshingMode() == MeshingMode::ADAPTIVE)
+        staticTerrain.setMeshingMode(MeshingMode::ADAPTIVE, staticMaxMeshError);
+    }, 0.f, 2.f, 0.1f);
+
+#if !defined(USE_OPENGL_ES)
+    overlay.addCheckbox("Virtual texture", [&virtualTexture] () {
+      virtualTexture.enable();
+    }, [&virtualTexture] () {
+      virtualTexture.disable();
+    }, false);
+#endif
+
+    // Measuring the average frame time with the uniform grid, then with adaptive meshes of increasing maximal errors
+    constexpr std::array<float, 4> meshBenchmarkErrors = { 0.05f, 0.1f, 0.5f, 1.f };
+
+    std::size_t meshBenchmarkStepIndex   = 0;
+    unsigned int meshBenchmarkFrameIndex = 0;
+    float meshBenchmarkTotalTime         = 0.f;
+    bool isBenchmarkingMeshes            = false;
+    MeshingMode meshingModeBeforeBenchmark = staticTerrain.getMeshingMode();
+
+    const auto applyMeshBenchmarkStep = [&] () {
+      if (meshBenchmarkStepIndex == 0)
+        staticTerrain.setMeshingMode(MeshingMode::UNIFORM_GRID);
+      else
+        staticTerrain.setMeshingMode(MeshingMode::ADAPTIVE, meshBenchmarkErrors[meshBenchmarkStepIndex - 1]);
+    };
+
+    overlay.addButton("Benchmark meshing", [&] () {
+      if (isBenchmarkingMeshes)
+        return;
+
+      meshingModeBeforeBenchmark = staticTerrain.getMeshingMode();
+      meshBenchmarkStepIndex     = 0;
+      meshBenchmarkFrameIndex    = 0;
+      meshBenchmarkTotalTime     = 0.f;
+      isBenchmarkingMeshes       = true;
+
+      applyMeshBenchmarkStep();
+    });
+
+    overlay.addSlider("Fog density", [&fog] (float value) {
+      fog.setDensity(value);
     }, 0.f, 1.f, 0.1f);
 
+    overlay.addDropdown("Fog resolution", { "Full", "Half", "Quarter" }, [&fog] (const std::string&, std::size_t index) {
+      fog.setResolution(static_cast<FogResolution>(index));
+    }, 1);
+
+    // Measuring the average frame time with each fog resolution in turn, one after the other
+    std::size_t fogBenchmarkResolutionIndex = 0;
+    unsigned int fogBenchmarkFrameIndex     = 0;
+    float fogBenchmarkTotalTime             = 0.f;
+    bool isBenchmarkingFog                  = false;
+    FogResolution fogResolutionBeforeBenchmark = fog.getResolution();
+
+    overlay.addButton("Benchmark fog resolutions", [&] () {
+      if (isBenchmarkingFog)
+        return;
+
+      fogResolutionBeforeBenchmark = fog.getResolution();
+      fogBenchmarkResolutionIndex  = 0;
+      fogBenchmarkFrameIndex       = 0;
+      fogBenchmarkTotalTime        = 0.f;
+      isBenchmarkingFog            = true;
+
+      fog.setResolution(FogResolution::FULL);
+    });
+
     overlay.addSeparator();
 
 #if !defined(USE_OPENGL_ES)
@@ -258,20 +560,27 @@ int main() {
       dynamicMinTessLevelSlider.enable();
       dynamicHeightFactorSlider.enable();
       dynamicFlatnessSlider.enable();
+      dynamicClipmapCheckbox.enable();
 
       staticTerrainEntity.disable();
+      enableScatter(false);
       staticColorTexture.disable();
       staticNormalTexture.disable();
       staticSlopeTexture.disable();
+      staticSunVisibilityTexture.disable();
       staticHeightFactorSlider.disable();
       staticFlatnessSlider.disable();
+      staticBackgroundCheckbox.disable();
     }, [&] () noexcept {
       staticTerrainEntity.enable();
+      enableScatter(true);
       staticColorTexture.enable();
       staticNormalTexture.enable();
       staticSlopeTexture.enable();
+      staticSunVisibilityTexture.enable();
       staticHeightFactorSlider.enable();
       staticFlatnessSlider.enable();
+      staticBackgroundCheckbox.enable();
 
       dynamicTerrainEntity.disable();
       dynamicNoiseTexture.disable();
@@ -281,15 +590,88 @@ int main() {
       dynamicMinTessLevelSlider.disable();
       dynamicHeightFactorSlider.disable();
       dynamicFlatnessSlider.disable();
+      dynamicClipmapCheckbox.disable();
     }, true);
 
     // Disabling all static elements at first, since we want the dynamic terrain to be used by default
     staticTerrainEntity.disable();
+    enableScatter(false);
     staticColorTexture.disable();
     staticNormalTexture.disable();
     staticSlopeTexture.disable();
+    staticSunVisibilityTexture.disable();
     staticHeightFactorSlider.disable();
     staticFlatnessSlider.disable();
+    staticBackgroundCheckbox.disable();
+#endif
+
+    bool isVolumetricTerrainGenerated = false;
+    bool wasStaticTerrainEnabled      = staticTerrainEntity.isEnabled();
+#if !defined(USE_OPENGL_ES)
+    bool wasDynamicTerrainEnabled = dynamicTerrainEntity.isEnabled();
+#endif
+
+    overlay.addCheckbox("Volumetric terrain", [&] () {
+      if (!isVolumetricTerrainGenerated) {
+        volumetricTerrain.generate(volumetricTerrainWidth, volumetricTerrainDepth, 30.f, 3.f);
+        isVolumetricTerrainGenerated = true;
+      }
+
+      volumetricTerrainEntity.enable();
+
+      wasStaticTerrainEnabled = staticTerrainEntity.isEnabled();
+      staticTerrainEntity.disable();
+      enableScatter(false);
+#if !defined(USE_OPENGL_ES)
+      wasDynamicTerrainEnabled = dynamicTerrainEntity.isEnabled();
+      dynamicTerrainEntity.disable();
+#endif
+    }, [&] () noexcept {
+      volumetricTerrainEntity.disable();
+
+      staticTerrainEntity.enable(wasStaticTerrainEnabled);
+      enableScatter(wasStaticTerrainEnabled);
+#if !defined(USE_OPENGL_ES)
+      dynamicTerrainEntity.enable(wasDynamicTerrainEnabled);
+#endif
+    }, false);
+
+#if !defined(USE_OPENGL_ES)
+    overlay.addCheckbox("Volumetric density on GPU", [&] () {
+      volumetricTerrain.enableGpuDensity(true);
+
+      if (isVolumetricTerrainGenerated)
+        volumetricTerrain.generate(volumetricTerrainWidth, volumetricTerrainDepth, 30.f, 3.f);
+    }, [&] () {
+      volumetricTerrain.enableGpuDensity(false);
+
+      if (isVolumetricTerrainGenerated)
+        volumetricTerrain.generate(volumetricTerrainWidth, volumetricTerrainDepth, 30.f, 3.f);
+    }, false);
+
+    // Measuring the throughput of the volumetric terrain's generation with the density evaluated on the CPU, then on the GPU
+    overlay.addButton("Benchmark volumetric terrain", [&] () {
+      const bool wasGpuDensityEnabled = volumetricTerrain.isGpuDensityEnabled();
+
+      for (const bool isGpuDensityEnabled : { false, true }) {
+        volumetricTerrain.enableGpuDensity(isGpuDensityEnabled);
+
+        float bestChunksPerSecond = 0.f;
+
+        for (unsigned int runIndex = 0; runIndex < volumetricBenchmarkRunCount; ++runIndex) {
+          volumetricTerrain.generate(volumetricTerrainWidth, volumetricTerrainDepth, 30.f, 3.f);
+          bestChunksPerSecond = std::max(bestChunksPerSecond, volumetricTerrain.getLastChunksPerSecond());
+        }
+
+        Raz::Logger::info("[VolumetricTerrain] Best throughput with the density on the " + std::string(isGpuDensityEnabled ? "GPU" : "CPU") + " ("
+                        + std::to_string(volumetricTerrainWidth) + 'x' + std::to_string(volumetricTerrainDepth) + "): "
+                        + std::to_string(bestChunksPerSecond) + " chunks/s");
+      }
+
+      volumetricTerrain.enableGpuDensity(wasGpuDensityEnabled);
+      volumetricTerrain.generate(volumetricTerrainWidth, volumetricTerrainDepth, 30.f, 3.f);
+      isVolumetricTerrainGenerated = true;
+    });
 #endif
 
     overlay.addSeparator();
@@ -297,11 +679,132 @@ int main() {
     overlay.addFrameTime("Frame time: %.3f ms/frame");
     overlay.addFpsCounter("FPS: %.1f");
 
+    /////////////////////
+    // Performance HUD //
+    /////////////////////
+
+    Raz::OverlayWindow& performanceOverlay = window.getOverlay().addWindow("Performance", Raz::Vec2f(-1.f));
+    PerformanceHud performanceHud(performanceOverlay);
+
+#if !defined(USE_OPENGL_ES)
+    performanceOverlay.addSeparator();
+
+    performanceHud.addGpuStage("Dynamic noise map", dynamicTerrain.getNoiseMapTimer());
+    performanceHud.addGpuStage("Dynamic slope map", dynamicTerrain.getSlopeMapTimer());
+    performanceHud.addGpuStage("Dynamic color map", dynamicTerrain.getColorMapTimer());
+    performanceHud.addGpuStage("Dynamic clipmap update", dynamicTerrain.getClipmapUpdateTimer());
+#endif
+
+    performanceOverlay.addSeparator();
+
+    constexpr std::array<std::pair<StaticTerrainStage, std::string_view>, static_cast<std::size_t>(StaticTerrainStage::COUNT)> staticStages = {{
+      { StaticTerrainStage::GENERATION,   "Static generation" },
+      { StaticTerrainStage::MESHING,      "Static meshing" },
+      { StaticTerrainStage::MESH_UPLOAD,  "Static mesh upload" },
+      { StaticTerrainStage::COLOR_MAP,    "Static color map" },
+      { StaticTerrainStage::NORMAL_MAP,   "Static normal map" },
+      { StaticTerrainStage::SLOPE_MAP,    "Static slope map" },
+      { StaticTerrainStage::HORIZON_MAPS, "Static horizon maps" }
+    }};
+
+    for (const auto& [stage, stageName] : staticStages)
+      performanceHud.addCpuStage(std::string(stageName), staticTerrain.getStageTimings(stage));
+
+    performanceOverlay.addSeparator();
+
+    performanceHud.addCounter("Static terrain triangles", [&staticTerrain] () noexcept { return staticTerrain.getTriangleCount(); });
+#if !defined(USE_OPENGL_ES)
+    performanceHud.addCounter("Dynamic terrain patches", [&dynamicTerrain] () { return dynamicTerrain.getPatchCount(); });
+    performanceHud.addCounter("Virtual texture resident tiles", [&virtualTexture] () noexcept { return virtualTexture.getResidentTileCount(); });
+#endif
+
+    performanceOverlay.addSeparator();
+
+    performanceHud.addMemoryUsage("Static terrain", [&staticTerrain] () { return staticTerrain.computeMemoryUsage(); });
+#if !defined(USE_OPENGL_ES)
+    performanceHud.addMemoryUsage("Virtual texture", [&virtualTexture] () { return virtualTexture.computeMemoryUsage(); });
+#endif
+
     //////////////////////////
     // Starting application //
     //////////////////////////
 
-    app.run();
+    app.run([&] (const Raz::FrameTimeInfo& timeInfo) {
+      performanceHud.update(timeInfo.deltaTime);
+
+      if (staticTerrainEntity.isEnabled())
+        scatter.update(cameraTrans.getPosition());
+
+      // The camera having already been moved for the next frame, the instances are drawn for it right away; nothing is drawn while disabled
+      scatter.render(cameraComp.getProjectionMatrix() * cameraComp.computeViewMatrix(cameraTrans));
+
+      // Regenerated buffers are only swapped between frames
+      if (staticTerrain.swapRegeneratedBuffers())
+        uploadStaticMaps();
+
+#if !defined(USE_OPENGL_ES)
+      if (staticTerrainEntity.isEnabled())
+        virtualTexture.update();
+
+      if (dynamicTerrainEntity.isEnabled())
+        dynamicTerrain.update(cameraTrans.getPosition());
+#endif
+
+      if (isBenchmarkingFog) {
+        ++fogBenchmarkFrameIndex;
+
+        if (fogBenchmarkFrameIndex > fogBenchmarkWarmupFrameCount)
+          fogBenchmarkTotalTime += timeInfo.deltaTime;
+
+        if (fogBenchmarkFrameIndex == fogBenchmarkWarmupFrameCount + fogBenchmarkMeasureFrameCount) {
+          constexpr std::array<std::string_view, 3> resolutionNames = { "full", "half", "quarter" };
+
+          const float avgFrameTime = fogBenchmarkTotalTime / static_cast<float>(fogBenchmarkMeasureFrameCount) * 1000.f;
+          Raz::Logger::info("[Fog] Average frame time at " + std::string(resolutionNames[fogBenchmarkResolutionIndex]) + " resolution ("
+                          + std::to_string(window.getWidth()) + 'x' + std::to_string(window.getHeight()) + "): " + std::to_string(avgFrameTime) + " ms");
+
+          ++fogBenchmarkResolutionIndex;
+          fogBenchmarkFrameIndex = 0;
+          fogBenchmarkTotalTime  = 0.f;
+
+          if (fogBenchmarkResolutionIndex < resolutionNames.size()) {
+            fog.setResolution(static_cast<FogResolution>(fogBenchmarkResolutionIndex));
+          } else {
+            fog.setResolution(fogResolutionBeforeBenchmark);
+            isBenchmarkingFog = false;
+          }
+        }
+      }
+
+      if (isBenchmarkingMeshes) {
+        ++meshBenchmarkFrameIndex;
+
+        if (meshBenchmarkFrameIndex > meshBenchmarkWarmupFrameCount)
+          meshBenchmarkTotalTime += timeInfo.deltaTime;
+
+        if (meshBenchmarkFrameIndex == meshBenchmarkWarmupFrameCount + meshBenchmarkMeasureFrameCount) {
+          const float avgFrameTime = meshBenchmarkTotalTime / static_cast<float>(meshBenchmarkMeasureFrameCount) * 1000.f;
+          const std::string meshName = (meshBenchmarkStepIndex == 0 ? std::string("uniform grid")
+                                                                    : "adaptive mesh (max error " + std::to_string(meshBenchmarkErrors[meshBenchmarkStepIndex - 1]) + ')');
+          Raz::Logger::info("[StaticTerrain] Average frame time with the " + meshName + ", " + std::to_string(staticTerrain.getTriangleCount())
+                          + " triangles: " + std::to_string(avgFrameTime) + " ms");
+
+          ++meshBenchmarkStepIndex;
+          meshBenchmarkFrameIndex = 0;
+          meshBenchmarkTotalTime  = 0.f;
+
+          if (meshBenchmarkStepIndex <= meshBenchmarkErrors.size()) {
+            applyMeshBenchmarkStep();
+          } else {
+            staticTerrain.setMeshingMode(meshingModeBeforeBenchmark, staticMaxMeshError);
+            isBenchmarkingMeshes = false;
+          }
+        }
+      }
+    });
+
+    // The regeneration callbacks referring to the scatter & the virtual texture, no worker must run them once these are destroyed
+    staticTerrain.cancelRegenerations();
   } catch (const std::exception& exception) {
     Raz::Logger::error(exception.what());
   }
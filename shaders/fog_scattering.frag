@@ -0,0 +1,48 @@
+struct Buffers {
+  sampler2D depth;
+};
+
+in vec2 fragTexcoords;
+
+layout(std140) uniform uboCameraMatrices {
+  mat4 viewMat;
+  mat4 invViewMat;
+  mat4 projectionMat;
+  mat4 invProjectionMat;
+  mat4 viewProjectionMat;
+  vec3 cameraPos;
+};
+
+uniform Buffers uniSceneBuffers;
+uniform vec3 uniSunDir;
+uniform float uniFogDensity;
+
+layout(location = 0) out vec4 fragFog;
+layout(location = 1) out float fragLinearDepth;
+
+vec3 computeViewPosFromDepth(float depth) {
+  vec4 projPos = vec4(vec3(fragTexcoords, depth) * 2.0 - 1.0, 1.0);
+  vec4 viewPos = invProjectionMat * projPos;
+
+  return viewPos.xyz / viewPos.w;
+}
+
+// Same fog as the full resolution pass (see fog.frag), but only its color & amount are output; they are blended with the scene when upsampling
+void main() {
+  float depth = texture(uniSceneBuffers.depth, fragTexcoords).r;
+
+  vec3 viewPos   = computeViewPosFromDepth(depth);
+  float viewDist = length(viewPos);
+  vec3 viewDir   = viewPos / viewDist;
+
+  float fogDensity = uniFogDensity / 20.0;
+  float fogAmount  = 1.0 - exp(-viewDist * fogDensity);
+
+  float sunAmount = max(-dot(viewDir, mat3(viewMat) * uniSunDir), 0.0);
+  vec3 fogColor   = mix(vec3(0.5, 0.6, 0.7), // Sky/fog color (blue)
+                        vec3(1.0, 0.9, 0.7), // Sun color (yellow)
+                        pow(sunAmount, 8.0));
+
+  fragFog         = vec4(fogColor, fogAmount);
+  fragLinearDepth = -viewPos.z;
+}
@@ -0,0 +1,63 @@
+struct Buffers {
+  sampler2D depth;
+  sampler2D color;
+};
+
+struct FogBuffers {
+  sampler2D fog;
+  sampler2D linearDepth;
+};
+
+in vec2 fragTexcoords;
+
+layout(std140) uniform uboCameraMatrices {
+  mat4 viewMat;
+  mat4 invViewMat;
+  mat4 projectionMat;
+  mat4 invProjectionMat;
+  mat4 viewProjectionMat;
+  vec3 cameraPos;
+};
+
+uniform Buffers uniSceneBuffers;
+uniform FogBuffers uniFogBuffers;
+
+layout(location = 0) out vec4 fragColor;
+
+// Recovering the linear depth from the projection's terms alone, much cheaper than a full inverse projection. The denominator is negative
+//  for any depth in [0; 1], reaching its closest to 0 at the far plane; it is kept away from 0 in case of a degenerate projection
+float computeLinearDepth(float depth) {
+  return projectionMat[3][2] / min((depth * 2.0 - 1.0) + projectionMat[2][2], -0.000001);
+}
+
+// Bilateral upsampling: the 4 closest low resolution samples are weighted both by their distance & by how close their depth is to the pixel's,
+//  so that the fog of a surface does not bleed over another one at depth discontinuities
+void main() {
+  ivec2 fogSize    = textureSize(uniFogBuffers.fog, 0);
+  vec2 fogCoords   = fragTexcoords * vec2(fogSize) - 0.5;
+  ivec2 baseCoords = ivec2(floor(fogCoords));
+  vec2 bilinearCoeffs = fogCoords - vec2(baseCoords);
+
+  float linearDepth = computeLinearDepth(texture(uniSceneBuffers.depth, fragTexcoords).r);
+
+  vec4 fog          = vec4(0.0);
+  float totalWeight = 0.0;
+
+  for (int sampleIndex = 0; sampleIndex < 4; ++sampleIndex) {
+    ivec2 offset       = ivec2(sampleIndex & 1, sampleIndex >> 1);
+    ivec2 sampleCoords = clamp(baseCoords + offset, ivec2(0), fogSize - 1);
+
+    vec2 bilinearWeights = mix(1.0 - bilinearCoeffs, bilinearCoeffs, vec2(offset));
+    float sampleDepth    = texelFetch(uniFogBuffers.linearDepth, sampleCoords, 0).r;
+    float depthWeight    = 1.0 / (0.001 + abs(sampleDepth - linearDepth) / linearDepth);
+    float weight         = bilinearWeights.x * bilinearWeights.y * depthWeight;
+
+    fog         += texelFetch(uniFogBuffers.fog, sampleCoords, 0) * weight;
+    totalWeight += weight;
+  }
+
+  fog /= totalWeight;
+
+  vec3 color = texture(uniSceneBuffers.color, fragTexcoords).rgb;
+  fragColor  = vec4(mix(color, fog.rgb, fog.a), 1.0);
+}
@@ -0,0 +1,81 @@
+// Noise sources of the noise graphs, prepended after the Perlin noise functions to the shaders evaluating a graph
+// These mirror NoiseGraph's CPU evaluation, so that both give the same values
+
+float computeSimplex(vec2 coords) {
+  const float skewFactor   = 0.3660254038; // (sqrt(3) - 1) / 2
+  const float unskewFactor = 0.2113248654; // (3 - sqrt(3)) / 6
+
+  // Recovering the simplex cell the coordinates are in, & their offset from its first corner
+  vec2 cellCoords = floor(coords + (coords.x + coords.y) * skewFactor);
+  vec2 offset0    = coords - (cellCoords - (cellCoords.x + cellCoords.y) * unskewFactor);
+
+  // The cell being a triangle, its middle corner depends on the half of the skewed square the coordinates are in
+  ivec2 middleCorner = (offset0.x > offset0.y ? ivec2(1, 0) : ivec2(0, 1));
+
+  vec2 offset1 = offset0 - vec2(middleCorner) + unskewFactor;
+  vec2 offset2 = offset0 - 1.0 + 2.0 * unskewFactor;
+
+  int x0 = int(cellCoords.x) & 255;
+  int y0 = int(cellCoords.y) & 255;
+
+  vec3 attenuations = max(vec3(0.5) - vec3(dot(offset0, offset0), dot(offset1, offset1), dot(offset2, offset2)), vec3(0.0));
+  attenuations     *= attenuations;
+  attenuations     *= attenuations;
+
+  vec3 gradientDots = vec3(dot(recoverGradient2D(x0,                  y0                 ), offset0),
+                           dot(recoverGradient2D(x0 + middleCorner.x, y0 + middleCorner.y), offset1),
+                           dot(recoverGradient2D(x0 + 1,              y0 + 1             ), offset2));
+
+  // Scaling the sum so that it roughly covers [-1; 1], the gradients being of unit length
+  return 99.2 * dot(attenuations, gradientDots);
+}
+
+float computeSimplexFbm(vec2 coords, int octaveCount) {
+  float frequency = 1.0;
+  float amplitude = 1.0;
+  float total     = 0.0;
+
+  for (int i = 0; i < octaveCount; ++i) {
+    total += computeSimplex(coords * frequency) * amplitude;
+
+    frequency *= 2.0;
+    amplitude *= 0.5;
+  }
+
+  return (total + 1.0) / 2.0;
+}
+
+float computeRidgedFbm(vec2 coords, int octaveCount) {
+  float frequency    = 1.0;
+  float amplitude    = 1.0;
+  float total        = 0.0;
+  float amplitudeSum = 0.0;
+
+  for (int i = 0; i < octaveCount; ++i) {
+    float ridge = 1.0 - abs(computePerlin(coords * frequency));
+    total        += ridge * ridge * amplitude;
+    amplitudeSum += amplitude;
+
+    frequency *= 2.0;
+    amplitude *= 0.5;
+  }
+
+  return total / amplitudeSum;
+}
+
+float computeBillowFbm(vec2 coords, int octaveCount) {
+  float frequency    = 1.0;
+  float amplitude    = 1.0;
+  float total        = 0.0;
+  float amplitudeSum = 0.0;
+
+  for (int i = 0; i < octaveCount; ++i) {
+    total        += abs(computePerlin(coords * frequency)) * amplitude;
+    amplitudeSum += amplitude;
+
+    frequency *= 2.0;
+    amplitude *= 0.5;
+  }
+
+  return total / amplitudeSum;
+}
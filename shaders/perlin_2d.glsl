@@ -1,8 +1,4 @@
-layout(local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
-
-layout(r16f, binding = 0) uniform writeonly restrict image2D uniNoiseMap;
-uniform float uniNoiseFactor = 0.01;
-uniform int uniOctaveCount   = 1;
+// Perlin noise functions, prepended to the shaders needing them
 
 const int permutations[512] = int[](
   151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225, 140, 36, 103, 30, 69, 142,
@@ -54,8 +50,9 @@ float computePerlin(vec2 coords) {
   //     |      |
   // x0/y0______x0+1
 
-  int intX = int(coords.x);
-  int intY = int(coords.y);
+  // Flooring the coordinates, which may be negative
+  int intX = int(floor(coords.x));
+  int intY = int(floor(coords.y));
 
   int x0 = intX & 255;
   int y0 = intY & 255;
@@ -105,10 +102,3 @@ float computeFbm(vec2 coords, int octaveCount) {
 
   return (total + 1.0) / 2.0;
 }
-
-void main() {
-  float noise = computeFbm(vec2(gl_GlobalInvocationID.xy) * uniNoiseFactor, uniOctaveCount);
-
-  ivec2 pixelCoords = ivec2(gl_GlobalInvocationID.xy);
-  imageStore(uniNoiseMap, pixelCoords, vec4(vec3(noise), 1.0));
-}
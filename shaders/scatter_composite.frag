@@ -0,0 +1,26 @@
+struct Buffers {
+  sampler2D depth;
+  sampler2D color;
+};
+
+in vec2 fragTexcoords;
+
+uniform Buffers uniSceneBuffers;
+uniform Buffers uniInstanceBuffers;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out float fragDepth;
+
+void main() {
+  float sceneDepth    = texture(uniSceneBuffers.depth, fragTexcoords).r;
+  float instanceDepth = texture(uniInstanceBuffers.depth, fragTexcoords).r;
+
+  // Both having been rendered with the same camera, the closest of the two is the one visible
+  if (instanceDepth < sceneDepth) {
+    fragColor = vec4(texture(uniInstanceBuffers.color, fragTexcoords).rgb, 1.0);
+    fragDepth = instanceDepth;
+  } else {
+    fragColor = vec4(texture(uniSceneBuffers.color, fragTexcoords).rgb, 1.0);
+    fragDepth = sceneDepth;
+  }
+}
@@ -0,0 +1,15 @@
+in vec3 fragNormal;
+
+uniform vec3 uniBaseColor;
+uniform vec3 uniSunDir;
+
+const float skyLightFactor = 0.3; // Part of the light kept on the instances' unlit sides, standing for the light coming from the sky
+
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+  float sunLight = max(dot(normalize(fragNormal), -uniSunDir), 0.0);
+  vec3 color     = uniBaseColor * (skyLightFactor + (1.0 - skyLightFactor) * sunLight);
+
+  fragColor = vec4(pow(color, vec3(1.0 / 2.2)), 1.0);
+}
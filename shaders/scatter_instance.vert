@@ -0,0 +1,19 @@
+layout(location = 0) in vec3 vertPosition;
+layout(location = 1) in vec3 vertNormal;
+layout(location = 2) in vec3 instPosition;
+layout(location = 3) in vec2 instRotationScale; // Rotation around the vertical axis, in radians, & uniform scale
+
+uniform mat4 uniViewProjMatrix;
+
+out vec3 fragNormal;
+
+void main() {
+  float rotationCos = cos(instRotationScale.x);
+  float rotationSin = sin(instRotationScale.x);
+  mat3 rotation     = mat3(rotationCos, 0.0, -rotationSin,
+                           0.0,         1.0, 0.0,
+                           rotationSin, 0.0, rotationCos);
+
+  fragNormal  = rotation * vertNormal;
+  gl_Position = uniViewProjMatrix * vec4(instPosition + rotation * (vertPosition * instRotationScale.y), 1.0);
+}
@@ -0,0 +1,44 @@
+struct Buffers {
+  sampler2D depth;
+};
+
+in vec2 fragTexcoords;
+
+layout(std140) uniform uboCameraMatrices {
+  mat4 viewMat;
+  mat4 invViewMat;
+  mat4 projectionMat;
+  mat4 invProjectionMat;
+  mat4 viewProjectionMat;
+  vec3 cameraPos;
+};
+
+uniform Buffers uniSceneBuffers;
+uniform vec2 uniTerrainSize;     // Number of vertices along the terrain's width & depth
+uniform float uniTexelsPerCell;  // Number of the finest level's texels along a grid cell
+uniform int uniMipCount;
+uniform float uniFeedbackScale;  // Number of scene pixels along a feedback texel
+
+layout(location = 0) out vec4 fragFeedback;
+
+// Writes the tile & mip level needed by the terrain at each pixel, as bytes; the alpha channel is 0 where no tile is needed
+void main() {
+  float depth = texture(uniSceneBuffers.depth, fragTexcoords).r;
+
+  vec4 viewPos  = invProjectionMat * vec4(vec3(fragTexcoords, depth) * 2.0 - 1.0, 1.0);
+  vec3 worldPos = (invViewMat * vec4(viewPos.xyz / viewPos.w, 1.0)).xyz;
+
+  // Inverse of the static terrain's vertices' placement, grid cells being half a unit wide & both axes being centered with its width
+  vec2 gridCoords    = worldPos.xz * 2.0 + uniTerrainSize.x * 0.5;
+  vec2 virtualCoords = gridCoords * uniTexelsPerCell;
+
+  // The level is computed before any branching, derivatives being undefined otherwise
+  int level = computeVirtualLevel(virtualCoords, uniFeedbackScale, uniMipCount);
+
+  if (depth >= 1.0 || any(lessThan(gridCoords, vec2(0.0))) || any(greaterThanEqual(gridCoords, uniTerrainSize))) {
+    fragFeedback = vec4(0.0);
+    return;
+  }
+
+  fragFeedback = vec4(vec3(computeVirtualTileCoords(virtualCoords, level), level) / 255.0, 1.0);
+}
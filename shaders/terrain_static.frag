@@ -0,0 +1,157 @@
+struct Light {
+  vec4 position;
+  vec4 direction;
+  vec4 color;
+  float energy;
+  float angle;
+};
+
+struct MeshInfo {
+  vec3 vertPosition;
+  vec2 vertTexcoords;
+  mat3 vertTBNMatrix;
+};
+
+in MeshInfo vertMeshInfo;
+
+struct Material {
+  vec3 baseColor;
+  vec3 emissive;
+  float metallicFactor;
+  float roughnessFactor;
+
+  sampler2D baseColorMap;
+  sampler2D emissiveMap;
+  sampler2D normalMap;
+  sampler2D metallicMap;
+  sampler2D roughnessMap;
+  sampler2D ambientMap;
+};
+
+layout(std140) uniform uboCameraInfo {
+  mat4 uniViewMat;
+  mat4 uniInvViewMat;
+  mat4 uniProjectionMat;
+  mat4 uniInvProjectionMat;
+  mat4 uniViewProjectionMat;
+  vec3 uniCameraPos;
+};
+
+layout(std140) uniform uboLightsInfo {
+  Light uniLights[100];
+  uint uniLightCount;
+};
+
+uniform Material uniMaterial;
+uniform sampler2D uniSunVisibilityMap; // Part of the sun's disk above the horizon, applied to the directional lights; white until baked
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec4 bufferNormal;
+layout(location = 2) out vec4 bufferSpecular;
+
+const float PI = 3.1415926535897932384626433832795;
+
+// Same Cook-Torrance lighting as the engine's default material, the horizon maps only being applied as additional factors
+
+float computeNormalDistrib(vec3 normal, vec3 halfVec, float roughness) {
+  float sqrRough  = roughness * roughness;
+  float frthRough = sqrRough * sqrRough;
+
+  float halfVecAngle    = max(dot(halfVec, normal), 0.0);
+  float sqrHalfVecAngle = halfVecAngle * halfVecAngle;
+
+  float divider = (sqrHalfVecAngle * (frthRough - 1.0) + 1.0);
+  divider       = PI * divider * divider;
+
+  return frthRough / max(divider, 0.001);
+}
+
+vec3 computeFresnel(float cosTheta, vec3 baseReflectivity) {
+  return baseReflectivity + (1.0 - baseReflectivity) * pow(1.0 - cosTheta, 5.0);
+}
+
+float computeGeometryShlickGGX(float angle, float roughness) {
+  float incrRough   = (roughness + 1.0);
+  float roughFactor = (incrRough * incrRough) / 8.0;
+
+  return angle / (angle * (1.0 - roughFactor) + roughFactor);
+}
+
+float computeGeometry(vec3 normal, vec3 viewDir, vec3 lightDir, float roughness) {
+  float viewAngle  = max(dot(normal, viewDir), 0.0);
+  float lightAngle = max(dot(normal, lightDir), 0.0);
+
+  return computeGeometryShlickGGX(viewAngle, roughness) * computeGeometryShlickGGX(lightAngle, roughness);
+}
+
+void main() {
+  vec3 albedo          = pow(texture(uniMaterial.baseColorMap, vertMeshInfo.vertTexcoords).rgb, vec3(2.2)) * uniMaterial.baseColor;
+  vec3 emissive        = texture(uniMaterial.emissiveMap, vertMeshInfo.vertTexcoords).rgb * uniMaterial.emissive;
+  float metallic       = texture(uniMaterial.metallicMap, vertMeshInfo.vertTexcoords).r * uniMaterial.metallicFactor;
+  float roughness      = texture(uniMaterial.roughnessMap, vertMeshInfo.vertTexcoords).r * uniMaterial.roughnessFactor;
+  float ambOcc         = texture(uniMaterial.ambientMap, vertMeshInfo.vertTexcoords).r;
+  float sunVisibility  = texture(uniSunVisibilityMap, vertMeshInfo.vertTexcoords).r;
+
+  vec3 normal = texture(uniMaterial.normalMap, vertMeshInfo.vertTexcoords).rgb;
+  normal      = normalize(normal * 2.0 - 1.0);
+  normal      = normalize(vertMeshInfo.vertTBNMatrix * normal);
+
+  vec3 viewDir = normalize(uniCameraPos - vertMeshInfo.vertPosition);
+
+  // Base Fresnel (F)
+  vec3 baseReflectivity = mix(vec3(0.04), albedo, metallic);
+
+  vec3 lightRadiance = vec3(0.0);
+
+  for (uint lightIndex = 0u; lightIndex < uniLightCount; ++lightIndex) {
+    vec3 fullLightDir;
+    float attenuation = uniLights[lightIndex].energy;
+
+    if (uniLights[lightIndex].position.w != 0.0) {
+      fullLightDir = uniLights[lightIndex].position.xyz - vertMeshInfo.vertPosition;
+
+      float sqrDist = dot(fullLightDir, fullLightDir);
+      attenuation  /= sqrDist;
+    } else {
+      fullLightDir = -uniLights[lightIndex].direction.xyz;
+
+      // The sun visibility being baked for the sun's direction, it only occludes the directional lights
+      attenuation *= sunVisibility;
+    }
+
+    vec3 lightDir = normalize(fullLightDir);
+    vec3 halfDir  = normalize(viewDir + lightDir);
+    vec3 radiance = uniLights[lightIndex].color.rgb * attenuation;
+
+    // Normal distrib (D)
+    float normalDistrib = computeNormalDistrib(normal, halfDir, roughness);
+
+    // Fresnel (F)
+    vec3 fresnel = computeFresnel(max(dot(halfDir, viewDir), 0.0), baseReflectivity);
+
+    // Geometry (G)
+    float geometry = computeGeometry(normal, viewDir, lightDir, roughness);
+
+    vec3 DFG      = normalDistrib * fresnel * geometry;
+    float divider = 4.0 * max(dot(normal, viewDir), 0.0) * max(dot(normal, lightDir), 0.0);
+    vec3 specular = DFG / max(divider, 0.001);
+
+    vec3 diffuse = vec3(1.0) - fresnel;
+    diffuse     *= 1.0 - metallic;
+
+    float lightAngle = max(dot(lightDir, normal), 0.0);
+    lightRadiance   += (diffuse * albedo / PI + specular) * radiance * lightAngle;
+  }
+
+  vec3 ambient = vec3(0.03) * albedo * ambOcc;
+  vec3 color   = ambient + lightRadiance + emissive;
+
+  // HDR tone mapping
+  color = color / (color + vec3(1.0));
+  // Gamma correction
+  color = pow(color, vec3(1.0 / 2.2));
+
+  fragColor      = vec4(color, 1.0);
+  bufferNormal   = vec4(normal * 0.5 + 0.5, 1.0);
+  bufferSpecular = vec4(baseReflectivity, roughness);
+}
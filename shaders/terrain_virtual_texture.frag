@@ -0,0 +1,60 @@
+struct MeshInfo {
+  vec3 vertPosition;
+  vec2 vertTexcoords;
+  mat3 vertTBNMatrix;
+};
+
+in MeshInfo vertMeshInfo;
+
+struct VirtualTexture {
+  sampler2D pageTable;
+  sampler2D colorCache;
+  sampler2D surfaceCache;
+};
+
+uniform VirtualTexture uniVirtualTexture;
+uniform vec2 uniVirtualSize; // Number of the finest level's texels along the terrain's width & depth
+uniform int uniTileCount;    // Number of tiles per side of the finest level
+uniform int uniMipCount;
+uniform vec3 uniSunDir;
+
+const float cellWorldSize  = 0.5; // World distance between two of the terrain's grid vertices
+const float skyLightFactor = 0.3; // Part of the light kept where the sun is occluded, standing for the light coming from the sky
+
+layout(location = 0) out vec4 fragColor;
+
+// Same decompression as the static terrain's compressed slope map
+vec2 decompressGradient(vec2 compressedGradient) {
+  vec2 remappedGradient = (compressedGradient * 255.0 - 128.0) / 127.0;
+  return remappedGradient / (1.0 - min(abs(remappedGradient), 0.99));
+}
+
+void main() {
+  vec2 virtualCoords = vertMeshInfo.vertTexcoords * uniVirtualSize;
+  int level          = computeVirtualLevel(virtualCoords, 1.0, uniMipCount);
+
+  // The page table's levels are laid out side by side, each half as wide as the previous one
+  ivec2 tileCoords = clamp(computeVirtualTileCoords(virtualCoords, level), ivec2(0), ivec2((uniTileCount >> level) - 1));
+  ivec2 pageCoords = ivec2(2 * uniTileCount - ((2 * uniTileCount) >> level) + tileCoords.x, tileCoords.y);
+  ivec3 tileEntry  = ivec3(round(texelFetch(uniVirtualTexture.pageTable, pageCoords, 0).rgb * 255.0)); // Cache slot & level of the tile to sample
+
+  // The tile sampled is coarser than the one requested if the latter is not resident yet
+  vec2 levelCoords     = virtualCoords / float(1 << tileEntry.z);
+  vec2 tileOrigin      = vec2(tileCoords >> (tileEntry.z - level)) * virtualTileSize;
+  vec2 tileTexelCoords = clamp(levelCoords - tileOrigin, vec2(0.0), vec2(virtualTileSize));
+  vec2 cacheCoords     = vec2(tileEntry.xy) * (virtualTileSize + 2.0 * virtualTileBorder) + virtualTileBorder + tileTexelCoords;
+  vec2 cacheUV         = cacheCoords / vec2(textureSize(uniVirtualTexture.colorCache, 0));
+
+  // The caches have no mipmaps, each of their tiles being already at the level needed
+  vec3 baseColor = pow(textureLod(uniVirtualTexture.colorCache, cacheUV, 0.0).rgb, vec3(2.2));
+  vec4 surface   = textureLod(uniVirtualTexture.surfaceCache, cacheUV, 0.0); // Compressed half gradient, ambient occlusion & sun visibility
+
+  // The half gradient holding the height differences over a grid cell, the normal is recovered from it & the cell's world size
+  vec2 halfGradient = decompressGradient(surface.rg);
+  vec3 normal       = normalize(vec3(halfGradient.x, cellWorldSize, halfGradient.y));
+
+  float sunLight = max(dot(normal, -uniSunDir), 0.0) * surface.a;
+  vec3 color     = baseColor * (skyLightFactor * surface.b + (1.0 - skyLightFactor) * sunLight);
+
+  fragColor = vec4(pow(color, vec3(1.0 / 2.2)), 1.0);
+}
@@ -0,0 +1,18 @@
+// Addressing of the static terrain's virtual texture, prepended to the shaders sampling it or requesting its tiles
+
+const float virtualTileSize   = 128.0; // Must be the same as TerrainVirtualTexture::tileSize
+const float virtualTileBorder = 1.0;   // Must be the same as TerrainVirtualTexture::tileBorder
+
+// Mip level at which a virtual texel covers about a pixel, from the derivatives of the finest level's texel coordinates
+// The derivatives are divided by the given scale, for passes rendered at a lower resolution than the scene
+int computeVirtualLevel(vec2 virtualCoords, float derivativeScale, int mipCount) {
+  vec2 horizDeriv = dFdx(virtualCoords) / derivativeScale;
+  vec2 vertDeriv  = dFdy(virtualCoords) / derivativeScale;
+
+  float level = 0.5 * log2(max(max(dot(horizDeriv, horizDeriv), dot(vertDeriv, vertDeriv)), 1.0));
+  return min(int(level), mipCount - 1);
+}
+
+ivec2 computeVirtualTileCoords(vec2 virtualCoords, int level) {
+  return ivec2(virtualCoords / (virtualTileSize * float(1 << level)));
+}
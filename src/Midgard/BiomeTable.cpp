@@ -0,0 +1,119 @@
+#include "Midgard/BiomeTable.hpp"
+
+#include <RaZ/Math/MathUtils.hpp>
+#include <RaZ/Math/PerlinNoise.hpp>
+#include <RaZ/Utils/Logger.hpp>
+
+#include <tracy/Tracy.hpp>
+
+#include <utility>
+
+namespace {
+
+constexpr Raz::Vec3b waterColor(0, 0, 255);
+constexpr Raz::Vec3b grassColor(62, 126, 0);
+constexpr Raz::Vec3b groundColor(157, 110, 94);
+constexpr Raz::Vec3b rockColor(127, 127, 127);
+constexpr Raz::Vec3b snowColor(255, 255, 255);
+
+// The moisture noise is shifted so that it does not follow the heights, which are computed from the same noise
+constexpr float moistureNoiseOffset = 117.3f;
+constexpr int moistureOctaveCount   = 4;
+
+} // namespace
+
+BiomeTable::BiomeTable() {
+  ZoneScopedN("BiomeTable::BiomeTable");
+
+  // Height bands of the former hardcoded coloring, applied like it to the heights before flattening
+  Biome water { 0.f, 0.33f };
+  water.lowColor  = waterColor;
+  water.highColor = grassColor;
+
+  Biome grass { 0.33f, 0.5f };
+  grass.lowColor   = grassColor;
+  grass.highColor  = groundColor;
+  grass.materialId = 1;
+
+  Biome ground { 0.5f, 0.66f };
+  ground.lowColor   = groundColor;
+  ground.highColor  = rockColor;
+  ground.materialId = 2;
+
+  Biome snow { 0.66f, 1.f };
+  snow.lowColor   = rockColor;
+  snow.highColor  = snowColor;
+  snow.materialId = 3;
+
+  // Slopes too steep for the soil to hold, whatever the height above the water
+  Biome cliffs { 0.33f, 1.f, 1.f };
+  cliffs.lowColor   = rockColor;
+  cliffs.highColor  = rockColor;
+  cliffs.materialId = 4;
+
+  setBiomes({ water, grass, ground, snow, cliffs });
+}
+
+void BiomeTable::setBiomes(std::vector<Biome> biomes) {
+  m_biomes = std::move(biomes);
+  bake();
+}
+
+void BiomeTable::setMoistureFactor(float moistureFactor) {
+  if (moistureFactor <= 0.f) {
+    Raz::Logger::warn("[BiomeTable] The moisture factor can't be 0 or negative; remapping to +epsilon.");
+    moistureFactor = std::numeric_limits<float>::epsilon();
+  }
+
+  m_moistureFactor = moistureFactor;
+}
+
+float BiomeTable::computeMoisture(float x, float z) const {
+  return Raz::PerlinNoise::compute2D(x * m_moistureFactor + moistureNoiseOffset, z * m_moistureFactor + moistureNoiseOffset, moistureOctaveCount, true);
+}
+
+void BiomeTable::bake() {
+  ZoneScopedN("BiomeTable::bake");
+
+  m_lookupTable = Raz::Image(heightResolution, slopeResolution * moistureResolution, Raz::ImageColorspace::RGBA);
+  auto* tableData = static_cast<uint8_t*>(m_lookupTable.getDataPtr());
+
+  m_isMoistureUsed = std::any_of(m_biomes.cbegin(), m_biomes.cend(), [] (const Biome& biome) noexcept {
+    return (biome.minMoisture > 0.f || biome.maxMoisture < 1.f);
+  });
+
+  // Each cell is classified from its center; the biomes being evaluated in order, the last one matching takes precedence
+  for (unsigned int moistureIndex = 0; moistureIndex < moistureResolution; ++moistureIndex) {
+    const float moisture = (static_cast<float>(moistureIndex) + 0.5f) / static_cast<float>(moistureResolution);
+
+    for (unsigned int slopeIndex = 0; slopeIndex < slopeResolution; ++slopeIndex) {
+      const float slopeStrength = (static_cast<float>(slopeIndex) + 0.5f) / static_cast<float>(slopeResolution) * maxSlopeStrength;
+      uint8_t* rowData = tableData + static_cast<std::size_t>(moistureIndex * slopeResolution + slopeIndex) * heightResolution * 4;
+
+      for (unsigned int heightIndex = 0; heightIndex < heightResolution; ++heightIndex) {
+        const float height = (static_cast<float>(heightIndex) + 0.5f) / static_cast<float>(heightResolution);
+
+        Raz::Vec3b color {};
+        uint8_t materialId {};
+
+        for (const Biome& biome : m_biomes) {
+          if (height < biome.minHeight || height > biome.maxHeight
+           || slopeStrength < biome.minSlope || slopeStrength > biome.maxSlope
+           || moisture < biome.minMoisture || moisture > biome.maxMoisture) {
+            continue;
+          }
+
+          const float heightRange = biome.maxHeight - biome.minHeight;
+          color      = Raz::MathUtils::lerp(biome.lowColor, biome.highColor, (heightRange > 0.f ? (height - biome.minHeight) / heightRange : 0.f));
+          materialId = biome.materialId;
+        }
+
+        uint8_t* cellData = rowData + static_cast<std::size_t>(heightIndex) * 4;
+        cellData[0] = color.x();
+        cellData[1] = color.y();
+        cellData[2] = color.z();
+        cellData[3] = materialId;
+      }
+    }
+  }
+}
@@ -10,10 +10,19 @@
 #include <GL/glew.h> // Needed by TracyOpenGL.hpp
 #include <tracy/TracyOpenGL.hpp>
 
+#include <cmath>
+#include <string>
+#include <utility>
+
 namespace {
 
 constexpr int heightmapSize = 1024;
 
+constexpr int clipmapLevelSize           = 256;  // Must be a power of two, the maps being addressed toroidally
+constexpr float clipmapBaseTexelSize     = 0.5f; // Same as the fixed terrain's default heightmap
+constexpr unsigned int clipmapPatchCount = 8;    // Per side; with patches of 20 texels, a level's patches always remain within its maps
+constexpr float clipmapPatchTexelCount   = 20.f;
+
 constexpr std::string_view tessCtrlSource = {
 #include "terrain.tesc.embed"
 };
@@ -22,8 +31,16 @@ constexpr std::string_view tessEvalSource = {
 #include "terrain.tese.embed"
 };
 
+constexpr std::string_view perlinSource = {
+#include "perlin_2d.glsl.embed"
+};
+
+constexpr std::string_view noiseGraphSource = {
+#include "noise_graph.glsl.embed"
+};
+
 constexpr std::string_view noiseCompSource = {
-#include "perlin_noise_2d.comp.embed"
+#include "noise_graph_2d.comp.embed"
 };
 
 constexpr std::string_view colorCompSource = {
@@ -34,6 +51,16 @@ constexpr std::string_view slopeCompSource = {
 #include "slope.comp.embed"
 };
 
+// The noise functions being shared, they are prepended to the shaders using them
+inline std::string prependNoiseFunctions(std::string_view shaderSource) {
+  return std::string(perlinSource) + std::string(shaderSource);
+}
+
+// The noise graph's function, generated on the CPU, is inserted between the noise sources it calls & the shader calling it
+inline std::string createNoiseShaderSource(const std::string& noiseGraphFunction) {
+  return std::string(perlinSource) + std::string(noiseGraphSource) + noiseGraphFunction + std::string(noiseCompSource);
+}
+
 inline void checkParameters(float& minTessLevel) {
   if (minTessLevel <= 0.f) {
     Raz::Logger::warn("[DynamicTerrain] The minimal tessellation level can't be 0 or negative; remapping to +epsilon.");
@@ -51,25 +78,33 @@ DynamicTerrain::DynamicTerrain(Raz::Entity& entity) : Terrain(entity) {
   terrainProgram.setTessellationEvaluationShader(Raz::TessellationEvaluationShader::loadFromSource(tessEvalSource));
   terrainProgram.link();
 
-  m_noiseMap = Raz::Texture2D::create(heightmapSize, heightmapSize, Raz::TextureColorspace::GRAY, Raz::TextureDataType::FLOAT16);
-  m_colorMap = Raz::Texture2D::create(heightmapSize, heightmapSize, Raz::TextureColorspace::RGBA, Raz::TextureDataType::BYTE);
-  m_slopeMap = Raz::Texture2D::create(heightmapSize, heightmapSize, Raz::TextureColorspace::RGBA, Raz::TextureDataType::FLOAT16);
+  m_noiseMap    = Raz::Texture2D::create(heightmapSize, heightmapSize, Raz::TextureColorspace::GRAY, Raz::TextureDataType::FLOAT16);
+  m_colorMap    = Raz::Texture2D::create(heightmapSize, heightmapSize, Raz::TextureColorspace::RGBA, Raz::TextureDataType::BYTE);
+  m_slopeMap    = Raz::Texture2D::create(heightmapSize, heightmapSize, Raz::TextureColorspace::RGBA, Raz::TextureDataType::FLOAT16);
+  m_materialMap = Raz::Texture2D::create(heightmapSize, heightmapSize, Raz::TextureColorspace::GRAY, Raz::TextureDataType::BYTE);
+
+  m_biomeTableTexture = Raz::Texture2D::create(m_biomeTable.getLookupTable(), false);
 
 #if !defined(USE_OPENGL_ES)
   if (Raz::Renderer::checkVersion(4, 3)) {
     Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_noiseMap->getIndex(), "Noise map");
     Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_colorMap->getIndex(), "Color map");
     Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_slopeMap->getIndex(), "Slope map");
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_materialMap->getIndex(), "Material map");
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_biomeTableTexture->getIndex(), "Biome table");
   }
 #endif
 
-  m_noiseProgram.setShader(Raz::ComputeShader::loadFromSource(noiseCompSource));
-  m_noiseProgram.setAttribute(8, "uniOctaveCount");
+  m_noiseGraphFunction = NoiseGraph::generateGlsl(NoiseGraph::perlin(1.f, 8));
+
+  m_noiseProgram.setShader(Raz::ComputeShader::loadFromSource(createNoiseShaderSource(m_noiseGraphFunction)));
   m_noiseProgram.setImageTexture(m_noiseMap, "uniNoiseMap", Raz::ImageTextureUsage::WRITE);
 
-  m_colorProgram.setShader(Raz::ComputeShader::loadFromSource(colorCompSource));
-  m_colorProgram.setImageTexture(m_noiseMap, "uniHeightmap", Raz::ImageTextureUsage::READ);
-  m_colorProgram.setImageTexture(m_colorMap, "uniColorMap", Raz::ImageTextureUsage::WRITE);
+  setupColorProgram(m_colorProgram, m_noiseMap, m_colorMap, m_materialMap);
+  // Unlike the clipmap levels, the fixed terrain has a slope map, from which its color map reads the slopes instead of computing them again
+  m_colorProgram.setImageTexture(m_slopeMap, "uniSlopeMap", Raz::ImageTextureUsage::READ);
+  m_colorProgram.setAttribute(static_cast<int>(true), "uniUseSlopeMap");
+  m_colorProgram.sendAttributes();
 
   m_slopeProgram.setShader(Raz::ComputeShader::loadFromSource(slopeCompSource));
   m_slopeProgram.setImageTexture(m_noiseMap, "uniHeightmap", Raz::ImageTextureUsage::READ);
@@ -92,6 +127,10 @@ DynamicTerrain::DynamicTerrain(Raz::Entity& entity, unsigned int width, unsigned
   terrainProgram.sendAttributes();
 
   DynamicTerrain::generate(width, depth, heightFactor, flatness, minTessLevel);
+
+  // The slopes classifying the texels into biomes depend on the height factor & flatness, which were not yet set
+  computeSlopeMap();
+  computeColorMap();
 }
 
 void DynamicTerrain::setParameters(float minTessLevel, float heightFactor, float flatness) {
@@ -102,20 +141,54 @@ void DynamicTerrain::setParameters(float minTessLevel, float heightFactor, float
   ::checkParameters(minTessLevel);
   m_minTessLevel = minTessLevel;
 
-  Raz::RenderShaderProgram& terrainProgram = m_entity.getComponent<Raz::MeshRenderer>().getMaterials().front().getProgram();
-  terrainProgram.setAttribute(m_minTessLevel, "uniTessLevel");
-  terrainProgram.setAttribute(m_heightFactor, "uniHeightFactor");
-  terrainProgram.setAttribute(m_flatness, "uniFlatness");
-  terrainProgram.sendAttributes();
+  // The first material is used by the fixed terrain, the following ones by each clipmap level
+  for (Raz::Material& material : m_entity.getComponent<Raz::MeshRenderer>().getMaterials()) {
+    Raz::RenderShaderProgram& terrainProgram = material.getProgram();
+    terrainProgram.setAttribute(m_minTessLevel, "uniTessLevel");
+    terrainProgram.setAttribute(m_heightFactor, "uniHeightFactor");
+    terrainProgram.setAttribute(m_flatness, "uniFlatness");
+    terrainProgram.sendAttributes();
+  }
 
   m_slopeProgram.setAttribute(m_heightFactor, "uniHeightFactor");
   m_slopeProgram.setAttribute(m_flatness, "uniFlatness");
   m_slopeProgram.sendAttributes();
+
+  m_colorProgram.setAttribute(m_heightFactor, "uniHeightFactor");
+  m_colorProgram.setAttribute(m_flatness, "uniFlatness");
+  m_colorProgram.sendAttributes();
+
+  for (ClipmapLevel& level : m_clipmapLevels) {
+    level.colorProgram.setAttribute(m_heightFactor, "uniHeightFactor");
+    level.colorProgram.setAttribute(m_flatness, "uniFlatness");
+    level.isFilled = false;
+  }
+}
+
+void DynamicTerrain::setBiomeTable(BiomeTable biomeTable) {
+  ZoneScopedN("DynamicTerrain::setBiomeTable");
+
+  m_biomeTable = std::move(biomeTable);
+
+  // Only the table is uploaded again; the color programs are left untouched
+  m_biomeTableTexture->load(m_biomeTable.getLookupTable(), false);
+
+  sendBiomeAttributes(m_colorProgram);
+  computeColorMap();
+
+  for (ClipmapLevel& level : m_clipmapLevels) {
+    sendBiomeAttributes(level.colorProgram);
+    level.isFilled = false;
+  }
 }
 
 void DynamicTerrain::generate(unsigned int width, unsigned int depth, float heightFactor, float flatness, float minTessLevel) {
   ZoneScopedN("DynamicTerrain::generate");
 
+  m_width            = width;
+  m_depth            = depth;
+  m_isClipmapEnabled = false;
+
   auto& mesh = m_entity.getComponent<Raz::Mesh>();
   mesh.getSubmeshes().resize(1);
 
@@ -166,26 +239,52 @@ void DynamicTerrain::generate(unsigned int width, unsigned int depth, float heig
     }
   }
 
-  m_entity.getComponent<Raz::MeshRenderer>().load(mesh, Raz::RenderMode::PATCH);
+  auto& meshRenderer = m_entity.getComponent<Raz::MeshRenderer>();
+  meshRenderer.load(mesh, Raz::RenderMode::PATCH);
+  meshRenderer.getSubmeshRenderers().front().setMaterialIndex(0);
   Raz::Renderer::setPatchVertexCount(4); // Since the terrain is made of quads
 
   setParameters(minTessLevel, heightFactor, flatness);
 }
 
+void DynamicTerrain::setNoiseGraphFunction(std::string noiseGraphFunction) {
+  ZoneScopedN("DynamicTerrain::setNoiseGraphFunction");
+
+  m_noiseGraphFunction = std::move(noiseGraphFunction);
+
+  // The programs keep their attributes & textures, which only need to be sent again
+  m_noiseProgram.setShader(Raz::ComputeShader::loadFromSource(createNoiseShaderSource(m_noiseGraphFunction)));
+
+  for (ClipmapLevel& level : m_clipmapLevels)
+    level.noiseProgram.setShader(Raz::ComputeShader::loadFromSource(createNoiseShaderSource(m_noiseGraphFunction)));
+
+  computeNoiseMap(m_noiseFactor);
+  computeSlopeMap();
+  computeColorMap();
+}
+
 const Raz::Texture2D& DynamicTerrain::computeNoiseMap(float factor) {
   ZoneScopedN("DynamicTerrain::computeNoiseMap");
   TracyGpuZone("DynamicTerrain::computeNoiseMap")
+  const ScopedGpuTimer gpuTimer(m_noiseMapTimer);
+
+  m_noiseFactor = factor;
 
   m_noiseProgram.setAttribute(factor, "uniNoiseFactor");
   m_noiseProgram.sendAttributes();
   m_noiseProgram.execute(heightmapSize, heightmapSize);
 
+  // The clipmap levels are filled again on the next update
+  for (ClipmapLevel& level : m_clipmapLevels)
+    level.isFilled = false;
+
   return *m_noiseMap;
 }
 
 const Raz::Texture2D& DynamicTerrain::computeColorMap() {
   ZoneScopedN("DynamicTerrain::computeColorMap");
   TracyGpuZone("DynamicTerrain::computeColorMap")
+  const ScopedGpuTimer gpuTimer(m_colorMapTimer);
 
   m_colorProgram.execute(heightmapSize, heightmapSize);
 
@@ -195,8 +294,275 @@ const Raz::Texture2D& DynamicTerrain::computeColorMap() {
 const Raz::Texture2D& DynamicTerrain::computeSlopeMap() {
   ZoneScopedN("DynamicTerrain::computeSlopeMap");
   TracyGpuZone("DynamicTerrain::computeSlopeMap")
+  const ScopedGpuTimer gpuTimer(m_slopeMapTimer);
 
   m_slopeProgram.execute(heightmapSize, heightmapSize);
 
   return *m_slopeMap;
 }
+
+std::size_t DynamicTerrain::getPatchCount() const {
+  std::size_t patchVertexCount = 0;
+
+  for (const Raz::Submesh& submesh : m_entity.getComponent<Raz::Mesh>().getSubmeshes())
+    patchVertexCount += submesh.getVertices().size();
+
+  return patchVertexCount / 4;
+}
+
+void DynamicTerrain::enableClipmap(unsigned int levelCount) {
+  ZoneScopedN("DynamicTerrain::enableClipmap");
+
+  if (levelCount == 0) {
+    Raz::Logger::warn("[DynamicTerrain] The clipmap must have at least one level; remapping to 1.");
+    levelCount = 1;
+  }
+
+  if (m_clipmapLevels.size() != levelCount) {
+    m_clipmapLevels.clear();
+    m_clipmapLevels.resize(levelCount);
+
+    for (std::size_t levelIndex = 0; levelIndex < m_clipmapLevels.size(); ++levelIndex) {
+      ClipmapLevel& level = m_clipmapLevels[levelIndex];
+      level.texelSize = clipmapBaseTexelSize * static_cast<float>(1u << levelIndex);
+
+      // The maps repeating, sampling them with unbounded texcoords wraps around them like they are stored
+      level.noiseMap    = Raz::Texture2D::create(clipmapLevelSize, clipmapLevelSize, Raz::TextureColorspace::GRAY, Raz::TextureDataType::FLOAT16);
+      level.colorMap    = Raz::Texture2D::create(clipmapLevelSize, clipmapLevelSize, Raz::TextureColorspace::RGBA, Raz::TextureDataType::BYTE);
+      level.materialMap = Raz::Texture2D::create(clipmapLevelSize, clipmapLevelSize, Raz::TextureColorspace::GRAY, Raz::TextureDataType::BYTE);
+      level.noiseMap->setWrapping(Raz::TextureWrapping::REPEAT);
+      level.colorMap->setWrapping(Raz::TextureWrapping::REPEAT);
+      level.materialMap->setWrapping(Raz::TextureWrapping::REPEAT);
+
+#if !defined(USE_OPENGL_ES)
+      if (Raz::Renderer::checkVersion(4, 3)) {
+        Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, level.noiseMap->getIndex(), "Clipmap noise map #" + std::to_string(levelIndex));
+        Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, level.colorMap->getIndex(), "Clipmap color map #" + std::to_string(levelIndex));
+        Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, level.materialMap->getIndex(), "Clipmap material map #" + std::to_string(levelIndex));
+      }
+#endif
+
+      level.noiseProgram.setShader(Raz::ComputeShader::loadFromSource(createNoiseShaderSource(m_noiseGraphFunction)));
+      level.noiseProgram.setAttribute(clipmapLevelSize, "uniWrapSize");
+      level.noiseProgram.setImageTexture(level.noiseMap, "uniNoiseMap", Raz::ImageTextureUsage::WRITE);
+
+      setupColorProgram(level.colorProgram, level.noiseMap, level.colorMap, level.materialMap);
+      level.colorProgram.setAttribute(clipmapLevelSize, "uniWrapSize");
+      level.colorProgram.setAttribute(level.texelSize / clipmapBaseTexelSize, "uniTexelScale");
+    }
+  }
+
+  auto& meshRenderer = m_entity.getComponent<Raz::MeshRenderer>();
+
+  // Materials of a previous clipmap are reused; those in excess are simply left unused
+  while (meshRenderer.getMaterials().size() < m_clipmapLevels.size() + 1) {
+    Raz::RenderShaderProgram& levelProgram = meshRenderer.addMaterial(Raz::Material(Raz::MaterialType::COOK_TORRANCE)).getProgram();
+    levelProgram.setTessellationControlShader(Raz::TessellationControlShader::loadFromSource(tessCtrlSource));
+    levelProgram.setTessellationEvaluationShader(Raz::TessellationEvaluationShader::loadFromSource(tessEvalSource));
+    levelProgram.link();
+    levelProgram.setAttribute(0.f, Raz::MaterialAttribute::Roughness);
+  }
+
+  for (std::size_t levelIndex = 0; levelIndex < m_clipmapLevels.size(); ++levelIndex) {
+    ClipmapLevel& level = m_clipmapLevels[levelIndex];
+    level.isFilled = false;
+
+    Raz::RenderShaderProgram& levelProgram = meshRenderer.getMaterials()[levelIndex + 1].getProgram();
+    levelProgram.setTexture(level.noiseMap, "uniHeightmap");
+    levelProgram.setTexture(level.colorMap, Raz::MaterialTexture::BaseColor);
+    levelProgram.setAttribute(Raz::Vec2u(static_cast<unsigned int>(clipmapLevelSize)), "uniTerrainSize");
+    levelProgram.setAttribute(level.texelSize, "uniSampleDistance");
+    levelProgram.setAttribute(clipmapPatchTexelCount * level.texelSize, "uniPatchSize");
+
+    // Each level is morphed toward the next coarser one near its border, & both are stitched along it; the coarsest has none to morph toward
+    const bool hasCoarserLevel       = (levelIndex + 1 < m_clipmapLevels.size());
+    const ClipmapLevel& coarserLevel = (hasCoarserLevel ? m_clipmapLevels[levelIndex + 1] : level);
+    levelProgram.setTexture(coarserLevel.noiseMap, "uniCoarseHeightmap");
+    levelProgram.setAttribute(1.f / (static_cast<float>(clipmapLevelSize) * coarserLevel.texelSize), "uniCoarseMapScale");
+    levelProgram.setAttribute(coarserLevel.texelSize, "uniCoarseSampleDistance");
+    levelProgram.setAttribute(static_cast<int>(hasCoarserLevel), "uniHasCoarserLevel");
+    levelProgram.setAttribute(static_cast<int>(levelIndex > 0), "uniHasFinerLevel");
+  }
+
+  m_isClipmapEnabled = true;
+  setParameters(m_minTessLevel, m_heightFactor, m_flatness);
+}
+
+void DynamicTerrain::disableClipmap() {
+  ZoneScopedN("DynamicTerrain::disableClipmap");
+
+  if (!m_isClipmapEnabled)
+    return;
+
+  generate(m_width, m_depth, m_heightFactor, m_flatness, m_minTessLevel);
+}
+
+void DynamicTerrain::update(const Raz::Vec3f& cameraPos) {
+  ZoneScopedN("DynamicTerrain::update");
+
+  if (!m_isClipmapEnabled)
+    return;
+
+  TracyGpuZone("DynamicTerrain::update")
+
+  m_lastUpdatedTexelCount = 0;
+  bool isGridShifted      = false;
+
+  for (ClipmapLevel& level : m_clipmapLevels) {
+    // Keeping the level's maps centered on the camera, snapped to their texels
+    const Raz::Vec2i texelOrigin(static_cast<int>(std::floor(cameraPos.x() / level.texelSize)) - clipmapLevelSize / 2,
+                                 static_cast<int>(std::floor(cameraPos.z() / level.texelSize)) - clipmapLevelSize / 2);
+    const Raz::Vec2i texelShift = texelOrigin - level.texelOrigin;
+
+    if (!level.isFilled || std::abs(texelShift.x()) >= clipmapLevelSize || std::abs(texelShift.y()) >= clipmapLevelSize) {
+      level.noiseProgram.setAttribute(m_noiseFactor * level.texelSize / clipmapBaseTexelSize, "uniNoiseFactor");
+      updateClipmapRegion(level, texelOrigin.x(), texelOrigin.y(), clipmapLevelSize, clipmapLevelSize);
+
+      isGridShifted  = true;
+      level.isFilled = true;
+    } else {
+      // Only computing the columns & rows exposed by the move, which overwrite those left behind on the other side of the maps
+      if (texelShift.x() != 0) {
+        const int firstColumn = (texelShift.x() > 0 ? level.texelOrigin.x() + clipmapLevelSize : texelOrigin.x());
+        updateClipmapRegion(level, firstColumn, texelOrigin.y(), static_cast<unsigned int>(std::abs(texelShift.x())), clipmapLevelSize);
+      }
+
+      if (texelShift.y() != 0) {
+        const int firstRow = (texelShift.y() > 0 ? level.texelOrigin.y() + clipmapLevelSize : texelOrigin.y());
+        updateClipmapRegion(level, texelOrigin.x(), firstRow, clipmapLevelSize, static_cast<unsigned int>(std::abs(texelShift.y())));
+      }
+    }
+
+    level.texelOrigin = texelOrigin;
+
+    // The patches are snapped to twice their size, so that the hole left for the previous level is always aligned with them
+    const float patchSize       = clipmapPatchTexelCount * level.texelSize;
+    const float patchSnapSize   = patchSize * 2.f;
+    const float patchGridOffset = patchSize * static_cast<float>(clipmapPatchCount / 2);
+    const Raz::Vec2f patchGridOrigin(std::floor(cameraPos.x() / patchSnapSize) * patchSnapSize - patchGridOffset,
+                                     std::floor(cameraPos.z() / patchSnapSize) * patchSnapSize - patchGridOffset);
+
+    if (patchGridOrigin != level.patchGridOrigin) {
+      level.patchGridOrigin = patchGridOrigin;
+      isGridShifted         = true;
+    }
+  }
+
+  // The timer is only started by the regions' updates, so that the frames in which no texel is computed are not measured
+  m_clipmapUpdateTimer.end();
+
+  if (isGridShifted)
+    generateClipmapPatches();
+}
+
+void DynamicTerrain::generateClipmapPatches() {
+  ZoneScopedN("DynamicTerrain::generateClipmapPatches");
+
+  auto& mesh = m_entity.getComponent<Raz::Mesh>();
+  mesh.getSubmeshes().resize(m_clipmapLevels.size());
+
+  constexpr unsigned int holePatchCount = clipmapPatchCount / 2;
+
+  for (std::size_t levelIndex = 0; levelIndex < m_clipmapLevels.size(); ++levelIndex) {
+    const ClipmapLevel& level = m_clipmapLevels[levelIndex];
+    const float patchSize     = clipmapPatchTexelCount * level.texelSize;
+    const float invMapSize    = 1.f / (static_cast<float>(clipmapLevelSize) * level.texelSize);
+
+    // Finding the patches covered by the previous, finer level, which are left out; the finest level has no hole
+    unsigned int holeStartX = clipmapPatchCount;
+    unsigned int holeStartZ = clipmapPatchCount;
+
+    if (levelIndex > 0) {
+      const Raz::Vec2f& innerGridOrigin = m_clipmapLevels[levelIndex - 1].patchGridOrigin;
+      holeStartX = static_cast<unsigned int>(std::lround((innerGridOrigin.x() - level.patchGridOrigin.x()) / patchSize));
+      holeStartZ = static_cast<unsigned int>(std::lround((innerGridOrigin.y() - level.patchGridOrigin.y()) / patchSize));
+    }
+
+    std::vector<Raz::Vertex>& vertices = mesh.getSubmeshes()[levelIndex].getVertices();
+    vertices.clear();
+    vertices.reserve(clipmapPatchCount * clipmapPatchCount * 4);
+
+    for (unsigned int patchX = 0; patchX < clipmapPatchCount; ++patchX) {
+      const bool isInHoleX    = (patchX >= holeStartX && patchX < holeStartX + holePatchCount);
+      const float patchStartX = level.patchGridOrigin.x() + patchSize * static_cast<float>(patchX);
+
+      for (unsigned int patchZ = 0; patchZ < clipmapPatchCount; ++patchZ) {
+        if (isInHoleX && patchZ >= holeStartZ && patchZ < holeStartZ + holePatchCount)
+          continue;
+
+        const float patchStartZ = level.patchGridOrigin.y() + patchSize * static_cast<float>(patchZ);
+
+        // Same layout as the fixed terrain's patches; the texcoords are unbounded, the maps being sampled toroidally
+        for (const Raz::Vec2f& cornerPos : { Raz::Vec2f(patchStartX, patchStartZ),
+                                             Raz::Vec2f(patchStartX, patchStartZ + patchSize),
+                                             Raz::Vec2f(patchStartX + patchSize, patchStartZ),
+                                             Raz::Vec2f(patchStartX + patchSize, patchStartZ + patchSize) }) {
+          vertices.emplace_back(Raz::Vertex{ Raz::Vec3f(cornerPos.x(), 0.f, cornerPos.y()),
+                                             cornerPos * invMapSize,
+                                             Raz::Axis::Y,
+                                             Raz::Axis::X });
+        }
+      }
+    }
+  }
+
+  auto& meshRenderer = m_entity.getComponent<Raz::MeshRenderer>();
+  meshRenderer.load(mesh, Raz::RenderMode::PATCH);
+
+  const auto computeLevelBounds = [] (const ClipmapLevel& level) {
+    const float levelSize = clipmapPatchTexelCount * level.texelSize * static_cast<float>(clipmapPatchCount);
+    return Raz::Vec4f(level.patchGridOrigin.x(), level.patchGridOrigin.y(), level.patchGridOrigin.x() + levelSize, level.patchGridOrigin.y() + levelSize);
+  };
+
+  for (std::size_t levelIndex = 0; levelIndex < m_clipmapLevels.size(); ++levelIndex) {
+    meshRenderer.getSubmeshRenderers()[levelIndex].setMaterialIndex(levelIndex + 1);
+
+    // The borders between levels, along which their edges are stitched, move with the patches
+    Raz::RenderShaderProgram& levelProgram = meshRenderer.getMaterials()[levelIndex + 1].getProgram();
+    levelProgram.setAttribute(computeLevelBounds(m_clipmapLevels[levelIndex]), "uniLevelBounds");
+
+    if (levelIndex > 0)
+      levelProgram.setAttribute(computeLevelBounds(m_clipmapLevels[levelIndex - 1]), "uniHoleBounds");
+
+    levelProgram.sendAttributes();
+  }
+}
+
+void DynamicTerrain::updateClipmapRegion(ClipmapLevel& level, int originX, int originZ, unsigned int width, unsigned int depth) {
+  ZoneScopedN("DynamicTerrain::updateClipmapRegion");
+  TracyGpuZone("DynamicTerrain::updateClipmapRegion")
+
+  m_clipmapUpdateTimer.begin();
+
+  const Raz::Vec2i texelOffset(originX, originZ);
+
+  level.noiseProgram.setAttribute(texelOffset, "uniTexelOffset");
+  level.noiseProgram.sendAttributes();
+  level.noiseProgram.execute(width, depth);
+
+  level.colorProgram.setAttribute(texelOffset, "uniTexelOffset");
+  level.colorProgram.sendAttributes();
+  level.colorProgram.execute(width, depth);
+
+  m_lastUpdatedTexelCount += static_cast<std::size_t>(width) * depth;
+}
+
+void DynamicTerrain::setupColorProgram(Raz::ComputeShaderProgram& colorProgram, const Raz::Texture2DPtr& heightmap,
+                                       const Raz::Texture2DPtr& colorMap, const Raz::Texture2DPtr& materialMap) const {
+  colorProgram.setShader(Raz::ComputeShader::loadFromSource(prependNoiseFunctions(colorCompSource)));
+  colorProgram.setImageTexture(heightmap, "uniHeightmap", Raz::ImageTextureUsage::READ);
+  colorProgram.setImageTexture(colorMap, "uniColorMap", Raz::ImageTextureUsage::WRITE);
+  colorProgram.setImageTexture(materialMap, "uniMaterialMap", Raz::ImageTextureUsage::WRITE);
+  colorProgram.setImageTexture(m_biomeTableTexture, "uniBiomeTable", Raz::ImageTextureUsage::READ);
+  colorProgram.setAttribute(Raz::Vec3i(static_cast<int>(BiomeTable::heightResolution),
+                                       static_cast<int>(BiomeTable::slopeResolution),
+                                       static_cast<int>(BiomeTable::moistureResolution)), "uniBiomeTableResolution");
+  colorProgram.setAttribute(BiomeTable::maxSlopeStrength, "uniMaxSlopeStrength");
+  sendBiomeAttributes(colorProgram);
+}
+
+void DynamicTerrain::sendBiomeAttributes(Raz::ComputeShaderProgram& colorProgram) const {
+  colorProgram.setAttribute(static_cast<int>(m_biomeTable.isMoistureUsed()), "uniUseMoisture");
+  colorProgram.setAttribute(m_biomeTable.getMoistureFactor(), "uniMoistureFactor");
+  colorProgram.sendAttributes();
+}
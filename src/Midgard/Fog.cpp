@@ -0,0 +1,141 @@
+#include "Midgard/Fog.hpp"
+
+#include <RaZ/Render/RenderGraph.hpp>
+#include <RaZ/Render/Renderer.hpp>
+#include <RaZ/Utils/Logger.hpp>
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <initializer_list>
+#include <string>
+
+namespace {
+
+constexpr std::string_view fogShaderSource = {
+#include "fog.frag.embed"
+};
+
+constexpr std::string_view fogScatteringShaderSource = {
+#include "fog_scattering.frag.embed"
+};
+
+constexpr std::string_view fogUpsampleShaderSource = {
+#include "fog_upsample.frag.embed"
+};
+
+constexpr unsigned int recoverResolutionDivisor(FogResolution resolution) noexcept {
+  return (resolution == FogResolution::QUARTER ? 4 : (resolution == FogResolution::HALF ? 2 : 1));
+}
+
+} // namespace
+
+Fog::Fog(Raz::RenderGraph& renderGraph, Raz::RenderPass& scenePass, const Raz::Texture2DPtr& depthBuffer, const Raz::Texture2DPtr& colorBuffer,
+         FogResolution resolution)
+  : m_fullResPass{ renderGraph.addNode(Raz::FragmentShader::loadFromSource(fogShaderSource), "Fog") },
+    m_scatteringPass{ renderGraph.addNode(Raz::FragmentShader::loadFromSource(fogScatteringShaderSource), "Fog scattering") },
+    m_upsamplePass{ renderGraph.addNode(Raz::FragmentShader::loadFromSource(fogUpsampleShaderSource), "Fog upsample") },
+    m_sceneWidth{ depthBuffer->getWidth() },
+    m_sceneHeight{ depthBuffer->getHeight() } {
+  ZoneScopedN("Fog::Fog");
+
+  // Reduced resolution: the fog is evaluated into its own buffers, which are then upsampled & blended with the scene
+
+  m_fogBuffer         = Raz::Texture2D::create(m_sceneWidth, m_sceneHeight, Raz::TextureColorspace::RGBA, Raz::TextureDataType::FLOAT16);
+  m_linearDepthBuffer = Raz::Texture2D::create(m_sceneWidth, m_sceneHeight, Raz::TextureColorspace::GRAY, Raz::TextureDataType::FLOAT32);
+
+#if !defined(USE_OPENGL_ES)
+  if (Raz::Renderer::checkVersion(4, 3)) {
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_fogBuffer->getIndex(), "Fog buffer");
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_linearDepthBuffer->getIndex(), "Fog linear depth buffer");
+  }
+#endif
+
+  m_scatteringPass.addWriteColorTexture(m_fogBuffer, 0);
+  m_scatteringPass.addWriteColorTexture(m_linearDepthBuffer, 1);
+
+  m_upsamplePass.addReadTexture(m_fogBuffer, "uniFogBuffers.fog");
+  m_upsamplePass.addReadTexture(m_linearDepthBuffer, "uniFogBuffers.linearDepth");
+
+  setSceneBuffers(depthBuffer, colorBuffer);
+
+  scenePass.addChildren(m_fullResPass, m_scatteringPass);
+  m_scatteringPass.addChildren(m_upsamplePass);
+
+  setResolution(resolution);
+}
+
+void Fog::setResolution(FogResolution resolution) {
+  ZoneScopedN("Fog::setResolution");
+
+  m_resolution = resolution;
+
+  // Only one of the two paths is executed; the other one's passes are disabled
+  const bool isFullRes = (m_resolution == FogResolution::FULL);
+  m_fullResPass.enable(isFullRes);
+  m_scatteringPass.enable(!isFullRes);
+  m_upsamplePass.enable(!isFullRes);
+
+  resizeBuffers(m_sceneWidth, m_sceneHeight);
+}
+
+void Fog::setSunDirection(const Raz::Vec3f& sunDirection) {
+  ZoneScopedN("Fog::setSunDirection");
+
+  for (Raz::RenderPass* pass : { &m_fullResPass, &m_scatteringPass }) {
+    pass->getProgram().setAttribute(sunDirection, "uniSunDir");
+    pass->getProgram().sendAttributes();
+  }
+}
+
+void Fog::setDensity(float density) {
+  ZoneScopedN("Fog::setDensity");
+
+  for (Raz::RenderPass* pass : { &m_fullResPass, &m_scatteringPass }) {
+    pass->getProgram().setAttribute(density, "uniFogDensity");
+    pass->getProgram().sendAttributes();
+  }
+}
+
+void Fog::setSceneBuffers(const Raz::Texture2DPtr& depthBuffer, const Raz::Texture2DPtr& colorBuffer) {
+  ZoneScopedN("Fog::setSceneBuffers");
+
+  if (m_sceneDepthBuffer != nullptr) {
+    for (Raz::RenderPass* pass : { &m_fullResPass, &m_scatteringPass, &m_upsamplePass })
+      pass->removeReadTexture(m_sceneDepthBuffer);
+
+    for (Raz::RenderPass* pass : { &m_fullResPass, &m_upsamplePass })
+      pass->removeReadTexture(m_sceneColorBuffer);
+  }
+
+  m_sceneDepthBuffer = depthBuffer;
+  m_sceneColorBuffer = colorBuffer;
+
+  // Full resolution: the fog is directly blended with the scene
+  m_fullResPass.addReadTexture(m_sceneDepthBuffer, "uniSceneBuffers.depth");
+  m_fullResPass.addReadTexture(m_sceneColorBuffer, "uniSceneBuffers.color");
+
+  // Reduced resolution: the fog is evaluated from the scene's depth, then upsampled & blended with its color
+  m_scatteringPass.addReadTexture(m_sceneDepthBuffer, "uniSceneBuffers.depth");
+  m_upsamplePass.addReadTexture(m_sceneDepthBuffer, "uniSceneBuffers.depth");
+  m_upsamplePass.addReadTexture(m_sceneColorBuffer, "uniSceneBuffers.color");
+}
+
+void Fog::resizeBuffers(unsigned int width, unsigned int height) {
+  ZoneScopedN("Fog::resizeBuffers");
+
+  m_sceneWidth  = width;
+  m_sceneHeight = height;
+
+  if (m_resolution == FogResolution::FULL)
+    return;
+
+  const unsigned int divisor = recoverResolutionDivisor(m_resolution);
+  const unsigned int fogWidth  = std::max(m_sceneWidth / divisor, 1u);
+  const unsigned int fogHeight = std::max(m_sceneHeight / divisor, 1u);
+
+  m_fogBuffer->resize(fogWidth, fogHeight);
+  m_linearDepthBuffer->resize(fogWidth, fogHeight);
+
+  Raz::Logger::debug("[Fog] Evaluating the fog at " + std::to_string(fogWidth) + 'x' + std::to_string(fogHeight) + '.');
+}
@@ -0,0 +1,83 @@
+#include "Midgard/GpuTimer.hpp"
+
+#include <GL/glew.h>
+
+#include <utility>
+
+GpuTimer::GpuTimer(GpuTimer&& timer) noexcept
+  : m_freeQueries{ std::exchange(timer.m_freeQueries, {}) },
+    m_pendingQueries{ std::exchange(timer.m_pendingQueries, {}) },
+    m_runningQueries{ std::exchange(timer.m_runningQueries, {}) },
+    m_isRunning{ std::exchange(timer.m_isRunning, false) },
+    m_history{ std::move(timer.m_history) } {}
+
+void GpuTimer::begin() {
+  if (m_isRunning)
+    return;
+
+  // Collecting the finished measurements first allows reusing their queries, even if nothing else collects them
+  collect();
+
+  if (m_freeQueries.empty()) {
+    QueryPair queries;
+    glGenQueries(1, &queries.beginQuery);
+    glGenQueries(1, &queries.endQuery);
+    m_freeQueries.emplace_back(queries);
+  }
+
+  m_runningQueries = m_freeQueries.back();
+  m_freeQueries.pop_back();
+  m_isRunning = true;
+
+  // Timestamps, unlike elapsed time queries, can overlap those of other timers
+  glQueryCounter(m_runningQueries.beginQuery, GL_TIMESTAMP);
+}
+
+void GpuTimer::end() {
+  if (!m_isRunning)
+    return;
+
+  glQueryCounter(m_runningQueries.endQuery, GL_TIMESTAMP);
+
+  m_pendingQueries.emplace_back(m_runningQueries);
+  m_isRunning = false;
+}
+
+void GpuTimer::collect() {
+  while (!m_pendingQueries.empty()) {
+    const QueryPair& queries = m_pendingQueries.front();
+
+    // The GPU executing commands in order, the beginning timestamp is available as soon as the ending one is
+    GLint isAvailable = GL_FALSE;
+    glGetQueryObjectiv(queries.endQuery, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+
+    if (isAvailable == GL_FALSE)
+      return;
+
+    GLuint64 beginTime {};
+    GLuint64 endTime {};
+    glGetQueryObjectui64v(queries.beginQuery, GL_QUERY_RESULT, &beginTime);
+    glGetQueryObjectui64v(queries.endQuery, GL_QUERY_RESULT, &endTime);
+
+    m_history.addSample(static_cast<float>(endTime - beginTime) / 1'000'000.f);
+
+    m_freeQueries.emplace_back(queries);
+    m_pendingQueries.pop_front();
+  }
+}
+
+GpuTimer::~GpuTimer() {
+  const auto deleteQueries = [] (const QueryPair& queries) {
+    glDeleteQueries(1, &queries.beginQuery);
+    glDeleteQueries(1, &queries.endQuery);
+  };
+
+  if (m_isRunning)
+    deleteQueries(m_runningQueries);
+
+  for (const QueryPair& queries : m_freeQueries)
+    deleteQueries(queries);
+
+  for (const QueryPair& queries : m_pendingQueries)
+    deleteQueries(queries);
+}
@@ -0,0 +1,633 @@
+#include "Midgard/HeadlessGenerator.hpp"
+#include "Midgard/HeightfieldSource.hpp"
+#include "Midgard/NoiseGraph.hpp"
+#include "Midgard/StaticTerrain.hpp"
+#include "Midgard/TerrainScatter.hpp"
+#include "Midgard/VolumetricTerrain.hpp"
+
+#include <RaZ/Entity.hpp>
+#include <RaZ/Data/ImageFormat.hpp>
+#include <RaZ/Math/PerlinNoise.hpp>
+#include <RaZ/Math/Shape.hpp>
+#include <RaZ/Utils/Logger.hpp>
+#include <RaZ/Utils/Threading.hpp>
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace {
+
+constexpr std::array<std::string_view, 6> availableMaps = { "height", "color", "normal", "slope", "ao", "sun" };
+constexpr std::array<std::string_view, 3> availableNoiseGraphs = { "perlin", "warped", "layered" };
+
+// Each benchmarked evaluation is run several times, only the fastest being kept to lessen the noise of the measures
+constexpr int benchmarkRunCount = 5;
+
+// Maximal errors for which the adaptive mesh is built when printing its triangle count versus error curve
+constexpr std::array<float, 9> meshErrorCurveSteps = { 0.f, 0.01f, 0.02f, 0.05f, 0.1f, 0.2f, 0.5f, 1.f, 2.f };
+
+// Horizontal sizes of the chunks the volumetric terrain is split into when benchmarking its meshing
+constexpr std::array<unsigned int, 4> volumetricChunkSizes = { 16, 32, 64, 128 };
+
+// Number of instances to place when benchmarking the scatter; their spacing is deduced from the terrain's area
+constexpr double scatterBenchmarkInstanceCount = 1'000'000.0;
+
+// Same sun as the one lighting the interactive scene
+const Raz::Vec3f sunDirection = Raz::Vec3f(0.f, -1.f, -1.f).normalize();
+
+std::string_view recoverValue(int argc, const char* const* argv, int& argIndex) {
+  if (argIndex + 1 >= argc)
+    throw std::invalid_argument("[HeadlessGenerator] Missing value for the argument '" + std::string(argv[argIndex]) + "'.");
+
+  return argv[++argIndex];
+}
+
+template <typename T>
+T parseNumber(std::string_view argName, std::string_view value) {
+  const std::string valueStr(value);
+
+  try {
+    std::size_t parsedCharCount {};
+    T number {};
+
+    if constexpr (std::is_floating_point_v<T>) {
+      number = static_cast<T>(std::stod(valueStr, &parsedCharCount));
+    } else {
+      if (valueStr.empty() || valueStr.front() == '-')
+        throw std::invalid_argument("");
+
+      number = static_cast<T>(std::stoull(valueStr, &parsedCharCount));
+    }
+
+    if (parsedCharCount != valueStr.size())
+      throw std::invalid_argument("");
+
+    return number;
+  } catch (const std::logic_error&) {
+    throw std::invalid_argument("[HeadlessGenerator] Invalid value '" + valueStr + "' for the argument '" + std::string(argName) + "'.");
+  }
+}
+
+std::vector<std::string> parseMaps(std::string_view value) {
+  std::vector<std::string> maps;
+
+  std::size_t mapStart = 0;
+
+  while (mapStart <= value.size()) {
+    const std::size_t mapEnd = std::min(value.find(',', mapStart), value.size());
+    const std::string_view map = value.substr(mapStart, mapEnd - mapStart);
+
+    if (std::find(availableMaps.cbegin(), availableMaps.cend(), map) == availableMaps.cend())
+      throw std::invalid_argument("[HeadlessGenerator] Unknown map '" + std::string(map) + "'.");
+
+    maps.emplace_back(map);
+    mapStart = mapEnd + 1;
+  }
+
+  return maps;
+}
+
+ResidencyPolicy parseResidencyPolicy(std::string_view value) {
+  if (value == "keep")
+    return ResidencyPolicy::KEEP_CPU_COPIES;
+
+  if (value == "heights")
+    return ResidencyPolicy::KEEP_HEIGHTS_ONLY;
+
+  if (value == "release")
+    return ResidencyPolicy::RELEASE_AFTER_UPLOAD;
+
+  throw std::invalid_argument("[HeadlessGenerator] Unknown residency policy '" + std::string(value) + "'.");
+}
+
+SlopeMapFormat parseSlopeMapFormat(std::string_view value) {
+  if (value == "float")
+    return SlopeMapFormat::RGB_FLOAT;
+
+  if (value == "rg8")
+    return SlopeMapFormat::RG8;
+
+  throw std::invalid_argument("[HeadlessGenerator] Unknown slope map format '" + std::string(value) + "'.");
+}
+
+/// Evaluates a function for each sample of a map, in parallel over its rows.
+template <typename SampleFuncT>
+void evaluatePass(unsigned int width, unsigned int depth, std::size_t taskCount, const SampleFuncT& sampleFunc) {
+  Raz::Threading::parallelize(0, depth, [width, &sampleFunc] (const Raz::Threading::IndexRange& range) noexcept {
+    for (std::size_t z = range.beginIndex; z < range.endIndex; ++z) {
+      for (std::size_t x = 0; x < width; ++x)
+        sampleFunc(z * width + x, static_cast<float>(x), static_cast<float>(z));
+    }
+  }, taskCount);
+}
+
+/// Runs an evaluation several times, printing the duration of the fastest run.
+template <typename EvaluationFuncT>
+void measureEvaluation(std::string_view evaluationName, const EvaluationFuncT& evaluationFunc) {
+  double bestDuration = std::numeric_limits<double>::max();
+
+  for (int runIndex = 0; runIndex < benchmarkRunCount; ++runIndex) {
+    const auto startTime = std::chrono::steady_clock::now();
+    evaluationFunc();
+    const std::chrono::duration<double, std::milli> runDuration = std::chrono::steady_clock::now() - startTime;
+
+    bestDuration = std::min(bestDuration, runDuration.count());
+  }
+
+  std::cout << "[Midgard] " << std::left << std::setw(24) << evaluationName << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << bestDuration << " ms" << std::endl;
+}
+
+float computeMaxDifference(const std::vector<float>& firstValues, const std::vector<float>& secondValues) {
+  float maxDifference = 0.f;
+
+  for (std::size_t valueIndex = 0; valueIndex < firstValues.size(); ++valueIndex)
+    maxDifference = std::max(maxDifference, std::abs(firstValues[valueIndex] - secondValues[valueIndex]));
+
+  return maxDifference;
+}
+
+/// Executes a stage, printing the time it took.
+void executeStage(std::string_view stageName, const std::function<void()>& stage) {
+  const auto startTime = std::chrono::steady_clock::now();
+  stage();
+  const std::chrono::duration<double, std::milli> stageDuration = std::chrono::steady_clock::now() - startTime;
+
+  std::cout << "[Midgard] " << std::left << std::setw(24) << stageName << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << stageDuration.count() << " ms" << std::endl;
+}
+
+} // namespace
+
+bool HeadlessGenerator::isRequested(int argc, const char* const* argv) noexcept {
+  for (int argIndex = 1; argIndex < argc; ++argIndex) {
+    if (std::string_view(argv[argIndex]) == "--headless")
+      return true;
+  }
+
+  return false;
+}
+
+HeadlessOptions HeadlessGenerator::parseArguments(int argc, const char* const* argv) {
+  HeadlessOptions options;
+
+  for (int argIndex = 1; argIndex < argc; ++argIndex) {
+    const std::string_view arg = argv[argIndex];
+
+    if (arg == "--headless")
+      continue;
+
+    if (arg == "--help") {
+      options.isUsageRequested = true;
+      continue;
+    }
+
+    if (arg == "--width")
+      options.width = parseNumber<unsigned int>(arg, recoverValue(argc, argv, argIndex));
+    else if (arg == "--depth")
+      options.depth = parseNumber<unsigned int>(arg, recoverValue(argc, argv, argIndex));
+    else if (arg == "--noise-factor")
+      options.noiseFactor = parseNumber<float>(arg, recoverValue(argc, argv, argIndex));
+    else if (arg == "--octaves")
+      options.octaveCount = static_cast<int>(parseNumber<unsigned int>(arg, recoverValue(argc, argv, argIndex)));
+    else if (arg == "--height-factor")
+      options.heightFactor = parseNumber<float>(arg, recoverValue(argc, argv, argIndex));
+    else if (arg == "--flatness")
+      options.flatness = parseNumber<float>(arg, recoverValue(argc, argv, argIndex));
+    else if (arg == "--noise-graph")
+      options.noiseGraph = recoverValue(argc, argv, argIndex);
+    else if (arg == "--benchmark-noise")
+      options.isNoiseBenchmarkRequested = true;
+    else if (arg == "--max-mesh-error") {
+      options.meshingMode  = MeshingMode::ADAPTIVE;
+      options.maxMeshError = parseNumber<float>(arg, recoverValue(argc, argv, argIndex));
+    } else if (arg == "--mesh-error-curve")
+      options.isMeshErrorCurveRequested = true;
+    else if (arg == "--benchmark-volumetric")
+      options.isVolumetricBenchmarkRequested = true;
+    else if (arg == "--benchmark-scatter")
+      options.isScatterBenchmarkRequested = true;
+    else if (arg == "--maps")
+      options.maps = parseMaps(recoverValue(argc, argv, argIndex));
+    else if (arg == "--output")
+      options.outputDirectory = recoverValue(argc, argv, argIndex);
+    else if (arg == "--threads")
+      options.threadCount = parseNumber<std::size_t>(arg, recoverValue(argc, argv, argIndex));
+    else if (arg == "--heightfield")
+      options.heightfieldPath = recoverValue(argc, argv, argIndex);
+    else if (arg == "--residency")
+      options.residencyPolicy = parseResidencyPolicy(recoverValue(argc, argv, argIndex));
+    else if (arg == "--slope-format")
+      options.slopeMapFormat = parseSlopeMapFormat(recoverValue(argc, argv, argIndex));
+    else
+      throw std::invalid_argument("[HeadlessGenerator] Unknown argument '" + std::string(arg) + "'.");
+  }
+
+  if (options.width < 3 || options.depth < 3)
+    throw std::invalid_argument("[HeadlessGenerator] The terrain's width & depth must be at least 3.");
+
+  if (std::find(availableNoiseGraphs.cbegin(), availableNoiseGraphs.cend(), options.noiseGraph) == availableNoiseGraphs.cend())
+    throw std::invalid_argument("[HeadlessGenerator] Unknown noise graph '" + options.noiseGraph + "'.");
+
+  return options;
+}
+
+void HeadlessGenerator::printUsage() {
+  std::cout << "Usage: Midgard --headless [options]\n"
+               "  --width <texels>          Width of the terrain (default: 512)\n"
+               "  --depth <texels>          Depth of the terrain (default: 512)\n"
+               "  --noise-factor <factor>   Factor applied to the coordinates before computing the noise (default: 0.01)\n"
+               "  --octaves <count>         Number of octaves of the noise (default: 8)\n"
+               "  --height-factor <factor>  Maximal height of the terrain (default: 30)\n"
+               "  --flatness <flatness>     Flatness of the terrain (default: 3)\n"
+               "  --noise-graph <graph>     Noise to generate the terrain from, among perlin, warped & layered (default: perlin)\n"
+               "  --maps <map,...>          Maps to export, among height, color, normal, slope, ao & sun (default: height,color,normal,slope)\n"
+               "  --output <directory>      Directory to export the maps into, created if needed (default: .)\n"
+               "  --threads <count>         Number of parallel tasks; 0 to use all the system's threads (default: 0)\n"
+               "  --residency <policy>      Data kept in memory once the maps are exported, among keep, heights & release (default: keep)\n"
+               "  --slope-format <format>   Format of the slope map, among float (exported as HDR) & rg8 (exported as PNG) (default: float)\n"
+               "  --max-mesh-error <error>  Meshes the terrain adaptively, within this vertical error in world units (default: uniform grid)\n"
+               "  --benchmark-noise         Only compares chained noise calls with fused noise graphs over the terrain's area\n"
+               "  --mesh-error-curve        Only prints the adaptive mesh's triangle count & build time for increasing maximal errors\n"
+               "  --benchmark-volumetric    Only prints the volumetric terrain's meshing throughput in chunks/s for increasing chunk sizes\n"
+               "  --benchmark-scatter       Only prints the time taken to place about a million instances on the terrain & to cull them\n"
+               "  --help                    Prints this message\n"
+               "  --heightfield <file>      Raw 32-bit floating-point heightfield of the terrain's size to use instead of noise,\n"
+               "                            as exported with the height map; use a flatness of 1 to keep its heights unchanged\n";
+}
+
+bool HeadlessGenerator::run() const {
+  ZoneScopedN("HeadlessGenerator::run");
+
+  if (m_options.isUsageRequested) {
+    printUsage();
+    return true;
+  }
+
+  if (m_options.isNoiseBenchmarkRequested) {
+    benchmarkNoise();
+    return true;
+  }
+
+  if (m_options.isMeshErrorCurveRequested) {
+    benchmarkMeshing();
+    return true;
+  }
+
+  if (m_options.isVolumetricBenchmarkRequested) {
+    benchmarkVolumetric();
+    return true;
+  }
+
+  if (m_options.isScatterBenchmarkRequested) {
+    benchmarkScatter();
+    return true;
+  }
+
+  try {
+    const std::filesystem::path outputDir(m_options.outputDirectory);
+    std::filesystem::create_directories(outputDir);
+
+    const auto isMapRequested = [this] (std::string_view map) {
+      return (std::find(m_options.maps.cbegin(), m_options.maps.cend(), map) != m_options.maps.cend());
+    };
+
+    // The terrain is not renderable, so that no graphics context is ever needed
+    Raz::Entity terrainEntity(0);
+    StaticTerrain terrain(terrainEntity, false);
+    terrain.setNoiseParameters(m_options.noiseFactor, m_options.octaveCount);
+
+    if (m_options.noiseGraph == "warped")
+      terrain.setNoiseGraph(NoiseGraph::createWarpedPreset(m_options.octaveCount));
+    else if (m_options.noiseGraph == "layered")
+      terrain.setNoiseGraph(NoiseGraph::createLayeredPreset(m_options.octaveCount));
+
+    terrain.setSlopeMapFormat(m_options.slopeMapFormat);
+    terrain.setMeshingMode(m_options.meshingMode, m_options.maxMeshError);
+
+    if (m_options.threadCount != 0)
+      terrain.setTaskCount(m_options.threadCount);
+
+    const auto totalStartTime = std::chrono::steady_clock::now();
+
+    executeStage("Generation", [this, &terrain] () {
+      if (m_options.heightfieldPath.empty()) {
+        terrain.generate(m_options.width, m_options.depth, m_options.heightFactor, m_options.flatness);
+        return;
+      }
+
+      const MappedHeightfield heightfield(m_options.heightfieldPath, m_options.width, m_options.depth, HeightfieldFormat::FLOAT32);
+      terrain.generate(heightfield, 0, 0, m_options.width, m_options.depth, m_options.heightFactor, m_options.flatness);
+    });
+
+    std::cout << "[Midgard] " << std::left << std::setw(24) << "Triangles" << std::right << std::setw(10) << terrain.getTriangleCount() << std::endl;
+
+    if (isMapRequested("height")) {
+      executeStage("Height map", [&terrain, &outputDir] () {
+        // Exported as raw data, so that it can be used as an heightfield source without any loss of precision
+        const Raz::Image heightMap = terrain.computeHeightMap();
+        std::ofstream heightFile(outputDir / "heightMap.r32", std::ios::binary);
+        heightFile.write(static_cast<const char*>(heightMap.getDataPtr()),
+                         static_cast<std::streamsize>(sizeof(float) * heightMap.getWidth() * heightMap.getHeight()));
+
+        if (!heightFile)
+          throw std::runtime_error("[HeadlessGenerator] Failed to write the height map.");
+      });
+    }
+
+    // The slope map is computed first, the color map reading it
+    if (isMapRequested("slope")) {
+      executeStage("Slope map", [this, &terrain, &outputDir] () {
+        // HDR images can only hold floating-point data
+        const bool isCompressed = (m_options.slopeMapFormat == SlopeMapFormat::RG8);
+        Raz::ImageFormat::save((outputDir / (isCompressed ? "slopeMap.png" : "slopeMap.hdr")).string(), terrain.computeSlopeMap());
+      });
+    }
+
+    if (isMapRequested("color"))
+      executeStage("Color map", [&terrain, &outputDir] () { Raz::ImageFormat::save((outputDir / "colorMap.png").string(), terrain.computeColorMap()); });
+
+    if (isMapRequested("normal"))
+      executeStage("Normal map", [&terrain, &outputDir] () { Raz::ImageFormat::save((outputDir / "normalMap.png").string(), terrain.computeNormalMap()); });
+
+    if (isMapRequested("ao") || isMapRequested("sun")) {
+      executeStage("Horizon bake", [&terrain] () { terrain.bakeHorizonMaps(sunDirection); });
+
+      if (isMapRequested("ao")) {
+        executeStage("Ambient occlusion map", [&terrain, &outputDir] () {
+          Raz::ImageFormat::save((outputDir / "ambientOcclusionMap.png").string(), terrain.getAmbientOcclusionMap());
+        });
+      }
+
+      if (isMapRequested("sun")) {
+        executeStage("Sun visibility map", [&terrain, &outputDir] () {
+          Raz::ImageFormat::save((outputDir / "sunVisibilityMap.png").string(), terrain.getSunVisibilityMap());
+        });
+      }
+    }
+
+    executeStage("Residency policy", [this, &terrain] () { terrain.setResidencyPolicy(m_options.residencyPolicy); });
+
+    const std::chrono::duration<double, std::milli> totalDuration = std::chrono::steady_clock::now() - totalStartTime;
+    std::cout << "[Midgard] " << std::left << std::setw(24) << "Total" << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << totalDuration.count() << " ms" << std::endl;
+
+    // Printing the memory still used by the terrain
+    constexpr double bytesToMebibytes = 1.0 / (1024.0 * 1024.0);
+    std::size_t totalCpuByteCount = 0;
+
+    for (const TerrainBufferMemory& bufferMemory : terrain.computeMemoryUsage()) {
+      std::cout << "[Midgard] " << std::left << std::setw(24) << bufferMemory.name << std::right << std::fixed << std::setprecision(2)
+                << std::setw(10) << static_cast<double>(bufferMemory.cpuByteCount) * bytesToMebibytes << " MiB" << std::endl;
+      totalCpuByteCount += bufferMemory.cpuByteCount;
+    }
+
+    std::cout << "[Midgard] " << std::left << std::setw(24) << "Total memory" << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << static_cast<double>(totalCpuByteCount) * bytesToMebibytes << " MiB" << std::endl;
+  } catch (const std::exception& exception) {
+    Raz::Logger::error(exception.what());
+    return false;
+  }
+
+  return true;
+}
+
+void HeadlessGenerator::benchmarkNoise() const {
+  ZoneScopedN("HeadlessGenerator::benchmarkNoise");
+
+  const unsigned int width = m_options.width;
+  const unsigned int depth = m_options.depth;
+  const float noiseFactor  = m_options.noiseFactor;
+  const int octaveCount    = m_options.octaveCount;
+  const std::size_t taskCount = (m_options.threadCount != 0 ? m_options.threadCount : Raz::Threading::getSystemThreadCount());
+
+  std::cout << "[Midgard] Evaluating noises over " << width << "x" << depth << " samples, with " << octaveCount << " octaves" << std::endl;
+
+  const std::size_t sampleCount = static_cast<std::size_t>(width) * depth;
+  std::vector<float> chainedValues(sampleCount);
+  std::vector<float> fusedValues(sampleCount);
+  std::vector<float> intermediateValues(sampleCount);
+
+  // Warp: the noise is evaluated at coordinates displaced by itself, twice. Each warp displaces both axes independently, by the noise
+  //  evaluated at the coordinates & at shifted ones, centered around 0
+
+  constexpr float shiftX = NoiseGraph::Warp<NoiseGraph::Perlin, NoiseGraph::Perlin>::decorrelationShiftX;
+  constexpr float shiftZ = NoiseGraph::Warp<NoiseGraph::Perlin, NoiseGraph::Perlin>::decorrelationShiftZ;
+  std::vector<float> shiftedValues(sampleCount);
+  std::vector<float> doublyShiftedValues(sampleCount);
+  std::vector<float> shiftedIntermediateValues(sampleCount);
+
+  measureEvaluation("Warp, 3 passes", [&] () {
+    evaluatePass(width, depth, taskCount, [&] (std::size_t index, float x, float z) noexcept {
+      const float noiseX = x * noiseFactor;
+      const float noiseZ = z * noiseFactor;
+      chainedValues[index]       = Raz::PerlinNoise::compute2D(noiseX, noiseZ, octaveCount, true);
+      shiftedValues[index]       = Raz::PerlinNoise::compute2D(noiseX + shiftX, noiseZ + shiftZ, octaveCount, true);
+      doublyShiftedValues[index] = Raz::PerlinNoise::compute2D(noiseX + 2.f * shiftX, noiseZ + 2.f * shiftZ, octaveCount, true);
+    });
+    evaluatePass(width, depth, taskCount, [&] (std::size_t index, float x, float z) noexcept {
+      const float noiseX = x * noiseFactor;
+      const float noiseZ = z * noiseFactor;
+      intermediateValues[index] = Raz::PerlinNoise::compute2D(noiseX + chainedValues[index] - 0.5f, noiseZ + shiftedValues[index] - 0.5f, octaveCount, true);
+      shiftedIntermediateValues[index] = Raz::PerlinNoise::compute2D(noiseX + shiftX + shiftedValues[index] - 0.5f,
+                                                                     noiseZ + shiftZ + doublyShiftedValues[index] - 0.5f, octaveCount, true);
+    });
+    evaluatePass(width, depth, taskCount, [&] (std::size_t index, float x, float z) noexcept {
+      chainedValues[index] = Raz::PerlinNoise::compute2D(x * noiseFactor + intermediateValues[index] - 0.5f,
+                                                         z * noiseFactor + shiftedIntermediateValues[index] - 0.5f, octaveCount, true);
+    });
+  });
+
+  measureEvaluation("Warp, chained calls", [&] () {
+    evaluatePass(width, depth, taskCount, [&] (std::size_t index, float x, float z) noexcept {
+      const auto computeWarpedNoise = [octaveCount] (float noiseX, float noiseZ) noexcept {
+        const float displacementX = Raz::PerlinNoise::compute2D(noiseX, noiseZ, octaveCount, true) - 0.5f;
+        const float displacementZ = Raz::PerlinNoise::compute2D(noiseX + shiftX, noiseZ + shiftZ, octaveCount, true) - 0.5f;
+        return Raz::PerlinNoise::compute2D(noiseX + displacementX, noiseZ + displacementZ, octaveCount, true);
+      };
+
+      const float noiseX = x * noiseFactor;
+      const float noiseZ = z * noiseFactor;
+      const float displacementX = computeWarpedNoise(noiseX, noiseZ) - 0.5f;
+      const float displacementZ = computeWarpedNoise(noiseX + shiftX, noiseZ + shiftZ) - 0.5f;
+      chainedValues[index] = Raz::PerlinNoise::compute2D(noiseX + displacementX, noiseZ + displacementZ, octaveCount, true);
+    });
+  });
+
+  const auto warpedGraph = NoiseGraph::createWarpedPreset(octaveCount);
+  measureEvaluation("Warp, fused graph", [&] () {
+    evaluatePass(width, depth, taskCount, [&] (std::size_t index, float x, float z) noexcept {
+      fusedValues[index] = warpedGraph.evaluate(x * noiseFactor, z * noiseFactor);
+    });
+  });
+
+  std::cout << "[Midgard] Warp, max difference:   " << std::setprecision(6) << computeMaxDifference(chainedValues, fusedValues) << std::endl;
+
+  // Layers: Perlin noise, ridges & billows are weighted & summed, then clamped
+
+  const NoiseGraph::Perlin perlin = NoiseGraph::perlin(1.f, octaveCount);
+  const NoiseGraph::Ridged ridged = NoiseGraph::ridged(0.5f, octaveCount);
+  const NoiseGraph::Billow billow = NoiseGraph::billow(4.f, octaveCount);
+
+  measureEvaluation("Layers, 4 passes", [&] () {
+    evaluatePass(width, depth, taskCount, [&] (std::size_t index, float x, float z) noexcept {
+      chainedValues[index] = perlin.evaluate(x * noiseFactor, z * noiseFactor) * 0.6f;
+    });
+    evaluatePass(width, depth, taskCount, [&] (std::size_t index, float x, float z) noexcept {
+      chainedValues[index] += ridged.evaluate(x * noiseFactor, z * noiseFactor) * 0.3f;
+    });
+    evaluatePass(width, depth, taskCount, [&] (std::size_t index, float x, float z) noexcept {
+      chainedValues[index] += billow.evaluate(x * noiseFactor, z * noiseFactor) * 0.1f;
+    });
+    evaluatePass(width, depth, taskCount, [&] (std::size_t index, float, float) noexcept {
+      chainedValues[index] = std::clamp(chainedValues[index], 0.f, 1.f);
+    });
+  });
+
+  const auto layeredGraph = NoiseGraph::createLayeredPreset(octaveCount);
+  measureEvaluation("Layers, fused graph", [&] () {
+    evaluatePass(width, depth, taskCount, [&] (std::size_t index, float x, float z) noexcept {
+      fusedValues[index] = layeredGraph.evaluate(x * noiseFactor, z * noiseFactor);
+    });
+  });
+
+  std::cout << "[Midgard] Layers, max difference: " << std::setprecision(6) << computeMaxDifference(chainedValues, fusedValues) << std::endl;
+}
+
+void HeadlessGenerator::benchmarkMeshing() const {
+  ZoneScopedN("HeadlessGenerator::benchmarkMeshing");
+
+  Raz::Entity terrainEntity(0);
+  StaticTerrain terrain(terrainEntity, false);
+  terrain.setNoiseParameters(m_options.noiseFactor, m_options.octaveCount);
+
+  if (m_options.noiseGraph == "warped")
+    terrain.setNoiseGraph(NoiseGraph::createWarpedPreset(m_options.octaveCount));
+  else if (m_options.noiseGraph == "layered")
+    terrain.setNoiseGraph(NoiseGraph::createLayeredPreset(m_options.octaveCount));
+
+  if (m_options.threadCount != 0)
+    terrain.setTaskCount(m_options.threadCount);
+
+  terrain.generate(m_options.width, m_options.depth, m_options.heightFactor, m_options.flatness);
+
+  const std::size_t gridTriangleCount = terrain.getTriangleCount();
+
+  std::cout << "[Midgard] Meshing " << m_options.width << "x" << m_options.depth << " heights, whose uniform grid has "
+            << gridTriangleCount << " triangles" << std::endl;
+  std::cout << "[Midgard] " << std::setw(10) << "Max error" << std::setw(12) << "Triangles" << std::setw(10) << "Ratio" << std::setw(13) << "Build time" << std::endl;
+
+  for (const float maxError : meshErrorCurveSteps) {
+    double bestDuration = std::numeric_limits<double>::max();
+
+    for (int runIndex = 0; runIndex < benchmarkRunCount; ++runIndex) {
+      const auto startTime = std::chrono::steady_clock::now();
+      terrain.setMeshingMode(MeshingMode::ADAPTIVE, maxError);
+      const std::chrono::duration<double, std::milli> runDuration = std::chrono::steady_clock::now() - startTime;
+
+      bestDuration = std::min(bestDuration, runDuration.count());
+    }
+
+    const double triangleRatio = static_cast<double>(terrain.getTriangleCount()) / static_cast<double>(gridTriangleCount) * 100.0;
+
+    std::cout << "[Midgard] " << std::fixed << std::setprecision(2) << std::setw(10) << maxError << std::setw(12) << terrain.getTriangleCount()
+              << std::setw(9) << triangleRatio << '%' << std::setw(10) << bestDuration << " ms" << std::endl;
+  }
+}
+
+void HeadlessGenerator::benchmarkVolumetric() const {
+  ZoneScopedN("HeadlessGenerator::benchmarkVolumetric");
+
+  // The density field is evaluated on the CPU, no graphics context being available
+  Raz::Entity terrainEntity(0);
+  VolumetricTerrain terrain(terrainEntity, false);
+
+  std::cout << "[Midgard] Meshing a " << m_options.width << "x" << m_options.depth << " volumetric terrain of height factor "
+            << m_options.heightFactor << ", with the density evaluated on the CPU" << std::endl;
+  std::cout << "[Midgard] " << std::setw(10) << "Chunk size" << std::setw(10) << "Chunks" << std::setw(13) << "Time" << std::setw(14) << "Chunks/s" << std::endl;
+
+  for (const unsigned int chunkSize : volumetricChunkSizes) {
+    terrain.setChunkSize(chunkSize);
+
+    double bestDuration = std::numeric_limits<double>::max();
+    float bestChunksPerSecond = 0.f;
+
+    for (int runIndex = 0; runIndex < benchmarkRunCount; ++runIndex) {
+      const auto startTime = std::chrono::steady_clock::now();
+      terrain.generate(m_options.width, m_options.depth, m_options.heightFactor, m_options.flatness);
+      const std::chrono::duration<double, std::milli> runDuration = std::chrono::steady_clock::now() - startTime;
+
+      bestDuration        = std::min(bestDuration, runDuration.count());
+      bestChunksPerSecond = std::max(bestChunksPerSecond, terrain.getLastChunksPerSecond());
+    }
+
+    const std::size_t chunkCount = static_cast<std::size_t>((m_options.width + chunkSize - 1) / chunkSize) * ((m_options.depth + chunkSize - 1) / chunkSize);
+
+    std::cout << "[Midgard] " << std::setw(10) << chunkSize << std::setw(10) << chunkCount << std::fixed << std::setprecision(2)
+              << std::setw(10) << bestDuration << " ms" << std::setw(14) << bestChunksPerSecond << std::endl;
+  }
+}
+
+void HeadlessGenerator::benchmarkScatter() const {
+  ZoneScopedN("HeadlessGenerator::benchmarkScatter");
+
+  Raz::Entity terrainEntity(0);
+  StaticTerrain terrain(terrainEntity, false);
+  terrain.setNoiseParameters(m_options.noiseFactor, m_options.octaveCount);
+
+  if (m_options.threadCount != 0)
+    terrain.setTaskCount(m_options.threadCount);
+
+  terrain.generate(m_options.width, m_options.depth, m_options.heightFactor, m_options.flatness);
+  terrain.computeSlopeMap();
+
+  // Every location being valid, one instance is placed per stratum of the jittered grid
+  ScatterRule rule;
+  rule.minHeight = std::numeric_limits<float>::lowest();
+  rule.maxHeight = std::numeric_limits<float>::max();
+  rule.maxSlope  = std::numeric_limits<float>::max();
+  rule.spacing   = static_cast<float>(std::sqrt(static_cast<double>(m_options.width - 1) * static_cast<double>(m_options.depth - 1)
+                                              / scatterBenchmarkInstanceCount));
+
+  // No graphics context being available, the scatter only places & culls its instances
+  TerrainScatter scatter;
+  scatter.addLayer(Raz::Mesh(Raz::AABB(Raz::Vec3f(-0.5f), Raz::Vec3f(0.5f))), rule);
+
+  double bestPlacementDuration = std::numeric_limits<double>::max();
+  double bestCullingDuration   = std::numeric_limits<double>::max();
+  const Raz::Vec3f centerPos   = terrain.computePosition(static_cast<float>(m_options.width) * 0.5f, static_cast<float>(m_options.depth) * 0.5f);
+
+  for (int runIndex = 0; runIndex < benchmarkRunCount; ++runIndex) {
+    const auto placementStartTime = std::chrono::steady_clock::now();
+    scatter.place(terrain);
+    const std::chrono::duration<double, std::milli> placementDuration = std::chrono::steady_clock::now() - placementStartTime;
+
+    // The placement forcing the visible instances to be gathered again, this measures both the culling & the gathering
+    const auto cullingStartTime = std::chrono::steady_clock::now();
+    scatter.update(centerPos);
+    const std::chrono::duration<double, std::milli> cullingDuration = std::chrono::steady_clock::now() - cullingStartTime;
+
+    bestPlacementDuration = std::min(bestPlacementDuration, placementDuration.count());
+    bestCullingDuration   = std::min(bestCullingDuration, cullingDuration.count());
+  }
+
+  std::cout << "[Midgard] Scattering instances over a " << m_options.width << "x" << m_options.depth << " terrain, with a spacing of "
+            << std::fixed << std::setprecision(2) << rule.spacing << " texels" << std::endl;
+  std::cout << "[Midgard] Placed " << scatter.getInstanceCount() << " instances in " << bestPlacementDuration << " ms ("
+            << static_cast<double>(scatter.getInstanceCount()) / bestPlacementDuration / 1000.0 << " M instances/s)" << std::endl;
+  std::cout << "[Midgard] Culled around the center, keeping " << scatter.getVisibleInstanceCount() << " visible instances, in "
+            << bestCullingDuration << " ms" << std::endl;
+}
@@ -0,0 +1,267 @@
+#include "Midgard/HeightfieldSource.hpp"
+
+#include <RaZ/Utils/Logger.hpp>
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(MIDGARD_PLATFORM_WINDOWS)
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN
+#endif
+#if !defined(NOMINMAX)
+#define NOMINMAX // Prevents Windows.h from defining min() & max() macros, which would break std::min() & std::max()
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// When the file is stored row by row, the rows are prefetched by bands of this size
+constexpr unsigned int rowBandSize = 256;
+
+inline float recoverRawHeight(const std::byte* heightPtr, HeightfieldFormat format) noexcept {
+  if (format == HeightfieldFormat::UINT16) {
+    uint16_t height {};
+    std::memcpy(&height, heightPtr, sizeof(height));
+    return static_cast<float>(height);
+  }
+
+  float height {};
+  std::memcpy(&height, heightPtr, sizeof(height));
+  return height;
+}
+
+} // namespace
+
+MappedHeightfield::MappedHeightfield(const std::string& filePath, unsigned int width, unsigned int depth, HeightfieldFormat format, unsigned int tileSize)
+  : HeightfieldSource(width, depth), m_format{ format }, m_heightSize{ (format == HeightfieldFormat::UINT16 ? sizeof(uint16_t) : sizeof(float)) },
+    m_tileSize{ tileSize } {
+  ZoneScopedN("MappedHeightfield::MappedHeightfield");
+
+  if (m_width == 0 || m_depth == 0)
+    throw std::invalid_argument("[MappedHeightfield] The heightfield's dimensions can't be 0.");
+
+  std::size_t expectedSize = static_cast<std::size_t>(m_width) * m_depth * m_heightSize;
+
+  if (m_tileSize != 0) {
+    // Border tiles are expected to be padded to the full tile size
+    m_tileCountX = (m_width + m_tileSize - 1) / m_tileSize;
+    const unsigned int tileCountZ = (m_depth + m_tileSize - 1) / m_tileSize;
+    expectedSize = static_cast<std::size_t>(m_tileCountX) * tileCountZ * m_tileSize * m_tileSize * m_heightSize;
+  }
+
+  setHeightRange(0.f, (m_format == HeightfieldFormat::UINT16 ? 65535.f : 1.f));
+
+#if defined(MIDGARD_PLATFORM_WINDOWS)
+  m_fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+  if (m_fileHandle == INVALID_HANDLE_VALUE)
+    throw std::invalid_argument("[MappedHeightfield] Failed to open the file '" + filePath + "'.");
+
+  LARGE_INTEGER fileSize {};
+  if (!GetFileSizeEx(m_fileHandle, &fileSize)) {
+    CloseHandle(m_fileHandle);
+    throw std::runtime_error("[MappedHeightfield] Failed to get the size of the file '" + filePath + "'.");
+  }
+
+  m_dataSize = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+  m_fileDescriptor = open(filePath.c_str(), O_RDONLY);
+  if (m_fileDescriptor == -1)
+    throw std::invalid_argument("[MappedHeightfield] Failed to open the file '" + filePath + "'.");
+
+  struct stat fileStats {};
+  if (fstat(m_fileDescriptor, &fileStats) == -1) {
+    close(m_fileDescriptor);
+    throw std::runtime_error("[MappedHeightfield] Failed to get the size of the file '" + filePath + "'.");
+  }
+
+  m_dataSize = static_cast<std::size_t>(fileStats.st_size);
+#endif
+
+  if (m_dataSize < expectedSize) {
+    const std::string errorMsg = "[MappedHeightfield] The file '" + filePath + "' is too small (" + std::to_string(m_dataSize)
+                               + " bytes) for the given dimensions & format (" + std::to_string(expectedSize) + " bytes).";
+#if defined(MIDGARD_PLATFORM_WINDOWS)
+    CloseHandle(m_fileHandle);
+#else
+    close(m_fileDescriptor);
+#endif
+    throw std::invalid_argument(errorMsg);
+  }
+
+  m_dataSize = expectedSize;
+
+#if defined(MIDGARD_PLATFORM_WINDOWS)
+  SYSTEM_INFO systemInfo {};
+  GetSystemInfo(&systemInfo);
+  m_pageSize = systemInfo.dwPageSize;
+
+  m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (m_mappingHandle != nullptr)
+    m_data = static_cast<const std::byte*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, m_dataSize));
+
+  if (m_data == nullptr) {
+    if (m_mappingHandle != nullptr)
+      CloseHandle(m_mappingHandle);
+    CloseHandle(m_fileHandle);
+    throw std::runtime_error("[MappedHeightfield] Failed to map the file '" + filePath + "'.");
+  }
+#else
+  m_pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+  void* mappedData = mmap(nullptr, m_dataSize, PROT_READ, MAP_SHARED, m_fileDescriptor, 0);
+  if (mappedData == MAP_FAILED) {
+    close(m_fileDescriptor);
+    throw std::runtime_error("[MappedHeightfield] Failed to map the file '" + filePath + "'.");
+  }
+
+  m_data = static_cast<const std::byte*>(mappedData);
+
+  // Accesses are made region by region, which the kernel can't guess; its own read-ahead would only load unneeded pages
+  madvise(mappedData, m_dataSize, MADV_RANDOM);
+#endif
+
+  Raz::Logger::debug("[MappedHeightfield] Mapped '" + filePath + "' (" + std::to_string(m_width) + 'x' + std::to_string(m_depth) + ").");
+}
+
+void MappedHeightfield::setHeightRange(float minHeight, float maxHeight) {
+  if (maxHeight <= minHeight) {
+    Raz::Logger::warn("[MappedHeightfield] The maximum height must be greater than the minimum one; ignoring the range.");
+    return;
+  }
+
+  m_minHeight      = minHeight;
+  m_invHeightRange = 1.f / (maxHeight - minHeight);
+}
+
+void MappedHeightfield::readRegion(unsigned int originX, unsigned int originZ, unsigned int width, unsigned int depth, float* heights) const {
+  ZoneScopedN("MappedHeightfield::readRegion");
+
+  if (originX + width > m_width || originZ + depth > m_depth)
+    throw std::out_of_range("[MappedHeightfield] The region to be read exceeds the heightfield's dimensions.");
+
+  // Loading the region's pages & the following ones at once, instead of faulting them one by one on access
+  const unsigned int readAheadDepth = m_readAheadTileCount * (m_tileSize != 0 ? m_tileSize : rowBandSize);
+  adviseRegion(originX, originZ, width, std::min(depth + readAheadDepth, m_depth - originZ), PageAdvice::PREFETCH);
+
+  const unsigned int endX = originX + width;
+
+  for (unsigned int z = 0; z < depth; ++z) {
+    float* rowHeights = heights + static_cast<std::size_t>(z) * width;
+
+    // Reading the row by contiguous spans; when tiled, a span stops at the tile's border
+    unsigned int x = originX;
+
+    while (x < endX) {
+      const unsigned int spanEndX = (m_tileSize != 0 ? std::min(endX, (x / m_tileSize + 1) * m_tileSize) : endX);
+      const std::byte* spanData   = m_data + computeByteOffset(x, originZ + z);
+
+      for (unsigned int spanIndex = 0; spanIndex < spanEndX - x; ++spanIndex) {
+        const float rawHeight = recoverRawHeight(spanData + spanIndex * m_heightSize, m_format);
+        rowHeights[x - originX + spanIndex] = std::clamp((rawHeight - m_minHeight) * m_invHeightRange, 0.f, 1.f);
+      }
+
+      x = spanEndX;
+    }
+  }
+}
+
+void MappedHeightfield::prefetchRegion(unsigned int originX, unsigned int originZ, unsigned int width, unsigned int depth) const {
+  ZoneScopedN("MappedHeightfield::prefetchRegion");
+  adviseRegion(originX, originZ, width, depth, PageAdvice::PREFETCH);
+}
+
+void MappedHeightfield::releaseRegion(unsigned int originX, unsigned int originZ, unsigned int width, unsigned int depth) const {
+  ZoneScopedN("MappedHeightfield::releaseRegion");
+  adviseRegion(originX, originZ, width, depth, PageAdvice::RELEASE);
+}
+
+MappedHeightfield::~MappedHeightfield() {
+#if defined(MIDGARD_PLATFORM_WINDOWS)
+  UnmapViewOfFile(m_data);
+  CloseHandle(m_mappingHandle);
+  CloseHandle(m_fileHandle);
+#else
+  munmap(const_cast<std::byte*>(m_data), m_dataSize);
+  close(m_fileDescriptor);
+#endif
+}
+
+void MappedHeightfield::adviseRegion(unsigned int originX, unsigned int originZ, unsigned int width, unsigned int depth, PageAdvice advice) const {
+  if (width == 0 || depth == 0)
+    return;
+
+  const unsigned int endX = std::min(originX + width, m_width);
+  const unsigned int endZ = std::min(originZ + depth, m_depth);
+
+  if (m_tileSize == 0) {
+    const std::size_t rowByteCount = static_cast<std::size_t>(endX - originX) * m_heightSize;
+
+    // If the region covers whole rows, it is contiguous & can be advised at once
+    if (originX == 0 && endX == m_width) {
+      adviseBytes(computeByteOffset(0, originZ), rowByteCount * (endZ - originZ), advice);
+      return;
+    }
+
+    // Otherwise, only the region's span in each row is advised, so that the memory used depends on the region's width & not on the file's
+    for (unsigned int z = originZ; z < endZ; ++z)
+      adviseBytes(computeByteOffset(originX, z), rowByteCount, advice);
+
+    return;
+  }
+
+  // Each tile being contiguous, accesses are aligned on whole tiles
+  const std::size_t tileByteCount = static_cast<std::size_t>(m_tileSize) * m_tileSize * m_heightSize;
+
+  for (unsigned int tileZ = originZ / m_tileSize; tileZ <= (endZ - 1) / m_tileSize; ++tileZ) {
+    const unsigned int firstTileX = originX / m_tileSize;
+    const unsigned int lastTileX  = (endX - 1) / m_tileSize;
+
+    // Tiles on the same row are stored one after the other
+    adviseBytes((static_cast<std::size_t>(tileZ) * m_tileCountX + firstTileX) * tileByteCount, (lastTileX - firstTileX + 1) * tileByteCount, advice);
+  }
+}
+
+void MappedHeightfield::adviseBytes(std::size_t byteOffset, std::size_t byteCount, PageAdvice advice) const {
+  // Advices can only be given on whole pages
+  const std::size_t beginOffset = byteOffset - byteOffset % m_pageSize;
+  const std::size_t endOffset   = std::min(((byteOffset + byteCount + m_pageSize - 1) / m_pageSize) * m_pageSize, m_dataSize);
+
+  if (endOffset <= beginOffset)
+    return;
+
+  auto* pagesPtr = const_cast<std::byte*>(m_data + beginOffset);
+  const std::size_t pagesSize = endOffset - beginOffset;
+
+#if defined(MIDGARD_PLATFORM_WINDOWS)
+  if (advice == PageAdvice::PREFETCH) {
+    WIN32_MEMORY_RANGE_ENTRY memoryRange { pagesPtr, pagesSize };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &memoryRange, 0);
+  } else {
+    // Unlocking pages which are not locked removes them from the working set; the call is thus expected to "fail"
+    VirtualUnlock(pagesPtr, pagesSize);
+  }
+#else
+  // The mapping being read-only, the released pages are simply reloaded from the file if accessed again
+  madvise(pagesPtr, pagesSize, (advice == PageAdvice::PREFETCH ? MADV_WILLNEED : MADV_DONTNEED));
+#endif
+}
+
+std::size_t MappedHeightfield::computeByteOffset(unsigned int x, unsigned int z) const noexcept {
+  if (m_tileSize == 0)
+    return (static_cast<std::size_t>(z) * m_width + x) * m_heightSize;
+
+  const std::size_t tileIndex   = static_cast<std::size_t>(z / m_tileSize) * m_tileCountX + x / m_tileSize;
+  const std::size_t tileTexelId = static_cast<std::size_t>(z % m_tileSize) * m_tileSize + x % m_tileSize;
+
+  return (tileIndex * m_tileSize * m_tileSize + tileTexelId) * m_heightSize;
+}
@@ -0,0 +1,181 @@
+#include "Midgard/PerformanceHud.hpp"
+
+#include <RaZ/Render/Overlay.hpp>
+
+#include <tracy/Tracy.hpp>
+#if !defined(USE_OPENGL_ES)
+#include <GL/glew.h>
+#endif
+
+#include <array>
+#include <cstdio>
+#include <utility>
+
+namespace {
+
+// Number of frames between two refreshes of the labels, so that their values can be read
+constexpr unsigned int refreshInterval = 10;
+
+std::string formatTimings(const std::string& name, const TimingHistory& timings) {
+  if (timings.getSampleCount() == 0)
+    return name + ": not measured yet";
+
+  std::array<char, 128> text {};
+  std::snprintf(text.data(), text.size(), ": avg %.3f / p50 %.3f / p95 %.3f / p99 %.3f / last %.3f ms (%zu)",
+                static_cast<double>(timings.computeAverage()),
+                static_cast<double>(timings.computePercentile(50.f)),
+                static_cast<double>(timings.computePercentile(95.f)),
+                static_cast<double>(timings.computePercentile(99.f)),
+                static_cast<double>(timings.getLastSample()),
+                timings.getSampleCount());
+
+  return name + text.data();
+}
+
+std::string formatByteCount(std::size_t byteCount) {
+  std::array<char, 32> text {};
+  std::snprintf(text.data(), text.size(), "%.1f MiB", static_cast<double>(byteCount) / (1024.0 * 1024.0));
+  return text.data();
+}
+
+} // namespace
+
+PerformanceHud::PerformanceHud(Raz::OverlayWindow& overlay)
+  : m_overlay{ overlay },
+    m_frameLabel{ overlay.addLabel("") }
+#if !defined(USE_OPENGL_ES)
+  , m_gpuFrameLabel{ overlay.addLabel("") },
+    m_primitiveLabel{ overlay.addLabel("") }
+#endif
+{}
+
+void PerformanceHud::addCpuStage(std::string name, const TimingHistory& timings) {
+  Raz::OverlayLabel& label = m_overlay.addLabel("");
+  m_stages.emplace_back(Stage{ std::move(name) + " (CPU)", &timings, &label });
+}
+
+#if !defined(USE_OPENGL_ES)
+void PerformanceHud::addGpuStage(std::string name, GpuTimer& timer) {
+  Raz::OverlayLabel& label = m_overlay.addLabel("");
+  m_stages.emplace_back(Stage{ std::move(name) + " (GPU)", &timer.getHistory(), &label });
+  m_gpuTimers.emplace_back(&timer);
+}
+#endif
+
+void PerformanceHud::addCounter(std::string name, std::function<std::size_t()> counter) {
+  Raz::OverlayLabel& label = m_overlay.addLabel("");
+  m_counters.emplace_back(Counter{ std::move(name), std::move(counter), &label });
+}
+
+void PerformanceHud::addMemoryUsage(std::string name, std::function<std::vector<TerrainBufferMemory>()> memoryUsageFunc) {
+  Raz::OverlayLabel& label = m_overlay.addLabel("");
+  m_memoryUsages.emplace_back(MemoryUsage{ std::move(name), std::move(memoryUsageFunc), &label });
+}
+
+void PerformanceHud::update(float frameTime) {
+  ZoneScopedN("PerformanceHud::update");
+
+  m_frameTimings.addSample(frameTime * 1000.f);
+
+#if !defined(USE_OPENGL_ES)
+  // The measurements span from one update to the next, thus covering everything the GPU is given during a frame, the rendering included,
+  //  but also the time it waits for the next commands; RaZ executing the render graph internally, the rendering can't be measured alone
+  m_gpuFrameTimer.end();
+
+  if (m_isCountingPrimitives) {
+    glEndQuery(GL_PRIMITIVES_GENERATED);
+    m_pendingPrimitiveQueries.emplace_back(m_runningPrimitiveQuery);
+    m_isCountingPrimitives = false;
+  }
+
+  // The results are only read once available, older queries being reused instead of waiting for the GPU
+  while (!m_pendingPrimitiveQueries.empty()) {
+    GLint isAvailable = GL_FALSE;
+    glGetQueryObjectiv(m_pendingPrimitiveQueries.front(), GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+
+    if (isAvailable == GL_FALSE)
+      break;
+
+    glGetQueryObjectui64v(m_pendingPrimitiveQueries.front(), GL_QUERY_RESULT, &m_primitiveCount);
+
+    m_freePrimitiveQueries.emplace_back(m_pendingPrimitiveQueries.front());
+    m_pendingPrimitiveQueries.pop_front();
+  }
+
+  m_gpuFrameTimer.collect();
+
+  for (GpuTimer* timer : m_gpuTimers)
+    timer->collect();
+
+  if (m_freePrimitiveQueries.empty()) {
+    m_freePrimitiveQueries.emplace_back();
+    glGenQueries(1, &m_freePrimitiveQueries.back());
+  }
+
+  m_runningPrimitiveQuery = m_freePrimitiveQueries.back();
+  m_freePrimitiveQueries.pop_back();
+
+  glBeginQuery(GL_PRIMITIVES_GENERATED, m_runningPrimitiveQuery);
+  m_isCountingPrimitives = true;
+
+  m_gpuFrameTimer.begin();
+#endif
+
+  if (++m_frameCountSinceRefresh < refreshInterval)
+    return;
+
+  m_frameCountSinceRefresh = 0;
+  refreshLabels();
+}
+
+PerformanceHud::~PerformanceHud() {
+#if !defined(USE_OPENGL_ES)
+  if (m_isCountingPrimitives) {
+    glEndQuery(GL_PRIMITIVES_GENERATED);
+    m_freePrimitiveQueries.emplace_back(m_runningPrimitiveQuery);
+  }
+
+  for (const unsigned int query : m_freePrimitiveQueries)
+    glDeleteQueries(1, &query);
+
+  for (const unsigned int query : m_pendingPrimitiveQueries)
+    glDeleteQueries(1, &query);
+#endif
+}
+
+void PerformanceHud::refreshLabels() {
+  ZoneScopedN("PerformanceHud::refreshLabels");
+
+  m_frameLabel.setText(formatTimings("Frame", m_frameTimings));
+
+#if !defined(USE_OPENGL_ES)
+  m_gpuFrameLabel.setText(formatTimings("Frame interval (GPU timeline, idle included)", m_gpuFrameTimer.getHistory()));
+  m_primitiveLabel.setText("Primitives rendered: " + std::to_string(m_primitiveCount));
+#endif
+
+  for (const Stage& stage : m_stages)
+    stage.label->setText(formatTimings(stage.name, *stage.timings));
+
+  for (const Counter& counter : m_counters)
+    counter.label->setText(counter.name + ": " + std::to_string(counter.counter()));
+
+  for (const MemoryUsage& memoryUsage : m_memoryUsages) {
+    std::size_t totalCpuByteCount = 0;
+    std::size_t totalGpuByteCount = 0;
+    std::string bufferLines;
+
+    for (const TerrainBufferMemory& bufferMemory : memoryUsage.memoryUsageFunc()) {
+      // Buffers which have not been computed or have been released are left out
+      if (bufferMemory.cpuByteCount == 0 && bufferMemory.gpuByteCount == 0)
+        continue;
+
+      bufferLines += "\n  " + bufferMemory.name + ": " + formatByteCount(bufferMemory.cpuByteCount) + " CPU, "
+                                                        + formatByteCount(bufferMemory.gpuByteCount) + " GPU";
+      totalCpuByteCount += bufferMemory.cpuByteCount;
+      totalGpuByteCount += bufferMemory.gpuByteCount;
+    }
+
+    memoryUsage.label->setText(memoryUsage.name + " memory: " + formatByteCount(totalCpuByteCount) + " CPU, "
+                                                              + formatByteCount(totalGpuByteCount) + " GPU" + bufferLines);
+  }
+}
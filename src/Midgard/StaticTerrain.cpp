@@ -1,44 +1,340 @@
+#include "Midgard/HeightfieldSource.hpp"
+#include "Midgard/SlopeCompression.hpp"
 #include "Midgard/StaticTerrain.hpp"
 
 #include <RaZ/Entity.hpp>
 #include <RaZ/Data/Mesh.hpp>
+#include <RaZ/Math/Constants.hpp>
 #include <RaZ/Math/MathUtils.hpp>
 #include <RaZ/Math/PerlinNoise.hpp>
 #include <RaZ/Render/MeshRenderer.hpp>
+#include <RaZ/Utils/Logger.hpp>
 #include <RaZ/Utils/Threading.hpp>
 
 #include <tracy/Tracy.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
 namespace {
 
-constexpr Raz::Vec3b waterColor(0, 0, 255);
-constexpr Raz::Vec3b grassColor(62, 126, 0);
-constexpr Raz::Vec3b groundColor(157, 110, 94);
-constexpr Raz::Vec3b rockColor(127, 127, 127);
-constexpr Raz::Vec3b snowColor(255, 255, 255);
+constexpr std::string_view terrainShaderSource = {
+#include "terrain_static.frag.embed"
+};
+
+// Number of rows read at once from an heightfield source; each band is released as soon as it has been converted to vertices
+constexpr unsigned int sourceBandSize = 64;
+
+// World distance between two neighboring texels, as the vertices' coordinates are scaled by half when generating the terrain
+constexpr float texelSize = 0.5f;
+
+// Directions in which horizons are searched for, ordered by angle; the 8 & 4 directions subsets are taken by skipping entries
+constexpr std::array<std::array<int, 2>, 16> horizonDirections = {{
+  {  1,  0 }, {  2,  1 }, {  1,  1 }, {  1,  2 }, {  0,  1 }, { -1,  2 }, { -1,  1 }, { -2,  1 },
+  { -1,  0 }, { -2, -1 }, { -1, -1 }, { -1, -2 }, {  0, -1 }, {  1, -2 }, {  1, -1 }, {  2, -1 }
+}};
+
+// Steps along a direction at which heights are sampled; the farther from the texel, the less a precise horizon matters
+constexpr std::array<int, 12> horizonSteps = { 1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64 };
+
+// Farthest distance in texels at which a height can affect an horizon, directions moving by up to 2 texels per step
+constexpr unsigned int horizonReach = 64 * 2;
+
+// Half the range of tangents over which the sun goes from visible to occluded, softening the shadows' borders
+constexpr float sunPenumbraTangent = 0.05f;
+
+// Horizons are stored as the sine of their elevation, quantized over the whole range of 16 bits
+constexpr float horizonSineScale = std::numeric_limits<uint16_t>::max();
+
+// Recovers an horizon's tangent from its quantized sine; those too steep for their cosine to be represented are clamped to a finite tangent
+float decodeHorizonTangent(uint16_t quantizedSine) noexcept {
+  const float sine = static_cast<float>(quantizedSine) / horizonSineScale;
+  return sine / std::sqrt(std::max(1.f - sine * sine, std::numeric_limits<float>::min()));
+}
+
+// Number of grid cells per side of the adaptive mesh's tiles; must be a power of two
+constexpr int meshTileSize = 128;
+constexpr int meshTileGridSize = meshTileSize + 1;
+
+// Computes the ends of the hypotenuse of every triangle of a tile's right-triangulated irregular network, except the finest ones.
+// Each triangle being split at its hypotenuse's midpoint into two children listed after it, the triangles are ordered from the coarsest
+//  to the finest, & the children of the triangle at index i are at 2i + 2 & 2i + 3
+std::vector<uint16_t> computeTileTriangleCoords() {
+  constexpr std::size_t triangleCount = meshTileSize * meshTileSize * 2 - 2;
+  std::vector<uint16_t> triangleCoords(triangleCount * 4);
+
+  for (std::size_t triangleIndex = 0; triangleIndex < triangleCount; ++triangleIndex) {
+    // Walking down from one of the two root triangles, following the bits of the triangle's identifier
+    std::size_t triangleId = triangleIndex + 2;
+    int ax = 0, az = 0, bx = 0, bz = 0, cx = 0, cz = 0;
+
+    if (triangleId & 1) {
+      bx = bz = cx = meshTileSize;
+    } else {
+      ax = az = cz = meshTileSize;
+    }
+
+    while ((triangleId >>= 1) > 1) {
+      const int mx = (ax + bx) / 2;
+      const int mz = (az + bz) / 2;
+
+      if (triangleId & 1) {
+        bx = ax;
+        bz = az;
+        ax = cx;
+        az = cz;
+      } else {
+        ax = bx;
+        az = bz;
+        bx = cx;
+        bz = cz;
+      }
+
+      cx = mx;
+      cz = mz;
+    }
+
+    triangleCoords[triangleIndex * 4    ] = static_cast<uint16_t>(ax);
+    triangleCoords[triangleIndex * 4 + 1] = static_cast<uint16_t>(az);
+    triangleCoords[triangleIndex * 4 + 2] = static_cast<uint16_t>(bx);
+    triangleCoords[triangleIndex * 4 + 3] = static_cast<uint16_t>(bz);
+  }
+
+  return triangleCoords;
+}
+
+// Raises the error of each triangle's midpoint to those of its children's, so that a vertex is only ever needed along with its ancestors
+void propagateTileErrors(std::vector<float>& errors, const std::vector<uint16_t>& triangleCoords) noexcept {
+  constexpr std::size_t parentTriangleCount = meshTileSize * meshTileSize - 2;
+
+  for (std::size_t triangleIndex = parentTriangleCount; triangleIndex-- > 0;) {
+    const int ax = triangleCoords[triangleIndex * 4];
+    const int az = triangleCoords[triangleIndex * 4 + 1];
+    const int bx = triangleCoords[triangleIndex * 4 + 2];
+    const int bz = triangleCoords[triangleIndex * 4 + 3];
+    const int mx = (ax + bx) / 2;
+    const int mz = (az + bz) / 2;
+    const int cx = mx + mz - az;
+    const int cz = mz + ax - mx;
+
+    float& middleError = errors[static_cast<std::size_t>(mz * meshTileGridSize + mx)];
+    middleError = std::max({ middleError,
+                             errors[static_cast<std::size_t>((az + cz) / 2 * meshTileGridSize + (ax + cx) / 2)],
+                             errors[static_cast<std::size_t>((bz + cz) / 2 * meshTileGridSize + (bx + cx) / 2)] });
+  }
+}
+
+// Makes the errors of the vertices shared by neighboring tiles identical, so that both split their borders alike
+bool synchronizeTileBorders(std::vector<std::vector<float>>& tileErrors, std::size_t tileCountX, std::size_t tileCountZ) noexcept {
+  bool hasChanged = false;
+
+  const auto synchronizeVertex = [&hasChanged] (float& firstError, float& secondError) noexcept {
+    if (firstError == secondError)
+      return;
+
+    firstError  = std::max(firstError, secondError);
+    secondError = firstError;
+    hasChanged  = true;
+  };
+
+  for (std::size_t tileZ = 0; tileZ < tileCountZ; ++tileZ) {
+    for (std::size_t tileX = 0; tileX < tileCountX; ++tileX) {
+      std::vector<float>& errors = tileErrors[tileZ * tileCountX + tileX];
+
+      if (tileX + 1 < tileCountX) {
+        std::vector<float>& rightErrors = tileErrors[tileZ * tileCountX + tileX + 1];
+
+        for (std::size_t z = 0; z < meshTileGridSize; ++z)
+          synchronizeVertex(errors[z * meshTileGridSize + meshTileSize], rightErrors[z * meshTileGridSize]);
+      }
+
+      if (tileZ + 1 < tileCountZ) {
+        std::vector<float>& bottomErrors = tileErrors[(tileZ + 1) * tileCountX + tileX];
+
+        for (std::size_t x = 0; x < meshTileGridSize; ++x)
+          synchronizeVertex(errors[meshTileSize * meshTileGridSize + x], bottomErrors[x]);
+      }
+    }
+  }
+
+  return hasChanged;
+}
 
 } // namespace
 
+/// Terrain built on worker threads, on its own entity & without rendering component, to be swapped with the rendered one.
+struct StaticTerrain::RegenerationJob {
+  Raz::Entity entity { 0 };
+  StaticTerrain terrain { entity, false };
+  PendingRegeneration request {};
+  std::atomic<bool> isCancelled = false;
+  std::future<void> result {};
+  std::vector<std::function<void()>> callbackResults {}; ///< Functions returned by the regeneration callbacks, to be called once swapped.
+
+  bool isFinished() const { return (result.wait_for(std::chrono::seconds(0)) == std::future_status::ready); }
+};
+
+// Defined here rather than in the header, the regeneration jobs' type being incomplete there
+StaticTerrain::StaticTerrain(Raz::Entity& entity, bool isRenderable) : Terrain(entity, isRenderable) {
+  if (!isRenderable)
+    return;
+
+  ZoneScopedN("StaticTerrain::StaticTerrain");
+
+  // The terrain is lit like the default material, with its horizon maps as additional factors; these are white until baked, leaving the lighting unchanged
+  Raz::Image whiteMap(1, 1, Raz::ImageColorspace::GRAY);
+  static_cast<uint8_t*>(whiteMap.getDataPtr())[0] = 255;
+
+  m_ambientOcclusionTexture = Raz::Texture2D::create(whiteMap, false);
+  m_sunVisibilityTexture    = Raz::Texture2D::create(whiteMap, false);
+
+  Raz::RenderShaderProgram& materialProgram = m_entity.getComponent<Raz::MeshRenderer>().getMaterials().front().getProgram();
+  materialProgram.setFragmentShader(Raz::FragmentShader::loadFromSource(std::string(terrainShaderSource)));
+  materialProgram.link();
+  materialProgram.setTexture(m_ambientOcclusionTexture, Raz::MaterialTexture::Ambient);
+  materialProgram.setTexture(m_sunVisibilityTexture, "uniSunVisibilityMap");
+}
+
 StaticTerrain::StaticTerrain(Raz::Entity& entity, unsigned int width, unsigned int depth, float heightFactor, float flatness) : StaticTerrain(entity) {
   ZoneScopedN("StaticTerrain::StaticTerrain");
 
   StaticTerrain::generate(width, depth, heightFactor, flatness);
 }
 
+StaticTerrain::StaticTerrain(StaticTerrain&&) noexcept = default;
+
 void StaticTerrain::setParameters(float heightFactor, float flatness) {
   ZoneScopedN("StaticTerrain::setParameters");
 
   checkParameters(heightFactor, flatness);
 
+  completeRegenerations();
+
+  rehydrateVertices();
   remapVertices(heightFactor, flatness);
 
   m_heightFactor = heightFactor;
   m_flatness     = flatness;
   m_invFlatness  = 1.f / flatness;
+
+  applyResidencyPolicy();
+}
+
+void StaticTerrain::setResidencyPolicy(ResidencyPolicy residencyPolicy) {
+  ZoneScopedN("StaticTerrain::setResidencyPolicy");
+
+  m_residencyPolicy = residencyPolicy;
+
+  if (m_residencyPolicy == ResidencyPolicy::KEEP_CPU_COPIES) {
+    // Recovering what may have been released by a previous policy
+    if (!m_heights.empty())
+      rehydrateVertices();
+
+    std::vector<float>().swap(m_heights);
+    return;
+  }
+
+  applyResidencyPolicy();
+}
+
+void StaticTerrain::setMeshingMode(MeshingMode meshingMode, float maxError) {
+  ZoneScopedN("StaticTerrain::setMeshingMode");
+
+  if (maxError < 0.f) {
+    Raz::Logger::warn("[StaticTerrain] The maximal mesh error can't be negative; remapping to 0.");
+    maxError = 0.f;
+  }
+
+  // Vertices beyond the terrain have an infinite error, which must always be greater
+  if (maxError > std::numeric_limits<float>::max()) {
+    Raz::Logger::warn("[StaticTerrain] The maximal mesh error can't be infinite; remapping to the highest finite value.");
+    maxError = std::numeric_limits<float>::max();
+  }
+
+  m_meshingMode  = meshingMode;
+  m_maxMeshError = maxError;
+
+  std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
+
+  // If the heights have been released, the triangles will be computed when generating the terrain again
+  if (m_width == 0 || (vertices.empty() && m_heights.empty()))
+    return;
+
+  rehydrateVertices();
+  computeIndices();
+  uploadMesh();
+  applyResidencyPolicy();
+}
+
+void StaticTerrain::setNoiseParameters(float noiseFactor, int octaveCount) {
+  if (noiseFactor <= 0.f) {
+    Raz::Logger::warn("[StaticTerrain] The noise factor can't be 0 or negative; remapping to +epsilon.");
+    noiseFactor = std::numeric_limits<float>::epsilon();
+  }
+
+  if (octaveCount <= 0) {
+    Raz::Logger::warn("[StaticTerrain] The octave count can't be 0 or negative; remapping to 1.");
+    octaveCount = 1;
+  }
+
+  m_noiseFactor = noiseFactor;
+  m_octaveCount = octaveCount;
+}
+
+void StaticTerrain::setTaskCount(std::size_t taskCount) {
+  if (taskCount == 0) {
+    Raz::Logger::warn("[StaticTerrain] The task count can't be 0; remapping to 1.");
+    taskCount = 1;
+  }
+
+  m_taskCount = taskCount;
+}
+
+void StaticTerrain::setHorizonDirectionCount(unsigned int directionCount) {
+  ZoneScopedN("StaticTerrain::setHorizonDirectionCount");
+
+  if (directionCount != 4 && directionCount != 8 && directionCount != 16) {
+    Raz::Logger::warn("[StaticTerrain] The horizon direction count must be either 4, 8 or 16; remapping to 8.");
+    directionCount = 8;
+  }
+
+  m_horizonDirectionCount = directionCount;
+
+  if (m_areHorizonMapsBaked)
+    bakeHorizonMaps(m_sunDirection);
+}
+
+void StaticTerrain::setSunDirection(const Raz::Vec3f& sunDirection) {
+  ZoneScopedN("StaticTerrain::setSunDirection");
+
+  m_sunDirection = sunDirection;
+
+  if (!m_areHorizonMapsBaked)
+    return;
+
+  // The horizons may have been released by the residency policy, in which case they must be baked again
+  if (m_horizonSines.empty()) {
+    bakeHorizonMaps(m_sunDirection);
+    return;
+  }
+
+  computeSunVisibility(0, 0, m_width, m_depth);
+  uploadHorizonMaps();
 }
 
 void StaticTerrain::generate(unsigned int width, unsigned int depth, float heightFactor, float flatness) {
   ZoneScopedN("StaticTerrain::generate");
+  const ScopedCpuTimer stageTimer(recoverStageTimings(StaticTerrainStage::GENERATION));
+
+  cancelRegenerations();
 
   m_width = width;
   m_depth = depth;
@@ -52,167 +348,520 @@ void StaticTerrain::generate(unsigned int width, unsigned int depth, float heigh
   std::vector<Raz::Vertex>& vertices = mesh.getSubmeshes().front().getVertices();
   vertices.resize(m_width * m_depth);
 
-  Raz::Threading::parallelize(0, vertices.size(), [this, &vertices] (const Raz::Threading::IndexRange& range) noexcept {
+  // The noise is evaluated row by row, so that a noise graph only pays a single indirection per row
+  Raz::Threading::parallelize(0, m_depth, [this, &vertices] (const Raz::Threading::IndexRange& range) noexcept {
     ZoneScopedN("StaticTerrain::generate");
 
-    for (std::size_t i = range.beginIndex; i < range.endIndex; ++i) {
-      const auto xCoord = static_cast<float>(i % m_width);
-      const auto yCoord = static_cast<float>(i / m_width);
+    std::vector<float> noiseValues(m_width);
 
-      // float noiseValue = Raz::PerlinNoise::compute2D(xCoord / 1000.f, yCoord / 1000.f, 8, true);
-      // noiseValue       = Raz::PerlinNoise::compute2D(xCoord / 1000.f + noiseValue, yCoord / 1000.f + noiseValue, 8, true);
-      // noiseValue       = Raz::PerlinNoise::compute2D(xCoord / 1000.f + noiseValue, yCoord / 1000.f + noiseValue, 8, true);
+    for (std::size_t rowIndex = range.beginIndex; rowIndex < range.endIndex; ++rowIndex) {
+      // When building a regeneration that has been cancelled, the remaining rows are left out, the terrain being discarded anyway
+      if (isCancelled())
+        return;
 
-      float noiseValue = Raz::PerlinNoise::compute2D(xCoord / 100.f, yCoord / 100.f, 8, true);
-      noiseValue       = std::pow(noiseValue, m_flatness);
+      const auto yCoord = static_cast<float>(rowIndex);
 
-      const Raz::Vec2f scaledCoords = (Raz::Vec2f(xCoord, yCoord) - static_cast<float>(m_width) * 0.5f) * 0.5f;
+      if (m_noiseGraphEvaluator) {
+        m_noiseGraphEvaluator(0.f, yCoord * m_noiseFactor, m_noiseFactor, noiseValues.data(), noiseValues.size());
+      } else {
+        for (std::size_t columnIndex = 0; columnIndex < m_width; ++columnIndex)
+          noiseValues[columnIndex] = Raz::PerlinNoise::compute2D(static_cast<float>(columnIndex) * m_noiseFactor, yCoord * m_noiseFactor, m_octaveCount, true);
+      }
 
-      Raz::Vertex& vertex = vertices[i];
-      vertex.position     = Raz::Vec3f(scaledCoords.x(), noiseValue * m_heightFactor, scaledCoords.y());
-      vertex.texcoords    = Raz::Vec2f(xCoord / static_cast<float>(m_width), yCoord / static_cast<float>(m_depth));
+      for (std::size_t columnIndex = 0; columnIndex < m_width; ++columnIndex) {
+        const auto xCoord      = static_cast<float>(columnIndex);
+        const float noiseValue = std::pow(noiseValues[columnIndex], m_flatness);
+
+        const Raz::Vec2f scaledCoords = (Raz::Vec2f(xCoord, yCoord) - static_cast<float>(m_width) * 0.5f) * 0.5f;
+
+        Raz::Vertex& vertex = vertices[rowIndex * m_width + columnIndex];
+        vertex.position     = Raz::Vec3f(scaledCoords.x(), noiseValue * m_heightFactor, scaledCoords.y());
+        vertex.texcoords    = Raz::Vec2f(xCoord / static_cast<float>(m_width), yCoord / static_cast<float>(m_depth));
+      }
     }
-  });
+  }, m_taskCount);
 
-//  for (unsigned int j = 0; j < m_depth; ++j) {
-//    const unsigned int depthIndex = j * m_depth;
-//
-//    for (unsigned int i = 0; i < m_width; ++i) {
-//      Raz::Vec2f coords(static_cast<float>(i), static_cast<float>(j));
-//
-//      // float noiseValue = Raz::PerlinNoise::compute2D(coords.x() / 1000.f, coords.y() / 1000.f, 8, true);
-//      // noiseValue       = Raz::PerlinNoise::compute2D(coords.x() / 1000.f + noiseValue, coords.y() / 1000.f + noiseValue, 8, true);
-//      // noiseValue       = Raz::PerlinNoise::compute2D(coords.x() / 1000.f + noiseValue, coords.y() / 1000.f + noiseValue, 8, true);
-//
-//      float noiseValue = Raz::PerlinNoise::compute2D(coords.x() / 100.f, coords.y() / 100.f, 8, true);
-//      noiseValue       = std::pow(noiseValue, flatness);
-//
-//      coords = (coords - static_cast<float>(m_width) / 2.f) / 2.f;
-//
-//      Raz::Vertex& vertex = vertices[depthIndex + i];
-//      vertex.position     = Raz::Vec3f(coords.x(), noiseValue * heightFactor, coords.y());
-//      vertex.texcoords    = Raz::Vec2f(static_cast<float>(i) / static_cast<float>(m_width), static_cast<float>(j) / static_cast<float>(m_depth));
-//    }
-//  }
+  computeNormals();
+  computeIndices();
+  uploadMesh();
+
+  if (m_areHorizonMapsBaked)
+    bakeHorizonMaps(m_sunDirection);
+
+  applyResidencyPolicy();
+}
+
+void StaticTerrain::generate(const HeightfieldSource& source, unsigned int originX, unsigned int originZ,
+                             unsigned int width, unsigned int depth, float heightFactor, float flatness) {
+  ZoneScopedN("StaticTerrain::generate");
+  const ScopedCpuTimer stageTimer(recoverStageTimings(StaticTerrainStage::GENERATION));
+
+  if (originX + width > source.getWidth() || originZ + depth > source.getDepth())
+    throw std::out_of_range("[StaticTerrain] The region to generate the terrain from exceeds the heightfield source's dimensions.");
+
+  cancelRegenerations();
+
+  m_width = width;
+  m_depth = depth;
+  Terrain::setParameters(heightFactor, flatness);
+
+  auto& mesh = m_entity.getComponent<Raz::Mesh>();
+  mesh.getSubmeshes().resize(1);
+
+  // Computing vertices
+
+  std::vector<Raz::Vertex>& vertices = mesh.getSubmeshes().front().getVertices();
+  vertices.resize(m_width * m_depth);
+
+  const unsigned int bandCount = (m_depth + sourceBandSize - 1) / sourceBandSize;
+
+  // Reading a band may fail, for instance if the source's file is truncated; the exception is kept to be rethrown once all tasks have finished
+  std::vector<std::exception_ptr> bandExceptions(bandCount);
+
+  Raz::Threading::parallelize(0, bandCount, [this, &source, originX, originZ, &vertices, &bandExceptions] (const Raz::Threading::IndexRange& range) noexcept {
+    ZoneScopedN("StaticTerrain::generate");
+
+    std::vector<float> bandHeights(static_cast<std::size_t>(m_width) * sourceBandSize);
+
+    for (std::size_t bandIndex = range.beginIndex; bandIndex < range.endIndex; ++bandIndex) {
+      const auto bandStartZ = static_cast<unsigned int>(bandIndex * sourceBandSize);
+      const unsigned int bandDepth = std::min(sourceBandSize, m_depth - bandStartZ);
+
+      try {
+        source.readRegion(originX, originZ + bandStartZ, m_width, bandDepth, bandHeights.data());
+      } catch (...) {
+        bandExceptions[bandIndex] = std::current_exception();
+        continue;
+      }
+
+      for (unsigned int bandZ = 0; bandZ < bandDepth; ++bandZ) {
+        const unsigned int z = bandStartZ + bandZ;
+
+        for (unsigned int x = 0; x < m_width; ++x) {
+          const auto xCoord = static_cast<float>(x);
+          const auto yCoord = static_cast<float>(z);
+
+          const float height = std::pow(bandHeights[bandZ * m_width + x], m_flatness);
+
+          const Raz::Vec2f scaledCoords = (Raz::Vec2f(xCoord, yCoord) - static_cast<float>(m_width) * 0.5f) * 0.5f;
+
+          Raz::Vertex& vertex = vertices[z * m_width + x];
+          vertex.position     = Raz::Vec3f(scaledCoords.x(), height * m_heightFactor, scaledCoords.y());
+          vertex.texcoords    = Raz::Vec2f(xCoord / static_cast<float>(m_width), yCoord / static_cast<float>(m_depth));
+        }
+      }
+
+      // The band's heights are now stored in the vertices; the source's memory can be reclaimed
+      source.releaseRegion(originX, originZ + bandStartZ, m_width, bandDepth);
+    }
+  }, m_taskCount);
+
+  for (const std::exception_ptr& bandException : bandExceptions) {
+    if (bandException)
+      std::rethrow_exception(bandException);
+  }
 
   computeNormals();
+  computeIndices();
+  uploadMesh();
 
-  // Computing indices
+  if (m_areHorizonMapsBaked)
+    bakeHorizonMaps(m_sunDirection);
 
-  std::vector<unsigned int>& indices = mesh.getSubmeshes().front().getTriangleIndices();
-  indices.resize(vertices.size() * 6);
+  applyResidencyPolicy();
+}
 
-  for (unsigned int j = 0; j < m_depth - 1; ++j) {
-    const unsigned int depthIndex = j * m_depth;
+void StaticTerrain::generateInBackground(unsigned int width, unsigned int depth, float heightFactor, float flatness) {
+  ZoneScopedN("StaticTerrain::generateInBackground");
 
-    for (unsigned int i = 0; i < m_width - 1; ++i) {
-      //     i     i + 1
-      //     v       v
-      //     --------- <- j * width
-      //     |      /|
-      //     |    /  |
-      //     |  /    |
-      //     |/______| <- (j + 1) * width
-      //     ^       ^
-      //  j + 1    j + 1 + i + 1
+  // The running regeneration would be replaced as soon as swapped; it is stopped so that the new terrain is available sooner
+  if (m_regenerationJob != nullptr)
+    m_regenerationJob->isCancelled = true;
 
-      const unsigned int finalIndex = (depthIndex + i) * 6;
+  m_pendingRegeneration = PendingRegeneration{ true, width, depth, heightFactor, flatness };
+  launchPendingRegeneration();
+}
 
-      indices[finalIndex    ] = j * m_width + i;
-      indices[finalIndex + 1] = (j + 1) * m_width + i;
-      indices[finalIndex + 2] = j * m_width + i + 1;
-      indices[finalIndex + 3] = j * m_width + i + 1;
-      indices[finalIndex + 4] = (j + 1) * m_width + i;
-      indices[finalIndex + 5] = (j + 1) * m_width + i + 1;
+void StaticTerrain::setParametersInBackground(float heightFactor, float flatness) {
+  ZoneScopedN("StaticTerrain::setParametersInBackground");
+
+  // A generation not launched yet simply takes the new parameters
+  if (m_pendingRegeneration.has_value() && m_pendingRegeneration->isGenerationRequested) {
+    m_pendingRegeneration->heightFactor = heightFactor;
+    m_pendingRegeneration->flatness     = flatness;
+    return;
+  }
+
+  checkHeightsAvailability(m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices());
+
+  // Any change requested earlier & not launched yet is replaced, the parameters being absolute
+  m_pendingRegeneration = PendingRegeneration{ false, m_width, m_depth, heightFactor, flatness };
+  launchPendingRegeneration();
+}
+
+bool StaticTerrain::swapRegeneratedBuffers() {
+  if (m_regenerationJob == nullptr || !m_regenerationJob->isFinished())
+    return false;
+
+  ZoneScopedN("StaticTerrain::swapRegeneratedBuffers");
+
+  const std::unique_ptr<RegenerationJob> job = std::move(m_regenerationJob);
+  job->result.get(); // Rethrowing any exception raised by the worker
+
+  // A cancelled job is discarded, its terrain being incomplete; the one superseding it can now be launched
+  if (job->isCancelled) {
+    launchPendingRegeneration();
+    return false;
+  }
+
+  StaticTerrain& stagingTerrain = job->terrain;
+
+  // Fixing up the buffers here would stall the rendering; the job is instead launched again, unless superseded by a generation
+  if (isRegenerationOutdated(stagingTerrain)) {
+    if (!m_pendingRegeneration.has_value()) {
+      m_pendingRegeneration = job->request;
+    } else if (job->request.isGenerationRequested && !m_pendingRegeneration->isGenerationRequested) {
+      // A change of parameters requested meanwhile applies to the terrain which has yet to be generated
+      m_pendingRegeneration->isGenerationRequested = true;
+      m_pendingRegeneration->width                 = job->request.width;
+      m_pendingRegeneration->depth                 = job->request.depth;
     }
+
+    launchPendingRegeneration();
+    return false;
+  }
+
+  Raz::Submesh& submesh        = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front();
+  Raz::Submesh& stagingSubmesh = stagingTerrain.m_entity.getComponent<Raz::Mesh>().getSubmeshes().front();
+
+  submesh.getVertices().swap(stagingSubmesh.getVertices());
+
+  // When only the parameters have changed, the indices are not computed again, unless the mesh is adaptive or the current ones have been released
+  if (!stagingSubmesh.getTriangleIndices().empty()) {
+    submesh.getTriangleIndices().swap(stagingSubmesh.getTriangleIndices());
+    m_triangleCount = stagingTerrain.m_triangleCount;
+  }
+
+  m_width = stagingTerrain.m_width;
+  m_depth = stagingTerrain.m_depth;
+  Terrain::setParameters(stagingTerrain.m_heightFactor, stagingTerrain.m_flatness);
+
+  std::swap(m_colorMap, stagingTerrain.m_colorMap);
+  std::swap(m_materialMap, stagingTerrain.m_materialMap);
+  std::swap(m_normalMap, stagingTerrain.m_normalMap);
+  std::swap(m_slopeMap, stagingTerrain.m_slopeMap);
+  std::swap(m_ambientOcclusionMap, stagingTerrain.m_ambientOcclusionMap);
+  std::swap(m_sunVisibilityMap, stagingTerrain.m_sunVisibilityMap);
+  m_horizonSines.swap(stagingTerrain.m_horizonSines);
+
+  // The worker has copied the final heights, either to be kept by the residency policy or for the pending change of parameters to start from
+  std::vector<float> heights;
+  heights.swap(stagingTerrain.m_heights);
+
+  for (std::size_t stageIndex = 0; stageIndex < m_stageTimings.size(); ++stageIndex)
+    m_stageTimings[stageIndex].addSamples(stagingTerrain.m_stageTimings[stageIndex]);
+
+  // Only the uploads are left to the rendering thread
+  uploadMesh();
+
+  if (m_areHorizonMapsBaked)
+    uploadHorizonMaps();
+
+  if (!m_colorMap.isEmpty())
+    uploadColorMap();
+
+  for (const std::function<void()>& callbackResult : job->callbackResults)
+    callbackResult();
+
+  if (m_residencyPolicy == ResidencyPolicy::KEEP_HEIGHTS_ONLY) {
+    m_heights.swap(heights);
+    std::vector<float>().swap(heights);
+  } else {
+    std::vector<float>().swap(m_heights);
   }
 
-  m_entity.getComponent<Raz::MeshRenderer>().load(mesh);
+  if (m_residencyPolicy != ResidencyPolicy::KEEP_CPU_COPIES)
+    releaseUploadedData();
+
+  // Launched only now, so that a change of parameters applies to the heights just swapped
+  launchPendingRegeneration(std::move(heights));
+
+  return true;
+}
+
+Raz::Image StaticTerrain::computeHeightMap() const {
+  ZoneScopedN("StaticTerrain::computeHeightMap");
+
+  Raz::Image heightMap(m_width, m_depth, Raz::ImageColorspace::GRAY, Raz::ImageDataType::FLOAT);
+  auto* imgData = static_cast<float*>(heightMap.getDataPtr());
+
+  const std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
+  checkHeightsAvailability(vertices);
+
+  Raz::Threading::parallelize(0, static_cast<std::size_t>(m_width) * m_depth, [this, &vertices, imgData] (const Raz::Threading::IndexRange& range) noexcept {
+    ZoneScopedN("StaticTerrain::computeHeightMap");
+
+    for (std::size_t i = range.beginIndex; i < range.endIndex; ++i)
+      imgData[i] = recoverHeight(vertices, i) / m_heightFactor;
+  }, m_taskCount);
+
+  return heightMap;
 }
 
 const Raz::Image& StaticTerrain::computeColorMap() {
   ZoneScopedN("StaticTerrain::computeColorMap");
+  const ScopedCpuTimer stageTimer(recoverStageTimings(StaticTerrainStage::COLOR_MAP));
 
-  m_colorMap = Raz::Image(m_width, m_depth, Raz::ImageColorspace::RGB);
-  auto* imgData = static_cast<uint8_t*>(m_colorMap.getDataPtr());
-
+  // The map only depends on the heights, read from those kept by the residency policy if the vertices have been released
   const std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
+  checkHeightsAvailability(vertices);
+
+  // The slope strengths are read from the slope map rather than computed again
+  if (m_slopeMap.getWidth() != m_width || m_slopeMap.getHeight() != m_depth)
+    computeSlopeMap();
+
+  m_colorMap    = Raz::Image(m_width, m_depth, Raz::ImageColorspace::RGB);
+  m_materialMap = Raz::Image(m_width, m_depth, Raz::ImageColorspace::GRAY);
+  auto* colorData    = static_cast<uint8_t*>(m_colorMap.getDataPtr());
+  auto* materialData = static_cast<uint8_t*>(m_materialMap.getDataPtr());
+
+  // The slope strengths are read directly from the uncompressed slope map, whose blue channel holds them
+  const auto* slopeData = (m_slopeMap.getDataType() == Raz::ImageDataType::FLOAT ? static_cast<const float*>(m_slopeMap.getDataPtr()) : nullptr);
 
-  Raz::Threading::parallelize(0, vertices.size(), [this, &vertices, imgData] (const Raz::Threading::IndexRange& range) noexcept {
+  Raz::Threading::parallelize(0, m_depth, [this, &vertices, slopeData, colorData, materialData] (const Raz::Threading::IndexRange& range) noexcept {
     ZoneScopedN("StaticTerrain::computeColorMap");
 
-    for (std::size_t i = range.beginIndex; i < range.endIndex; ++i) {
-      const float noiseValue      = std::pow(vertices[i].position.y() / m_heightFactor, m_invFlatness);
-      const Raz::Vec3b pixelValue = (noiseValue < 0.33f ? Raz::MathUtils::lerp(waterColor, grassColor, noiseValue * 3.f)
-                                  : (noiseValue < 0.5f  ? Raz::MathUtils::lerp(grassColor, groundColor, (noiseValue - 0.33f) * 5.75f)
-                                  : (noiseValue < 0.66f ? Raz::MathUtils::lerp(groundColor, rockColor, (noiseValue - 0.5f) * 6.f)
-                                                        : Raz::MathUtils::lerp(rockColor, snowColor, (noiseValue - 0.66f) * 3.f))));
-
-      const std::size_t dataStride = i * 3;
-      imgData[dataStride]     = pixelValue.x();
-      imgData[dataStride + 1] = pixelValue.y();
-      imgData[dataStride + 2] = pixelValue.z();
+    const float invHeightFactor = 1.f / m_heightFactor;
+    const bool isMoistureUsed   = m_biomeTable.isMoistureUsed();
+
+    for (std::size_t depthIndex = range.beginIndex; depthIndex < range.endIndex; ++depthIndex) {
+      if (isCancelled())
+        return;
+
+      const std::size_t rowIndex = depthIndex * m_width;
+
+      for (std::size_t widthIndex = 0; widthIndex < m_width; ++widthIndex) {
+        const std::size_t texelIndex = rowIndex + widthIndex;
+
+        // Classified by the height before flattening, so that the biomes stay put whatever the flatness
+        const float baseHeight    = std::pow(recoverHeight(vertices, texelIndex) * invHeightFactor, m_invFlatness);
+        const float slopeStrength = (slopeData != nullptr ? slopeData[texelIndex * 3 + 2]
+                                                          : recoverSlopeStrength(static_cast<unsigned int>(widthIndex), static_cast<unsigned int>(depthIndex)));
+        const float moisture      = (isMoistureUsed ? m_biomeTable.computeMoisture(static_cast<float>(widthIndex), static_cast<float>(depthIndex)) : 0.f);
+        const uint8_t* biomeData  = m_biomeTable.classify(baseHeight, slopeStrength, moisture);
+
+        colorData[texelIndex * 3]     = biomeData[0];
+        colorData[texelIndex * 3 + 1] = biomeData[1];
+        colorData[texelIndex * 3 + 2] = biomeData[2];
+        materialData[texelIndex]      = biomeData[3];
+      }
     }
-  });
+  }, m_taskCount);
 
-  m_entity.getComponent<Raz::MeshRenderer>().getMaterials().front().getProgram().setTexture(Raz::Texture2D::create(m_colorMap, true, true),
-                                                                                            Raz::MaterialTexture::BaseColor);
+  uploadColorMap();
 
   return m_colorMap;
 }
 
 const Raz::Image& StaticTerrain::computeNormalMap() {
   ZoneScopedN("StaticTerrain::computeNormalMap");
+  const ScopedCpuTimer stageTimer(recoverStageTimings(StaticTerrainStage::NORMAL_MAP));
+
+  const std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
+  checkHeightsAvailability(vertices);
 
   m_normalMap = Raz::Image(m_width, m_depth, Raz::ImageColorspace::RGB);
   auto* imgData = static_cast<uint8_t*>(m_normalMap.getDataPtr());
 
-  const std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
-
-  Raz::Threading::parallelize(0, vertices.size(), [&vertices, imgData] (const Raz::Threading::IndexRange& range) noexcept {
+  Raz::Threading::parallelize(0, m_depth, [this, &vertices, imgData] (const Raz::Threading::IndexRange& range) noexcept {
     ZoneScopedN("StaticTerrain::computeNormalMap");
 
-    for (std::size_t i = range.beginIndex; i < range.endIndex; ++i) {
-      const Raz::Vec3f& normal = vertices[i].normal;
+    for (std::size_t depthIndex = range.beginIndex; depthIndex < range.endIndex; ++depthIndex) {
+      if (isCancelled())
+        return;
+
+      const bool isBorderRow = (depthIndex == 0 || depthIndex == m_depth - 1);
+
+      for (std::size_t widthIndex = 0; widthIndex < m_width; ++widthIndex) {
+        const std::size_t i = depthIndex * m_width + widthIndex;
+
+        // Without vertices, the normals are computed from the kept heights; those of the border are left as rehydrated vertices would have them
+        Raz::Vec3f normal;
+
+        if (!vertices.empty())
+          normal = vertices[i].normal;
+        else if (isBorderRow || widthIndex == 0 || widthIndex == m_width - 1)
+          normal = Raz::Vertex().normal;
+        else
+          normal = computeNormal(vertices, widthIndex, depthIndex);
 
-      const std::size_t dataStride = i * 3;
-      imgData[dataStride]     = static_cast<uint8_t>(std::max(0.f, normal.x()) * 255.f);
-      imgData[dataStride + 1] = static_cast<uint8_t>(std::max(0.f, normal.y()) * 255.f);
-      imgData[dataStride + 2] = static_cast<uint8_t>(std::max(0.f, normal.z()) * 255.f);
+        const std::size_t dataStride = i * 3;
+        imgData[dataStride]     = static_cast<uint8_t>(std::max(0.f, normal.x()) * 255.f);
+        imgData[dataStride + 1] = static_cast<uint8_t>(std::max(0.f, normal.y()) * 255.f);
+        imgData[dataStride + 2] = static_cast<uint8_t>(std::max(0.f, normal.z()) * 255.f);
+      }
     }
-  });
+  }, m_taskCount);
 
   return m_normalMap;
 }
 
 const Raz::Image& StaticTerrain::computeSlopeMap() {
   ZoneScopedN("StaticTerrain::computeSlopeMap");
-
-  m_slopeMap = Raz::Image(m_width, m_depth, Raz::ImageColorspace::RGB, Raz::ImageDataType::FLOAT);
+  const ScopedCpuTimer stageTimer(recoverStageTimings(StaticTerrainStage::SLOPE_MAP));
 
   const std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
+  checkHeightsAvailability(vertices);
 
-  Raz::Threading::parallelize(1, m_depth - 1, [this, &vertices] (const Raz::Threading::IndexRange& range) noexcept {
+  const bool isCompressed = (m_slopeMapFormat == SlopeMapFormat::RG8);
+
+  if (isCompressed) {
+    m_slopeMap = Raz::Image(m_width, m_depth, Raz::ImageColorspace::GRAY_ALPHA);
+
+    // Border texels are left with a null gradient
+    auto* imgData = static_cast<uint8_t*>(m_slopeMap.getDataPtr());
+    std::fill(imgData, imgData + static_cast<std::size_t>(m_width) * m_depth * 2, SlopeCompression::zeroByte);
+  } else {
+    m_slopeMap = Raz::Image(m_width, m_depth, Raz::ImageColorspace::RGB, Raz::ImageDataType::FLOAT);
+  }
+
+  Raz::Threading::parallelize(1, m_depth - 1, [this, &vertices, isCompressed] (const Raz::Threading::IndexRange& range) noexcept {
     ZoneScopedN("StaticTerrain::computeSlopeMap");
 
     for (std::size_t depthIndex = range.beginIndex; depthIndex < range.endIndex; ++depthIndex) {
+      if (isCancelled())
+        return;
+
       for (std::size_t widthIndex = 1; widthIndex < m_width - 1; ++widthIndex) {
-        const float topHeight   = vertices[(depthIndex - 1) * m_width + widthIndex].position.y();
-        const float leftHeight  = vertices[depthIndex * m_width + widthIndex - 1].position.y();
-        const float rightHeight = vertices[depthIndex * m_width + widthIndex + 1].position.y();
-        const float botHeight   = vertices[(depthIndex + 1) * m_width + widthIndex].position.y();
+        const float topHeight   = recoverHeight(vertices, (depthIndex - 1) * m_width + widthIndex);
+        const float leftHeight  = recoverHeight(vertices, depthIndex * m_width + widthIndex - 1);
+        const float rightHeight = recoverHeight(vertices, depthIndex * m_width + widthIndex + 1);
+        const float botHeight   = recoverHeight(vertices, (depthIndex + 1) * m_width + widthIndex);
 
         const Raz::Vec2f slopeVec(leftHeight - rightHeight, topHeight - botHeight);
-        const float slopeStrength = slopeVec.computeLength() * 0.5f;
 
+        if (isCompressed) {
+          // The half gradient's length being the slope strength, both the direction & the strength are recovered from it
+          const Raz::Vec2f halfGradient = slopeVec * 0.5f;
+          m_slopeMap.setPixel(widthIndex, depthIndex, Raz::Vec2b(SlopeCompression::compressGradient(halfGradient.x()),
+                                                                     SlopeCompression::compressGradient(halfGradient.y())));
+          continue;
+        }
+
+        const float slopeStrength = slopeVec.computeLength() * 0.5f;
         m_slopeMap.setPixel(widthIndex, depthIndex, Raz::Vec3f(slopeVec.normalize(), slopeStrength));
       }
     }
-  });
+  }, m_taskCount);
 
   return m_slopeMap;
 }
 
+void StaticTerrain::bakeHorizonMaps(const Raz::Vec3f& sunDirection) {
+  ZoneScopedN("StaticTerrain::bakeHorizonMaps");
+
+  checkHeightsAvailability(m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices());
+
+  m_sunDirection        = sunDirection;
+  m_areHorizonMapsBaked = true;
+
+  m_horizonSines.resize(static_cast<std::size_t>(m_horizonDirectionCount) * m_width * m_depth);
+  m_ambientOcclusionMap = Raz::Image(m_width, m_depth, Raz::ImageColorspace::GRAY);
+  m_sunVisibilityMap    = Raz::Image(m_width, m_depth, Raz::ImageColorspace::GRAY);
+
+  bakeHorizons(0, 0, m_width, m_depth);
+  uploadHorizonMaps();
+  applyResidencyPolicy();
+}
+
+void StaticTerrain::updateHorizonMaps(unsigned int originX, unsigned int originZ, unsigned int width, unsigned int depth) {
+  ZoneScopedN("StaticTerrain::updateHorizonMaps");
+
+  if (originX + width > m_width || originZ + depth > m_depth)
+    throw std::out_of_range("[StaticTerrain] The region to update the horizon maps in exceeds the terrain's dimensions.");
+
+  if (!m_areHorizonMapsBaked) {
+    Raz::Logger::warn("[StaticTerrain] The horizon maps must be baked before being updated.");
+    return;
+  }
+
+  // The horizons of the other texels may have been released by the residency policy, in which case all of them must be baked again
+  if (m_horizonSines.empty()) {
+    bakeHorizonMaps(m_sunDirection);
+    return;
+  }
+
+  checkHeightsAvailability(m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices());
+
+  // Any texel close enough to see the region may have its horizon changed
+  bakeHorizons((originX > horizonReach ? originX - horizonReach : 0), (originZ > horizonReach ? originZ - horizonReach : 0),
+               std::min(originX + width + horizonReach, m_width), std::min(originZ + depth + horizonReach, m_depth));
+  uploadHorizonMaps();
+  applyResidencyPolicy();
+}
+
+Raz::Vec3f StaticTerrain::computePosition(float x, float z) const {
+  const std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
+  checkHeightsAvailability(vertices);
+
+  x = std::clamp(x, 0.f, static_cast<float>(m_width - 1));
+  z = std::clamp(z, 0.f, static_cast<float>(m_depth - 1));
+
+  const auto firstX  = static_cast<unsigned int>(x);
+  const auto firstZ  = static_cast<unsigned int>(z);
+  const unsigned int secondX = std::min(firstX + 1, m_width - 1);
+  const unsigned int secondZ = std::min(firstZ + 1, m_depth - 1);
+
+  const float xCoeff = x - static_cast<float>(firstX);
+  const float zCoeff = z - static_cast<float>(firstZ);
+
+  const float topHeight = Raz::MathUtils::lerp(recoverHeight(vertices, firstZ * m_width + firstX), recoverHeight(vertices, firstZ * m_width + secondX), xCoeff);
+  const float botHeight = Raz::MathUtils::lerp(recoverHeight(vertices, secondZ * m_width + firstX), recoverHeight(vertices, secondZ * m_width + secondX), xCoeff);
+
+  // The coordinates are scaled the same way as the vertices' when generating the terrain
+  const Raz::Vec2f scaledCoords = (Raz::Vec2f(x, z) - static_cast<float>(m_width) * 0.5f) * 0.5f;
+  return Raz::Vec3f(scaledCoords.x(), Raz::MathUtils::lerp(topHeight, botHeight, zCoeff), scaledCoords.y());
+}
+
+float StaticTerrain::recoverSlopeStrength(unsigned int x, unsigned int z) const {
+  if (m_slopeMap.getDataType() == Raz::ImageDataType::FLOAT)
+    return m_slopeMap.recoverPixel<float, 3>(x, z).z();
+
+  const Raz::Vec2b compressedGradient = m_slopeMap.recoverPixel<uint8_t, 2>(x, z);
+  return Raz::Vec2f(SlopeCompression::decompressGradient(compressedGradient.x()),
+                    SlopeCompression::decompressGradient(compressedGradient.y())).computeLength();
+}
+
+std::vector<TerrainBufferMemory> StaticTerrain::computeMemoryUsage() const {
+  ZoneScopedN("StaticTerrain::computeMemoryUsage");
+
+  const auto computeImageByteCount = [] (const Raz::Image& image) -> std::size_t {
+    if (image.isEmpty())
+      return 0;
+
+    return static_cast<std::size_t>(image.getWidth()) * image.getHeight() * image.getChannelCount()
+         * (image.getDataType() == Raz::ImageDataType::FLOAT ? sizeof(float) : sizeof(uint8_t));
+  };
+
+  // The terrain may not have been generated yet, in which case its mesh has no submesh
+  const std::vector<Raz::Submesh>& submeshes = m_entity.getComponent<Raz::Mesh>().getSubmeshes();
+  const std::size_t vertexByteCount = (submeshes.empty() ? 0 : submeshes.front().getVertices().capacity() * sizeof(Raz::Vertex));
+  const std::size_t indexByteCount  = (submeshes.empty() ? 0 : submeshes.front().getTriangleIndices().capacity() * sizeof(unsigned int));
+
+  return {
+    { "Vertices",              vertexByteCount,                                                  m_uploadedVertexCount * sizeof(Raz::Vertex) },
+    { "Indices",               indexByteCount,                                                   m_uploadedIndexCount * sizeof(unsigned int) },
+    { "Heights",               m_heights.capacity() * sizeof(float),                             0 },
+    { "Horizon sines",         m_horizonSines.capacity() * sizeof(uint16_t),                     0 },
+    { "Color map",             computeImageByteCount(m_colorMap),                                m_colorTextureByteCount },
+    { "Material map",          computeImageByteCount(m_materialMap),                             0 },
+    { "Normal map",            computeImageByteCount(m_normalMap),                               0 },
+    { "Slope map",             computeImageByteCount(m_slopeMap),                                0 },
+    { "Ambient occlusion map", computeImageByteCount(m_ambientOcclusionMap),                     m_ambientOcclusionTextureByteCount },
+    { "Sun visibility map",    computeImageByteCount(m_sunVisibilityMap),                        m_sunVisibilityTextureByteCount }
+  };
+}
+
 void StaticTerrain::computeNormals() {
   ZoneScopedN("StaticTerrain::computeNormals");
 
@@ -222,6 +871,9 @@ void StaticTerrain::computeNormals() {
     ZoneScopedN("StaticTerrain::computeNormals");
 
     for (std::size_t depthIndex = range.beginIndex; depthIndex < range.endIndex; ++depthIndex) {
+      if (isCancelled())
+        return;
+
       const std::size_t depthStride = depthIndex * m_width;
 
       for (std::size_t widthIndex = 1; widthIndex < m_width - 1; ++widthIndex) {
@@ -235,13 +887,8 @@ void StaticTerrain::computeNormals() {
 
         // Using finite differences
 
-        const float topHeight   = vertices[(depthIndex - 1) * m_width + widthIndex].position.y();
-        const float leftHeight  = vertices[depthStride + widthIndex - 1].position.y();
-        const float rightHeight = vertices[depthStride + widthIndex + 1].position.y();
-        const float botHeight   = vertices[(depthIndex + 1) * m_width + widthIndex].position.y();
-
         Raz::Vertex& midVertex = vertices[depthStride + widthIndex];
-        midVertex.normal  = Raz::Vec3f(leftHeight - rightHeight, 0.1f, topHeight - botHeight).normalize();
+        midVertex.normal  = computeNormal(vertices, widthIndex, depthIndex);
         midVertex.tangent = Raz::Vec3f(midVertex.normal.z(), midVertex.normal.x(), midVertex.normal.y());
 
         // Using cross products
@@ -271,7 +918,310 @@ void StaticTerrain::computeNormals() {
 //        midVertex.tangent  = Raz::Vec3f(midVertex.normal.z(), midVertex.normal.x(), midVertex.normal.y());
       }
     }
-  });
+  }, m_taskCount);
+}
+
+Raz::Vec3f StaticTerrain::computeNormal(const std::vector<Raz::Vertex>& vertices, std::size_t widthIndex, std::size_t depthIndex) const noexcept {
+  const float topHeight   = recoverHeight(vertices, (depthIndex - 1) * m_width + widthIndex);
+  const float leftHeight  = recoverHeight(vertices, depthIndex * m_width + widthIndex - 1);
+  const float rightHeight = recoverHeight(vertices, depthIndex * m_width + widthIndex + 1);
+  const float botHeight   = recoverHeight(vertices, (depthIndex + 1) * m_width + widthIndex);
+
+  return Raz::Vec3f(leftHeight - rightHeight, 0.1f, topHeight - botHeight).normalize();
+}
+
+void StaticTerrain::uploadMesh() {
+  ZoneScopedN("StaticTerrain::uploadMesh");
+
+  if (!m_entity.hasComponent<Raz::MeshRenderer>())
+    return;
+
+  const ScopedCpuTimer stageTimer(recoverStageTimings(StaticTerrainStage::MESH_UPLOAD));
+
+  auto& mesh = m_entity.getComponent<Raz::Mesh>();
+  const Raz::Submesh& submesh = mesh.getSubmeshes().front();
+
+  if (submesh.getTriangleIndices().empty())
+    computeIndices();
+
+  // The submesh renderers may be recreated by the loading; the material the terrain is rendered with, which may not be its own, is kept
+  auto& meshRenderer = m_entity.getComponent<Raz::MeshRenderer>();
+  const std::size_t materialIndex = (meshRenderer.getSubmeshRenderers().empty() ? 0 : meshRenderer.getSubmeshRenderers().front().getMaterialIndex());
+  meshRenderer.load(mesh);
+  meshRenderer.getSubmeshRenderers().front().setMaterialIndex(materialIndex);
+
+  m_uploadedVertexCount = submesh.getVertices().size();
+  m_uploadedIndexCount  = submesh.getTriangleIndices().size();
+}
+
+void StaticTerrain::rehydrateVertices() {
+  std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
+
+  if (!vertices.empty())
+    return;
+
+  ZoneScopedN("StaticTerrain::rehydrateVertices");
+
+  checkHeightsAvailability(vertices);
+
+  vertices.resize(m_heights.size());
+
+  Raz::Threading::parallelize(0, vertices.size(), [this, &vertices] (const Raz::Threading::IndexRange& range) noexcept {
+    ZoneScopedN("StaticTerrain::rehydrateVertices");
+
+    for (std::size_t i = range.beginIndex; i < range.endIndex; ++i) {
+      const auto xCoord = static_cast<float>(i % m_width);
+      const auto yCoord = static_cast<float>(i / m_width);
+
+      const Raz::Vec2f scaledCoords = (Raz::Vec2f(xCoord, yCoord) - static_cast<float>(m_width) * 0.5f) * 0.5f;
+
+      Raz::Vertex& vertex = vertices[i];
+      vertex.position     = Raz::Vec3f(scaledCoords.x(), m_heights[i], scaledCoords.y());
+      vertex.texcoords    = Raz::Vec2f(xCoord / static_cast<float>(m_width), yCoord / static_cast<float>(m_depth));
+    }
+  }, m_taskCount);
+
+  computeNormals();
+}
+
+void StaticTerrain::applyResidencyPolicy() {
+  if (m_residencyPolicy == ResidencyPolicy::KEEP_CPU_COPIES)
+    return;
+
+  ZoneScopedN("StaticTerrain::applyResidencyPolicy");
+
+  if (m_residencyPolicy == ResidencyPolicy::KEEP_HEIGHTS_ONLY) {
+    if (!m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices().empty())
+      copyHeights();
+  } else {
+    std::vector<float>().swap(m_heights);
+  }
+
+  releaseUploadedData();
+}
+
+void StaticTerrain::copyHeights() {
+  ZoneScopedN("StaticTerrain::copyHeights");
+
+  const std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
+  m_heights.resize(vertices.size());
+
+  Raz::Threading::parallelize(0, vertices.size(), [this, &vertices] (const Raz::Threading::IndexRange& range) noexcept {
+    ZoneScopedN("StaticTerrain::copyHeights");
+
+    for (std::size_t i = range.beginIndex; i < range.endIndex; ++i)
+      m_heights[i] = vertices[i].position.y();
+  }, m_taskCount);
+}
+
+void StaticTerrain::releaseUploadedData() {
+  ZoneScopedN("StaticTerrain::releaseUploadedData");
+
+  Raz::Submesh& submesh = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front();
+
+  // Swapping with empty vectors, since clearing them would keep their memory allocated
+  std::vector<Raz::Vertex>().swap(submesh.getVertices());
+  std::vector<unsigned int>().swap(submesh.getTriangleIndices());
+  std::vector<uint16_t>().swap(m_horizonSines);
+
+  // Once uploaded, the ambient occlusion map is only needed by the GPU
+  if (m_entity.hasComponent<Raz::MeshRenderer>())
+    m_ambientOcclusionMap = Raz::Image();
+}
+
+void StaticTerrain::checkHeightsAvailability(const std::vector<Raz::Vertex>& vertices) const {
+  if (vertices.empty() && m_heights.empty())
+    throw std::runtime_error("[StaticTerrain] The terrain's heights have been released by the residency policy; it must be generated again.");
+}
+
+void StaticTerrain::computeIndices() {
+  ZoneScopedN("StaticTerrain::computeIndices");
+  const ScopedCpuTimer stageTimer(recoverStageTimings(StaticTerrainStage::MESHING));
+
+  if (m_meshingMode == MeshingMode::ADAPTIVE) {
+    computeAdaptiveIndices();
+    return;
+  }
+
+  m_triangleCount = static_cast<std::size_t>(m_width - 1) * (m_depth - 1) * 2;
+
+  std::vector<unsigned int>& indices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getTriangleIndices();
+  indices.resize(static_cast<std::size_t>(m_width - 1) * (m_depth - 1) * 6);
+
+  for (unsigned int j = 0; j < m_depth - 1; ++j) {
+    const unsigned int depthIndex = j * (m_width - 1);
+
+    for (unsigned int i = 0; i < m_width - 1; ++i) {
+      //     i     i + 1
+      //     v       v
+      //     --------- <- j * width
+      //     |      /|
+      //     |    /  |
+      //     |  /    |
+      //     |/______| <- (j + 1) * width
+      //     ^       ^
+      //  j + 1    j + 1 + i + 1
+
+      const unsigned int finalIndex = (depthIndex + i) * 6;
+
+      indices[finalIndex    ] = j * m_width + i;
+      indices[finalIndex + 1] = (j + 1) * m_width + i;
+      indices[finalIndex + 2] = j * m_width + i + 1;
+      indices[finalIndex + 3] = j * m_width + i + 1;
+      indices[finalIndex + 4] = (j + 1) * m_width + i;
+      indices[finalIndex + 5] = (j + 1) * m_width + i + 1;
+    }
+  }
+}
+
+void StaticTerrain::computeAdaptiveIndices() {
+  ZoneScopedN("StaticTerrain::computeAdaptiveIndices");
+
+  static const std::vector<uint16_t> triangleCoords = computeTileTriangleCoords();
+
+  const std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
+  checkHeightsAvailability(vertices);
+
+  // The terrain is covered by tiles sharing their borders; those on its last rows & columns may extend beyond it
+  const std::size_t tileCountX = (m_width - 1 + meshTileSize - 1) / meshTileSize;
+  const std::size_t tileCountZ = (m_depth - 1 + meshTileSize - 1) / meshTileSize;
+  const std::size_t tileCount  = tileCountX * tileCountZ;
+  const std::size_t taskCount  = std::min(m_taskCount, tileCount);
+
+  std::vector<std::vector<float>> tileErrors(tileCount);
+
+  const auto isOutside = [this] (int x, int z) noexcept {
+    return (x >= static_cast<int>(m_width) || z >= static_cast<int>(m_depth));
+  };
+
+  // Computing the vertical error each vertex would fix if inserted; triangles reaching beyond the terrain always have to be split
+  Raz::Threading::parallelize(0, tileCount, [this, &vertices, tileCountX, &tileErrors, &isOutside] (const Raz::Threading::IndexRange& range) noexcept {
+    ZoneScopedN("StaticTerrain::computeAdaptiveIndices");
+
+    for (std::size_t tileIndex = range.beginIndex; tileIndex < range.endIndex; ++tileIndex) {
+      if (isCancelled())
+        return;
+
+      const auto originX = static_cast<int>(tileIndex % tileCountX) * meshTileSize;
+      const auto originZ = static_cast<int>(tileIndex / tileCountX) * meshTileSize;
+
+      const auto recoverTileHeight = [this, &vertices, originX, originZ] (int x, int z) noexcept {
+        return recoverHeight(vertices, static_cast<std::size_t>(originZ + z) * m_width + static_cast<std::size_t>(originX + x));
+      };
+
+      std::vector<float>& errors = tileErrors[tileIndex];
+      errors.resize(meshTileGridSize * meshTileGridSize);
+
+      for (std::size_t triangleIndex = 0; triangleIndex < triangleCoords.size() / 4; ++triangleIndex) {
+        const int ax = triangleCoords[triangleIndex * 4];
+        const int az = triangleCoords[triangleIndex * 4 + 1];
+        const int bx = triangleCoords[triangleIndex * 4 + 2];
+        const int bz = triangleCoords[triangleIndex * 4 + 3];
+        const int mx = (ax + bx) / 2;
+        const int mz = (az + bz) / 2;
+        const int cx = mx + mz - az;
+        const int cz = mz + ax - mx;
+
+        float middleError {};
+
+        if (isOutside(originX + ax, originZ + az) || isOutside(originX + bx, originZ + bz) || isOutside(originX + cx, originZ + cz)) {
+          middleError = std::numeric_limits<float>::infinity();
+        } else {
+          const float interpolatedHeight = (recoverTileHeight(ax, az) + recoverTileHeight(bx, bz)) * 0.5f;
+          middleError = std::abs(interpolatedHeight - recoverTileHeight(mx, mz));
+        }
+
+        float& vertexError = errors[static_cast<std::size_t>(mz * meshTileGridSize + mx)];
+        vertexError = std::max(vertexError, middleError);
+      }
+
+      propagateTileErrors(errors, triangleCoords);
+    }
+  }, taskCount);
+
+  // Some tiles' errors are missing if the regeneration has been cancelled; their borders can't be synchronized
+  if (isCancelled())
+    return;
+
+  // Raising the border errors to those of the neighboring tiles may in turn raise the errors of other border vertices, until all agree
+  while (synchronizeTileBorders(tileErrors, tileCountX, tileCountZ)) {
+    Raz::Threading::parallelize(0, tileCount, [&tileErrors] (const Raz::Threading::IndexRange& range) noexcept {
+      for (std::size_t tileIndex = range.beginIndex; tileIndex < range.endIndex; ++tileIndex)
+        propagateTileErrors(tileErrors[tileIndex], triangleCoords);
+    }, taskCount);
+  }
+
+  // Splitting each tile's triangles as long as their midpoint's error exceeds the maximal one
+  std::vector<std::vector<unsigned int>> tileIndices(tileCount);
+
+  Raz::Threading::parallelize(0, tileCount, [this, tileCountX, &tileErrors, &tileIndices, &isOutside] (const Raz::Threading::IndexRange& range) noexcept {
+    ZoneScopedN("StaticTerrain::computeAdaptiveIndices");
+
+    std::vector<std::array<int, 6>> triangleStack;
+
+    // The indices are gathered into a buffer sized for a fully split tile, then copied once per tile at their exact count
+    std::vector<unsigned int> indices;
+    indices.reserve(static_cast<std::size_t>(meshTileSize * meshTileSize) * 2 * 3);
+
+    for (std::size_t tileIndex = range.beginIndex; tileIndex < range.endIndex; ++tileIndex) {
+      if (isCancelled())
+        return;
+
+      const auto originX = static_cast<int>(tileIndex % tileCountX) * meshTileSize;
+      const auto originZ = static_cast<int>(tileIndex / tileCountX) * meshTileSize;
+      const std::vector<float>& errors = tileErrors[tileIndex];
+      indices.clear();
+
+      // Each triangle is stored as its hypotenuse's ends, followed by its right angle's vertex
+      triangleStack.push_back({ 0, 0, meshTileSize, meshTileSize, meshTileSize, 0 });
+      triangleStack.push_back({ meshTileSize, meshTileSize, 0, 0, 0, meshTileSize });
+
+      while (!triangleStack.empty()) {
+        const auto [ax, az, bx, bz, cx, cz] = triangleStack.back();
+        triangleStack.pop_back();
+
+        const int mx = (ax + bx) / 2;
+        const int mz = (az + bz) / 2;
+
+        if (std::abs(ax - cx) + std::abs(az - cz) > 1 && errors[static_cast<std::size_t>(mz * meshTileGridSize + mx)] > m_maxMeshError) {
+          triangleStack.push_back({ cx, cz, ax, az, mx, mz });
+          triangleStack.push_back({ bx, bz, cx, cz, mx, mz });
+          continue;
+        }
+
+        // The finest triangles can still lie beyond the terrain, which does not necessarily end on a tile's border
+        if (isOutside(originX + ax, originZ + az) || isOutside(originX + bx, originZ + bz) || isOutside(originX + cx, originZ + cz))
+          continue;
+
+        const auto computeIndex = [this, originX, originZ] (int x, int z) noexcept {
+          return static_cast<unsigned int>(originZ + z) * m_width + static_cast<unsigned int>(originX + x);
+        };
+
+        // Keeping the same winding as the uniform grid's triangles, facing upward
+        const bool isUpward = ((bz - az) * (cx - ax) - (bx - ax) * (cz - az) > 0);
+
+        indices.push_back(computeIndex(ax, az));
+        indices.push_back(isUpward ? computeIndex(bx, bz) : computeIndex(cx, cz));
+        indices.push_back(isUpward ? computeIndex(cx, cz) : computeIndex(bx, bz));
+      }
+
+      tileIndices[tileIndex].assign(indices.cbegin(), indices.cend());
+    }
+  }, taskCount);
+
+  std::vector<unsigned int>& indices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getTriangleIndices();
+  indices.clear();
+
+  std::size_t indexCount = 0;
+  for (const std::vector<unsigned int>& tileIndexList : tileIndices)
+    indexCount += tileIndexList.size();
+
+  indices.reserve(indexCount);
+
+  for (const std::vector<unsigned int>& tileIndexList : tileIndices)
+    indices.insert(indices.end(), tileIndexList.cbegin(), tileIndexList.cend());
+
+  m_triangleCount = indices.size() / 3;
 }
 
 void StaticTerrain::remapVertices(float newHeightFactor, float newFlatness) {
@@ -284,11 +1234,388 @@ void StaticTerrain::remapVertices(float newHeightFactor, float newFlatness) {
     ZoneScopedN("StaticTerrain::remapVertices");
 
     for (Raz::Vertex& vertex : range) {
+      if (isCancelled())
+        return;
+
       const float baseHeight = std::pow(vertex.position.y() / m_heightFactor, m_invFlatness);
       vertex.position.y()    = std::pow(baseHeight, newFlatness) * newHeightFactor;
     }
-  });
+  }, m_taskCount);
 
   computeNormals();
-  m_entity.getComponent<Raz::MeshRenderer>().load(mesh);
+
+  // The triangles needed to stay within the maximal error depend on the heights
+  if (m_meshingMode == MeshingMode::ADAPTIVE)
+    computeIndices();
+
+  uploadMesh();
+
+  if (m_areHorizonMapsBaked)
+    bakeHorizonMaps(m_sunDirection);
+}
+
+void StaticTerrain::bakeHorizons(unsigned int beginX, unsigned int beginZ, unsigned int endX, unsigned int endZ) {
+  ZoneScopedN("StaticTerrain::bakeHorizons");
+  const ScopedCpuTimer stageTimer(recoverStageTimings(StaticTerrainStage::HORIZON_MAPS));
+
+  const std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
+
+  // Only the rows within reach of the region's horizons are read. The kept heights are used as is; otherwise, these rows are gathered
+  //  contiguously from the vertices, so that the sweeps below can be vectorized
+  const unsigned int readBeginZ = (beginZ > horizonReach ? beginZ - horizonReach : 0);
+  const unsigned int readEndZ   = std::min(endZ + horizonReach, m_depth);
+
+  std::vector<float> gatheredHeights;
+  const float* heights       = m_heights.data();
+  unsigned int heightsBeginZ = 0;
+
+  if (!vertices.empty()) {
+    gatheredHeights.resize(static_cast<std::size_t>(readEndZ - readBeginZ) * m_width);
+    const std::size_t firstVertexIndex = static_cast<std::size_t>(readBeginZ) * m_width;
+
+    Raz::Threading::parallelize(0, gatheredHeights.size(), [&vertices, &gatheredHeights, firstVertexIndex] (const Raz::Threading::IndexRange& range) noexcept {
+      ZoneScopedN("StaticTerrain::bakeHorizons");
+
+      for (std::size_t i = range.beginIndex; i < range.endIndex; ++i)
+        gatheredHeights[i] = vertices[firstVertexIndex + i].position.y();
+    }, m_taskCount);
+
+    heights       = gatheredHeights.data();
+    heightsBeginZ = readBeginZ;
+  }
+
+  const std::size_t directionStride = horizonDirections.size() / m_horizonDirectionCount;
+  auto* ambientOcclusionData = static_cast<uint8_t*>(m_ambientOcclusionMap.getDataPtr());
+
+  Raz::Threading::parallelize(beginZ, endZ, [this, beginX, endX, heights, heightsBeginZ, directionStride,
+                                             ambientOcclusionData] (const Raz::Threading::IndexRange& range) noexcept {
+    ZoneScopedN("StaticTerrain::bakeHorizons");
+
+    // The tangents are swept in full precision, only being quantized once a direction's horizons are found
+    std::vector<float> horizonTangents(m_width);
+    std::vector<float> skyVisibilities(m_width);
+
+    for (std::size_t z = range.beginIndex; z < range.endIndex; ++z) {
+      if (isCancelled())
+        return;
+
+      const float* rowHeights = heights + (z - heightsBeginZ) * m_width;
+      std::fill(skyVisibilities.begin() + beginX, skyVisibilities.begin() + endX, 0.f);
+
+      for (std::size_t directionIndex = 0; directionIndex < m_horizonDirectionCount; ++directionIndex) {
+        const auto [directionX, directionZ] = horizonDirections[directionIndex * directionStride];
+        const float invStepLength = 1.f / (texelSize * std::sqrt(static_cast<float>(directionX * directionX + directionZ * directionZ)));
+
+        std::fill(horizonTangents.begin() + beginX, horizonTangents.begin() + endX, 0.f);
+
+        // Sweeping the whole row at once for each step, the texels' horizons being independent from each other
+        for (const int step : horizonSteps) {
+          const int sampleZ = static_cast<int>(z) + directionZ * step;
+
+          if (sampleZ < 0 || sampleZ >= static_cast<int>(m_depth))
+            break;
+
+          const int offsetX     = directionX * step;
+          const int sweepBeginX = std::max(static_cast<int>(beginX), -offsetX);
+          const int sweepEndX   = std::min(static_cast<int>(endX), static_cast<int>(m_width) - offsetX);
+
+          const float* sampleHeights = heights + static_cast<std::size_t>(sampleZ - static_cast<int>(heightsBeginZ)) * m_width;
+          const float invDistance    = invStepLength / static_cast<float>(step);
+
+          for (int x = sweepBeginX; x < sweepEndX; ++x)
+            horizonTangents[x] = std::max(horizonTangents[x], (sampleHeights[x + offsetX] - rowHeights[x]) * invDistance);
+        }
+
+        // The visible part of the sky in each direction is approximated by 1 - sin(horizon angle)
+        uint16_t* horizonSines = m_horizonSines.data() + (directionIndex * m_depth + z) * m_width;
+
+        for (std::size_t x = beginX; x < endX; ++x) {
+          const float horizonTangent = horizonTangents[x];
+          const float horizonSine    = horizonTangent / std::sqrt(1.f + horizonTangent * horizonTangent);
+
+          skyVisibilities[x] += 1.f - horizonSine;
+          horizonSines[x]     = static_cast<uint16_t>(std::lround(horizonSine * horizonSineScale));
+        }
+      }
+
+      const float invDirectionCount = 1.f / static_cast<float>(m_horizonDirectionCount);
+
+      for (std::size_t x = beginX; x < endX; ++x)
+        ambientOcclusionData[z * m_width + x] = static_cast<uint8_t>(skyVisibilities[x] * invDirectionCount * 255.f);
+    }
+  }, m_taskCount);
+
+  computeSunVisibility(beginX, beginZ, endX, endZ);
+}
+
+void StaticTerrain::computeSunVisibility(unsigned int beginX, unsigned int beginZ, unsigned int endX, unsigned int endZ) {
+  ZoneScopedN("StaticTerrain::computeSunVisibility");
+
+  constexpr float twoPi = 2.f * Raz::Pi<float>;
+
+  // The horizon is looked at toward the sun, which is opposite to the direction its light travels in
+  const Raz::Vec3f sunDir         = m_sunDirection * -1.f;
+  const float sunHorizontalLength = Raz::Vec2f(sunDir.x(), sunDir.z()).computeLength();
+  const float sunTangent          = (sunHorizontalLength > std::numeric_limits<float>::epsilon() ? sunDir.y() / sunHorizontalLength
+                                                                                                 : (sunDir.y() > 0.f ? std::numeric_limits<float>::max()
+                                                                                                                     : std::numeric_limits<float>::lowest()));
+
+  // Finding the two baked directions surrounding the sun's, between which the horizons are interpolated
+  const std::size_t directionStride = horizonDirections.size() / m_horizonDirectionCount;
+  const auto computeDirectionAngle = [directionStride] (std::size_t directionIndex) {
+    const auto [directionX, directionZ] = horizonDirections[directionIndex * directionStride];
+    const float angle = std::atan2(static_cast<float>(directionZ), static_cast<float>(directionX));
+    return (angle < 0.f ? angle + twoPi : angle);
+  };
+
+  float sunAngle = std::atan2(sunDir.z(), sunDir.x());
+  sunAngle       = (sunAngle < 0.f ? sunAngle + twoPi : sunAngle);
+
+  std::size_t firstDirectionIndex  = 0;
+  std::size_t secondDirectionIndex = 0;
+  float directionCoeff {};
+
+  for (std::size_t directionIndex = 0; directionIndex < m_horizonDirectionCount; ++directionIndex) {
+    const std::size_t nextDirectionIndex = (directionIndex + 1) % m_horizonDirectionCount;
+    const float directionAngle = computeDirectionAngle(directionIndex);
+    const float nextDirectionAngle = (nextDirectionIndex == 0 ? twoPi : computeDirectionAngle(nextDirectionIndex));
+
+    if (sunAngle >= directionAngle && sunAngle < nextDirectionAngle) {
+      firstDirectionIndex  = directionIndex;
+      secondDirectionIndex = nextDirectionIndex;
+      directionCoeff       = (sunAngle - directionAngle) / (nextDirectionAngle - directionAngle);
+      break;
+    }
+  }
+
+  auto* sunVisibilityData = static_cast<uint8_t*>(m_sunVisibilityMap.getDataPtr());
+
+  Raz::Threading::parallelize(beginZ, endZ, [this, beginX, endX, sunTangent, firstDirectionIndex, secondDirectionIndex, directionCoeff,
+                                             sunVisibilityData] (const Raz::Threading::IndexRange& range) noexcept {
+    ZoneScopedN("StaticTerrain::computeSunVisibility");
+
+    for (std::size_t z = range.beginIndex; z < range.endIndex; ++z) {
+      if (isCancelled())
+        return;
+
+      const uint16_t* firstHorizonSines  = m_horizonSines.data() + (firstDirectionIndex * m_depth + z) * m_width;
+      const uint16_t* secondHorizonSines = m_horizonSines.data() + (secondDirectionIndex * m_depth + z) * m_width;
+
+      for (std::size_t x = beginX; x < endX; ++x) {
+        const float horizonTangent = Raz::MathUtils::lerp(decodeHorizonTangent(firstHorizonSines[x]), decodeHorizonTangent(secondHorizonSines[x]),
+                                                          directionCoeff);
+        const float sunVisibility  = std::clamp((sunTangent - horizonTangent) / (2.f * sunPenumbraTangent) + 0.5f, 0.f, 1.f);
+
+        sunVisibilityData[z * m_width + x] = static_cast<uint8_t>(sunVisibility * 255.f);
+      }
+    }
+  }, m_taskCount);
+}
+
+void StaticTerrain::uploadColorMap() {
+  ZoneScopedN("StaticTerrain::uploadColorMap");
+
+  if (!m_entity.hasComponent<Raz::MeshRenderer>())
+    return;
+
+  // The texture is created on the first upload & only has its data replaced afterward
+  if (m_colorTexture == nullptr) {
+    m_colorTexture = Raz::Texture2D::create(m_colorMap, true, true);
+    m_entity.getComponent<Raz::MeshRenderer>().getMaterials().front().getProgram().setTexture(m_colorTexture, Raz::MaterialTexture::BaseColor);
+  } else {
+    m_colorTexture->load(m_colorMap, true, true);
+  }
+
+  // Textures being created with mipmaps, they take a third more memory than their base level
+  m_colorTextureByteCount = static_cast<std::size_t>(m_colorMap.getWidth()) * m_colorMap.getHeight() * 3 * 4 / 3;
+}
+
+void StaticTerrain::uploadHorizonMaps() {
+  ZoneScopedN("StaticTerrain::uploadHorizonMaps");
+
+  if (!m_entity.hasComponent<Raz::MeshRenderer>())
+    return;
+
+  // Both textures have been bound to the material on construction; only their data is replaced
+  m_ambientOcclusionTexture->load(m_ambientOcclusionMap, true);
+  m_sunVisibilityTexture->load(m_sunVisibilityMap, true);
+
+  m_ambientOcclusionTextureByteCount = static_cast<std::size_t>(m_width) * m_depth * 4 / 3;
+  m_sunVisibilityTextureByteCount    = static_cast<std::size_t>(m_width) * m_depth * 4 / 3;
+}
+
+void StaticTerrain::launchPendingRegeneration(std::vector<float> heights) {
+  // Only one job runs at a time, so that a worker never competes with another for the cores & each request does not copy the heights
+  if (m_regenerationJob != nullptr || !m_pendingRegeneration.has_value())
+    return;
+
+  ZoneScopedN("StaticTerrain::launchPendingRegeneration");
+
+  const PendingRegeneration pendingRegeneration = *m_pendingRegeneration;
+  m_pendingRegeneration.reset();
+
+  RegenerationJob& job = createRegenerationJob();
+  job.request = pendingRegeneration;
+
+  if (pendingRegeneration.isGenerationRequested) {
+    launchRegeneration(job, [pendingRegeneration] (StaticTerrain& stagingTerrain) {
+      stagingTerrain.generate(pendingRegeneration.width, pendingRegeneration.depth, pendingRegeneration.heightFactor, pendingRegeneration.flatness);
+    });
+
+    return;
+  }
+
+  job.terrain.m_width = m_width;
+  job.terrain.m_depth = m_depth;
+  job.terrain.Terrain::setParameters(m_heightFactor, m_flatness);
+  job.terrain.m_entity.getComponent<Raz::Mesh>().getSubmeshes().resize(1);
+
+  // The heights are copied here unless given, so that the worker never reads the rendered terrain, which remains free to be modified or released meanwhile
+  const std::vector<Raz::Vertex>& vertices = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getVertices();
+
+  if (!heights.empty()) {
+    job.terrain.m_heights = std::move(heights);
+  } else if (vertices.empty()) {
+    job.terrain.m_heights = m_heights;
+  } else {
+    std::vector<float>& stagingHeights = job.terrain.m_heights;
+    stagingHeights.resize(vertices.size());
+
+    Raz::Threading::parallelize(0, vertices.size(), [&vertices, &stagingHeights] (const Raz::Threading::IndexRange& range) noexcept {
+      ZoneScopedN("StaticTerrain::launchPendingRegeneration");
+
+      for (std::size_t i = range.beginIndex; i < range.endIndex; ++i)
+        stagingHeights[i] = vertices[i].position.y();
+    }, m_taskCount);
+  }
+
+  launchRegeneration(job, [heightFactor = pendingRegeneration.heightFactor, flatness = pendingRegeneration.flatness] (StaticTerrain& stagingTerrain) {
+    stagingTerrain.setParameters(heightFactor, flatness);
+  });
+}
+
+void StaticTerrain::completeRegenerations() {
+  // Swapping a job launches the pending one, which is then waited for in turn
+  while (m_regenerationJob != nullptr) {
+    ZoneScopedN("StaticTerrain::completeRegenerations");
+
+    m_regenerationJob->result.wait();
+    swapRegeneratedBuffers();
+  }
+}
+
+void StaticTerrain::cancelRegenerations() noexcept {
+  // The worker checking for a cancellation within its loops, it stops shortly after; the future returned by std::async waits for it on destruction
+  if (m_regenerationJob != nullptr) {
+    ZoneScopedN("StaticTerrain::cancelRegenerations");
+
+    m_regenerationJob->isCancelled = true;
+    m_regenerationJob.reset();
+  }
+
+  m_pendingRegeneration.reset();
+}
+
+bool StaticTerrain::isRegenerationOutdated(const StaticTerrain& stagingTerrain) const noexcept {
+  if (stagingTerrain.m_meshingMode != m_meshingMode || stagingTerrain.m_maxMeshError != m_maxMeshError)
+    return true;
+
+  if (m_areHorizonMapsBaked && (!stagingTerrain.m_areHorizonMapsBaked
+                             || stagingTerrain.m_horizonDirectionCount != m_horizonDirectionCount
+                             || stagingTerrain.m_sunDirection != m_sunDirection))
+    return true;
+
+  // A map first computed on this terrain while regenerating is missing from the regenerated one
+  if (!m_colorMap.isEmpty() && (stagingTerrain.m_colorMap.isEmpty() || stagingTerrain.m_biomeTableRevision != m_biomeTableRevision))
+    return true;
+
+  return ((!m_normalMap.isEmpty() && stagingTerrain.m_normalMap.isEmpty()) || (!m_slopeMap.isEmpty() && stagingTerrain.m_slopeMap.isEmpty()));
+}
+
+StaticTerrain::RegenerationJob& StaticTerrain::createRegenerationJob() {
+  m_regenerationJob = std::make_unique<RegenerationJob>();
+
+  StaticTerrain& stagingTerrain = m_regenerationJob->terrain;
+  stagingTerrain.m_cancellationFlag      = &m_regenerationJob->isCancelled;
+  stagingTerrain.m_noiseFactor           = m_noiseFactor;
+  stagingTerrain.m_octaveCount           = m_octaveCount;
+  stagingTerrain.m_noiseGraphEvaluator   = m_noiseGraphEvaluator;
+  stagingTerrain.m_slopeMapFormat        = m_slopeMapFormat;
+  stagingTerrain.m_meshingMode           = m_meshingMode;
+  stagingTerrain.m_maxMeshError          = m_maxMeshError;
+  stagingTerrain.m_biomeTable            = m_biomeTable;
+  stagingTerrain.m_biomeTableRevision    = m_biomeTableRevision;
+  stagingTerrain.m_horizonDirectionCount = m_horizonDirectionCount;
+  stagingTerrain.m_sunDirection          = m_sunDirection;
+
+  // Leaving a thread free for the rendering to go on meanwhile
+  stagingTerrain.m_taskCount = std::max(m_taskCount, static_cast<std::size_t>(2)) - 1;
+
+  return *m_regenerationJob;
+}
+
+template <typename GenerationFuncT>
+void StaticTerrain::launchRegeneration(RegenerationJob& job, GenerationFuncT&& generationFunc) {
+  const bool shouldBakeHorizonMaps  = m_areHorizonMapsBaked;
+  const bool shouldComputeColorMap  = !m_colorMap.isEmpty();
+  const bool shouldComputeNormalMap = !m_normalMap.isEmpty();
+  const bool shouldComputeSlopeMap  = !m_slopeMap.isEmpty();
+  // The current indices being kept when only the parameters change, they must be computed again if they have been released
+  const bool shouldComputeIndices   = m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getTriangleIndices().empty();
+
+  job.result = std::async(std::launch::async, [&job, generationFunc = std::forward<GenerationFuncT>(generationFunc), callbacks = m_regenerationCallbacks,
+                                               shouldBakeHorizonMaps, shouldComputeColorMap, shouldComputeNormalMap, shouldComputeSlopeMap,
+                                               shouldComputeIndices] () {
+    ZoneScopedN("StaticTerrain::launchRegeneration");
+
+    StaticTerrain& stagingTerrain = job.terrain;
+    generationFunc(stagingTerrain);
+
+    // Checking for a cancellation between each stage, as the job would be discarded anyway
+    if (job.isCancelled)
+      return;
+
+    if (shouldBakeHorizonMaps)
+      stagingTerrain.bakeHorizonMaps(stagingTerrain.m_sunDirection);
+
+    if (job.isCancelled)
+      return;
+
+    // The slope map is computed before the color map, which reads it
+    if (shouldComputeSlopeMap)
+      stagingTerrain.computeSlopeMap();
+
+    if (job.isCancelled)
+      return;
+
+    if (shouldComputeColorMap)
+      stagingTerrain.computeColorMap();
+
+    if (job.isCancelled)
+      return;
+
+    if (shouldComputeNormalMap)
+      stagingTerrain.computeNormalMap();
+
+    if (job.isCancelled)
+      return;
+
+    if (shouldComputeIndices && stagingTerrain.m_entity.getComponent<Raz::Mesh>().getSubmeshes().front().getTriangleIndices().empty())
+      stagingTerrain.computeIndices();
+
+    // The heights the terrain may have been built from are outdated once its parameters have changed
+    stagingTerrain.copyHeights();
+
+    for (const RegenerationCallback& callback : callbacks) {
+      if (job.isCancelled)
+        return;
+
+      job.callbackResults.push_back(callback(stagingTerrain));
+    }
+  });
+}
+
+StaticTerrain::~StaticTerrain() {
+  // The job's worker must be done before its terrain is destroyed
+  cancelRegenerations();
 }
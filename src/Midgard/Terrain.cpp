@@ -6,13 +6,16 @@
 #include <RaZ/Render/MeshRenderer.hpp>
 #include <RaZ/Utils/Logger.hpp>
 
-Terrain::Terrain(Raz::Entity& entity) : m_entity{ entity } {
+Terrain::Terrain(Raz::Entity& entity, bool isRenderable) : m_entity{ entity } {
   if (!m_entity.hasComponent<Raz::Transform>())
     m_entity.addComponent<Raz::Transform>();
 
   if (!m_entity.hasComponent<Raz::Mesh>())
     m_entity.addComponent<Raz::Mesh>();
 
+  if (!isRenderable)
+    return;
+
   if (!m_entity.hasComponent<Raz::MeshRenderer>())
     m_entity.addComponent<Raz::MeshRenderer>();
 
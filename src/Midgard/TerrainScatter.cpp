@@ -0,0 +1,499 @@
+#include "Midgard/StaticTerrain.hpp"
+#include "Midgard/TerrainScatter.hpp"
+
+#include <RaZ/Math/MathUtils.hpp>
+#include <RaZ/Render/RenderGraph.hpp>
+#include <RaZ/Render/Renderer.hpp>
+#include <RaZ/Utils/Logger.hpp>
+#include <RaZ/Utils/Threading.hpp>
+
+#include <tracy/Tracy.hpp>
+#if defined(USE_OPENGL_ES)
+#include <GLES3/gl3.h>
+#else
+#include <GL/glew.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+constexpr std::string_view instanceVertShaderSource = {
+#include "scatter_instance.vert.embed"
+};
+
+constexpr std::string_view instanceFragShaderSource = {
+#include "scatter_instance.frag.embed"
+};
+
+constexpr std::string_view compositeShaderSource = {
+#include "scatter_composite.frag.embed"
+};
+
+constexpr float twoPi = 6.28318530718f;
+
+// The rotation & scale are read together as a single per-instance attribute
+static_assert(offsetof(ScatterInstance, scale) == offsetof(ScatterInstance, rotation) + sizeof(float));
+
+/// Hashes integer coordinates into pseudo-random bits; the same coordinates always give the same value.
+constexpr uint32_t hashCoordinates(uint32_t x, uint32_t z, uint32_t seed) noexcept {
+  uint32_t hash = (x * 0x8DA6B343u) ^ (z * 0xD8163841u) ^ (seed * 0xCB1AB31Fu);
+  hash ^= hash >> 16u;
+  hash *= 0x7FEB352Du;
+  hash ^= hash >> 15u;
+  hash *= 0x846CA68Bu;
+  hash ^= hash >> 16u;
+  return hash;
+}
+
+/// Converts pseudo-random bits into a float between 0 & 1.
+constexpr float computeUnitFloat(uint32_t bits) noexcept {
+  return static_cast<float>(bits >> 8u) / 16777216.f;
+}
+
+} // namespace
+
+TerrainScatter::TerrainScatter(Raz::RenderGraph& renderGraph, const Raz::Texture2DPtr& depthBuffer, const Raz::Texture2DPtr& colorBuffer)
+  : m_compositePass{ &renderGraph.addNode(Raz::FragmentShader::loadFromSource(compositeShaderSource), "Scatter composite") } {
+  ZoneScopedN("TerrainScatter::TerrainScatter");
+
+  m_instanceProgram = std::make_unique<Raz::RenderShaderProgram>();
+  m_instanceProgram->setVertexShader(Raz::VertexShader::loadFromSource(instanceVertShaderSource));
+  m_instanceProgram->setFragmentShader(Raz::FragmentShader::loadFromSource(instanceFragShaderSource));
+  m_instanceProgram->link();
+
+  const unsigned int sceneWidth  = depthBuffer->getWidth();
+  const unsigned int sceneHeight = depthBuffer->getHeight();
+
+  m_instanceDepthBuffer  = Raz::Texture2D::create(sceneWidth, sceneHeight, Raz::TextureColorspace::DEPTH);
+  m_instanceColorBuffer  = Raz::Texture2D::create(sceneWidth, sceneHeight, Raz::TextureColorspace::RGB);
+  m_compositeDepthBuffer = Raz::Texture2D::create(sceneWidth, sceneHeight, Raz::TextureColorspace::GRAY, Raz::TextureDataType::FLOAT32);
+  m_compositeColorBuffer = Raz::Texture2D::create(sceneWidth, sceneHeight, Raz::TextureColorspace::RGB);
+
+#if !defined(USE_OPENGL_ES)
+  if (Raz::Renderer::checkVersion(4, 3)) {
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_instanceDepthBuffer->getIndex(), "Scatter depth buffer");
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_instanceColorBuffer->getIndex(), "Scatter color buffer");
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_compositeDepthBuffer->getIndex(), "Scatter composite depth buffer");
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_compositeColorBuffer->getIndex(), "Scatter composite color buffer");
+  }
+#endif
+
+  // The instances being drawn outside of the render graph, their buffers are attached to a framebuffer of their own
+  glGenFramebuffers(1, &m_framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_instanceDepthBuffer->getIndex(), 0);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_instanceColorBuffer->getIndex(), 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  // The merged depth is written as a color, the passes reading it only sampling its first channel like they would a depth buffer's
+  m_compositePass->addReadTexture(depthBuffer, "uniSceneBuffers.depth");
+  m_compositePass->addReadTexture(colorBuffer, "uniSceneBuffers.color");
+  m_compositePass->addReadTexture(m_instanceDepthBuffer, "uniInstanceBuffers.depth");
+  m_compositePass->addReadTexture(m_instanceColorBuffer, "uniInstanceBuffers.color");
+  m_compositePass->addWriteColorTexture(m_compositeColorBuffer, 0);
+  m_compositePass->addWriteColorTexture(m_compositeDepthBuffer, 1);
+
+  renderGraph.getGeometryPass().addChildren(*m_compositePass);
+}
+
+void TerrainScatter::setCellSize(unsigned int cellSize) {
+  if (cellSize == 0) {
+    Raz::Logger::warn("[TerrainScatter] The cell size can't be 0; remapping to 1.");
+    cellSize = 1;
+  }
+
+  m_cellSize = cellSize;
+}
+
+void TerrainScatter::enable(bool enabled) noexcept {
+  m_isEnabled = enabled;
+
+  // Without any instance to merge, the scene's buffers are left as is & nothing has to be executed
+  if (m_compositePass != nullptr)
+    m_compositePass->enable(m_isEnabled);
+}
+
+std::size_t TerrainScatter::getInstanceCount() const noexcept {
+  std::size_t instanceCount = 0;
+
+  for (const ScatterLayer& layer : m_layers)
+    instanceCount += layer.instances.size();
+
+  return instanceCount;
+}
+
+std::size_t TerrainScatter::getVisibleInstanceCount() const noexcept {
+  std::size_t instanceCount = 0;
+
+  for (const ScatterLayer& layer : m_layers)
+    instanceCount += layer.visibleInstances.size();
+
+  return instanceCount;
+}
+
+void TerrainScatter::setSunDirection(const Raz::Vec3f& sunDirection) {
+  ZoneScopedN("TerrainScatter::setSunDirection");
+
+  if (m_instanceProgram == nullptr)
+    return;
+
+  m_instanceProgram->setAttribute(sunDirection, "uniSunDir");
+  m_instanceProgram->sendAttributes();
+}
+
+void TerrainScatter::addLayer(const Raz::Mesh& prototype, const ScatterRule& rule) {
+  ZoneScopedN("TerrainScatter::addLayer");
+
+  if (prototype.getSubmeshes().empty())
+    throw std::invalid_argument("[TerrainScatter] The prototype mesh must have at least one submesh.");
+
+  ScatterLayer& layer = m_layers.emplace_back();
+  layer.rule         = rule;
+  layer.rule.spacing = std::max(rule.spacing, 0.01f);
+
+  if (m_compositePass != nullptr)
+    uploadPrototype(layer, prototype.getSubmeshes().front());
+}
+
+std::function<void()> TerrainScatter::preparePlacement(StaticTerrain& terrain) {
+  ZoneScopedN("TerrainScatter::preparePlacement");
+
+  const auto startTime = std::chrono::steady_clock::now();
+
+  if (terrain.getSlopeMap().isEmpty())
+    terrain.computeSlopeMap();
+
+  // Recovering the mapping between the terrain's grid & world coordinates, to find the cells around the camera
+  const Raz::Vec3f originPos = terrain.computePosition(0.f, 0.f);
+  const Raz::Vec2f gridOrigin(originPos.x(), originPos.z());
+  const float gridScale = terrain.computePosition(1.f, 0.f).x() - originPos.x();
+
+  const unsigned int cellCountX = (terrain.getWidth() + m_cellSize - 1) / m_cellSize;
+  const unsigned int cellCountZ = (terrain.getDepth() + m_cellSize - 1) / m_cellSize;
+
+  std::vector<LayerPlacement> layerPlacements;
+  layerPlacements.reserve(m_layers.size());
+
+  for (const ScatterLayer& layer : m_layers)
+    layerPlacements.emplace_back(placeLayer(terrain, layer.rule, cellCountX, cellCountZ));
+
+  const std::chrono::duration<float> placementTime = std::chrono::steady_clock::now() - startTime;
+
+  return [this, gridOrigin, gridScale, cellCountX, cellCountZ, layerPlacements = std::move(layerPlacements), placementTime] () mutable {
+    ZoneScopedN("TerrainScatter::applyPlacement");
+
+    m_gridOrigin = gridOrigin;
+    m_gridScale  = gridScale;
+    m_cellCountX = cellCountX;
+    m_cellCountZ = cellCountZ;
+
+    for (std::size_t layerIndex = 0; layerIndex < layerPlacements.size(); ++layerIndex) {
+      ScatterLayer& layer = m_layers[layerIndex];
+      layer.instances = std::move(layerPlacements[layerIndex].instances);
+      layer.cells     = std::move(layerPlacements[layerIndex].cells);
+
+      // Forcing the visible instances to be gathered again on the next update
+      layer.visibleCellKeys.clear();
+      layer.visibleCellKeys.emplace_back(std::numeric_limits<uint64_t>::max());
+    }
+
+    Raz::Logger::debug("[TerrainScatter] Placed " + std::to_string(getInstanceCount()) + " instances in "
+                     + std::to_string(placementTime.count() * 1000.f) + " ms.");
+  };
+}
+
+void TerrainScatter::update(const Raz::Vec3f& cameraPos) {
+  ZoneScopedN("TerrainScatter::update");
+
+  if (m_cellCountX == 0 || m_cellCountZ == 0)
+    return;
+
+  // Only the cells overlapping the square around the camera are visited; the cost is thus independent of the terrain's size
+
+  const float cellWorldSize = static_cast<float>(m_cellSize) * m_gridScale;
+  const Raz::Vec2f cameraGridPos = (Raz::Vec2f(cameraPos.x(), cameraPos.z()) - m_gridOrigin) / cellWorldSize;
+  const float cellViewDistance   = m_viewDistance / cellWorldSize;
+
+  const auto computeCellRange = [cellViewDistance] (float cameraCellPos, unsigned int cellCount) {
+    const float firstCell = std::clamp(std::floor(cameraCellPos - cellViewDistance), 0.f, static_cast<float>(cellCount));
+    const float lastCell  = std::clamp(std::floor(cameraCellPos + cellViewDistance) + 1.f, 0.f, static_cast<float>(cellCount));
+    return std::make_pair(static_cast<unsigned int>(firstCell), static_cast<unsigned int>(lastCell));
+  };
+
+  const auto [firstCellX, endCellX] = computeCellRange(cameraGridPos.x(), m_cellCountX);
+  const auto [firstCellZ, endCellZ] = computeCellRange(cameraGridPos.y(), m_cellCountZ);
+
+  const float squaredViewDistance = m_viewDistance * m_viewDistance;
+  std::vector<uint64_t> visibleCellKeys;
+
+  for (ScatterLayer& layer : m_layers) {
+    visibleCellKeys.clear();
+
+    for (unsigned int cellZ = firstCellZ; cellZ < endCellZ; ++cellZ) {
+      for (unsigned int cellX = firstCellX; cellX < endCellX; ++cellX) {
+        const uint64_t cellKey = computeCellKey(cellX, cellZ);
+        const auto cellIter    = layer.cells.find(cellKey);
+
+        if (cellIter == layer.cells.end())
+          continue;
+
+        // Checking the distance to the closest point of the cell's bounds
+        const CellRange& cell = cellIter->second;
+        const float closestX  = std::clamp(cameraPos.x(), cell.minPos.x(), cell.maxPos.x());
+        const float closestZ  = std::clamp(cameraPos.z(), cell.minPos.y(), cell.maxPos.y());
+        const float distX     = closestX - cameraPos.x();
+        const float distZ     = closestZ - cameraPos.z();
+
+        if (distX * distX + distZ * distZ <= squaredViewDistance)
+          visibleCellKeys.emplace_back(cellKey);
+      }
+    }
+
+    if (visibleCellKeys == layer.visibleCellKeys)
+      continue;
+
+    std::swap(layer.visibleCellKeys, visibleCellKeys);
+    gatherVisibleInstances(layer);
+  }
+}
+
+void TerrainScatter::render(const Raz::Mat4f& viewProjMatrix) {
+  ZoneScopedN("TerrainScatter::render");
+
+  if (m_compositePass == nullptr || !m_isEnabled)
+    return;
+
+  // The instances are drawn between two of RaZ's frames; the viewport it relies on is restored afterward
+  std::array<GLint, 4> viewport {};
+  glGetIntegerv(GL_VIEWPORT, viewport.data());
+
+  glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+  glViewport(0, 0, static_cast<GLsizei>(m_instanceDepthBuffer->getWidth()), static_cast<GLsizei>(m_instanceDepthBuffer->getHeight()));
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  m_instanceProgram->setAttribute(viewProjMatrix, "uniViewProjMatrix");
+
+  // The buffers are cleared even without any visible instance, so that none remains merged with the scene
+  for (ScatterLayer& layer : m_layers) {
+    if (layer.visibleInstances.empty())
+      continue;
+
+    if (!layer.areVisibleInstancesUploaded)
+      uploadVisibleInstances(layer);
+
+    m_instanceProgram->setAttribute(layer.rule.color, "uniBaseColor");
+    m_instanceProgram->sendAttributes();
+
+    // A single draw call per layer, the prototype being repeated for each of the visible instances
+    glBindVertexArray(layer.vertexArray);
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(layer.prototypeIndexCount), GL_UNSIGNED_INT, nullptr,
+                            static_cast<GLsizei>(layer.visibleInstances.size()));
+  }
+
+  glBindVertexArray(0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void TerrainScatter::resizeBuffers(unsigned int width, unsigned int height) {
+  ZoneScopedN("TerrainScatter::resizeBuffers");
+
+  if (m_compositePass == nullptr)
+    return;
+
+  m_instanceDepthBuffer->resize(width, height);
+  m_instanceColorBuffer->resize(width, height);
+  m_compositeDepthBuffer->resize(width, height);
+  m_compositeColorBuffer->resize(width, height);
+}
+
+TerrainScatter::~TerrainScatter() {
+  ZoneScopedN("TerrainScatter::~TerrainScatter");
+
+  for (const ScatterLayer& layer : m_layers) {
+    if (layer.vertexArray == 0)
+      continue;
+
+    const std::array<GLuint, 3> buffers = { layer.vertexBuffer, layer.indexBuffer, layer.instanceBuffer };
+    glDeleteBuffers(static_cast<GLsizei>(buffers.size()), buffers.data());
+    glDeleteVertexArrays(1, &layer.vertexArray);
+  }
+
+  if (m_framebuffer != 0)
+    glDeleteFramebuffers(1, &m_framebuffer);
+}
+
+TerrainScatter::LayerPlacement TerrainScatter::placeLayer(const StaticTerrain& terrain, const ScatterRule& rule,
+                                                          unsigned int cellCountX, unsigned int cellCountZ) const {
+  ZoneScopedN("TerrainScatter::placeLayer");
+
+  const float invHeightFactor = 1.f / terrain.getHeightFactor();
+  const auto maxSampleX = static_cast<float>(terrain.getWidth() - 1);
+  const auto maxSampleZ = static_cast<float>(terrain.getDepth() - 1);
+
+  // Each cell is a tile sampled independently from the others; instances are thus naturally grouped by cell
+  std::vector<std::vector<ScatterInstance>> cellInstances(static_cast<std::size_t>(cellCountX) * cellCountZ);
+
+  Raz::Threading::parallelize(0, cellInstances.size(), [&] (const Raz::Threading::IndexRange& range) noexcept {
+    ZoneScopedN("TerrainScatter::placeLayer");
+
+    for (std::size_t cellIndex = range.beginIndex; cellIndex < range.endIndex; ++cellIndex) {
+      const auto cellStartX = static_cast<float>((cellIndex % cellCountX) * m_cellSize);
+      const auto cellStartZ = static_cast<float>((cellIndex / cellCountX) * m_cellSize);
+      const float cellEndX  = std::min(cellStartX + static_cast<float>(m_cellSize), maxSampleX);
+      const float cellEndZ  = std::min(cellStartZ + static_cast<float>(m_cellSize), maxSampleZ);
+
+      // Jittered grid sampling: each sample is randomly moved inside the central half of its own stratum, so that two of them
+      //  are at least half the spacing apart, while avoiding the regular patterns of a plain grid. A stratum belongs to the cell
+      //  containing its origin, so that no stratum is sampled twice
+      const auto firstStratumX = static_cast<uint32_t>(std::ceil(cellStartX / rule.spacing));
+      const auto firstStratumZ = static_cast<uint32_t>(std::ceil(cellStartZ / rule.spacing));
+      const auto endStratumX   = static_cast<uint32_t>(std::ceil(cellEndX / rule.spacing));
+      const auto endStratumZ   = static_cast<uint32_t>(std::ceil(cellEndZ / rule.spacing));
+
+      std::vector<ScatterInstance>& instances = cellInstances[cellIndex];
+
+      for (uint32_t stratumZ = firstStratumZ; stratumZ < endStratumZ; ++stratumZ) {
+        for (uint32_t stratumX = firstStratumX; stratumX < endStratumX; ++stratumX) {
+          const uint32_t hash = hashCoordinates(stratumX, stratumZ, rule.seed);
+
+          if (computeUnitFloat(hash) >= rule.density)
+            continue;
+
+          const float sampleX = (static_cast<float>(stratumX) + 0.25f + computeUnitFloat(hashCoordinates(hash, 1, rule.seed)) * 0.5f) * rule.spacing;
+          const float sampleZ = (static_cast<float>(stratumZ) + 0.25f + computeUnitFloat(hashCoordinates(hash, 2, rule.seed)) * 0.5f) * rule.spacing;
+
+          if (sampleX > maxSampleX || sampleZ > maxSampleZ)
+            continue;
+
+          const float slopeStrength = terrain.recoverSlopeStrength(static_cast<unsigned int>(sampleX + 0.5f), static_cast<unsigned int>(sampleZ + 0.5f));
+
+          if (slopeStrength < rule.minSlope || slopeStrength > rule.maxSlope)
+            continue;
+
+          const Raz::Vec3f position = terrain.computePosition(sampleX, sampleZ);
+          const float relativeHeight = position.y() * invHeightFactor;
+
+          if (relativeHeight < rule.minHeight || relativeHeight > rule.maxHeight)
+            continue;
+
+          ScatterInstance& instance = instances.emplace_back();
+          instance.position = position;
+          instance.rotation = computeUnitFloat(hashCoordinates(hash, 3, rule.seed)) * twoPi;
+          instance.scale    = Raz::MathUtils::lerp(rule.minScale, rule.maxScale, computeUnitFloat(hashCoordinates(hash, 4, rule.seed)));
+        }
+      }
+    }
+  });
+
+  // Concatenating the cells' instances & registering each non-empty cell in the spatial hash
+
+  LayerPlacement placement;
+
+  std::size_t instanceCount = 0;
+  for (const std::vector<ScatterInstance>& instances : cellInstances)
+    instanceCount += instances.size();
+
+  placement.instances.reserve(instanceCount);
+
+  for (std::size_t cellIndex = 0; cellIndex < cellInstances.size(); ++cellIndex) {
+    const std::vector<ScatterInstance>& instances = cellInstances[cellIndex];
+
+    if (instances.empty())
+      continue;
+
+    CellRange cell;
+    cell.firstInstanceIndex = placement.instances.size();
+    cell.instanceCount      = instances.size();
+    cell.minPos             = Raz::Vec2f(std::numeric_limits<float>::max());
+    cell.maxPos             = Raz::Vec2f(std::numeric_limits<float>::lowest());
+
+    for (const ScatterInstance& instance : instances) {
+      cell.minPos = Raz::Vec2f(std::min(cell.minPos.x(), instance.position.x()), std::min(cell.minPos.y(), instance.position.z()));
+      cell.maxPos = Raz::Vec2f(std::max(cell.maxPos.x(), instance.position.x()), std::max(cell.maxPos.y(), instance.position.z()));
+    }
+
+    placement.instances.insert(placement.instances.end(), instances.cbegin(), instances.cend());
+    placement.cells.emplace(computeCellKey(static_cast<unsigned int>(cellIndex % cellCountX), static_cast<unsigned int>(cellIndex / cellCountX)), cell);
+  }
+
+  return placement;
+}
+
+void TerrainScatter::gatherVisibleInstances(ScatterLayer& layer) {
+  ZoneScopedN("TerrainScatter::gatherVisibleInstances");
+
+  // Each cell's instances being contiguous, gathering them only takes one copy per visible cell; this is only done when the set of
+  //  visible cells changes, not every frame
+  layer.visibleInstances.clear();
+
+  for (const uint64_t cellKey : layer.visibleCellKeys) {
+    const CellRange& cell = layer.cells.at(cellKey);
+    const auto firstInstance = layer.instances.cbegin() + static_cast<std::ptrdiff_t>(cell.firstInstanceIndex);
+    layer.visibleInstances.insert(layer.visibleInstances.end(), firstInstance, firstInstance + static_cast<std::ptrdiff_t>(cell.instanceCount));
+  }
+
+  layer.areVisibleInstancesUploaded = false;
+}
+
+void TerrainScatter::uploadPrototype(ScatterLayer& layer, const Raz::Submesh& prototype) {
+  ZoneScopedN("TerrainScatter::uploadPrototype");
+
+  glGenVertexArrays(1, &layer.vertexArray);
+  glGenBuffers(1, &layer.vertexBuffer);
+  glGenBuffers(1, &layer.indexBuffer);
+  glGenBuffers(1, &layer.instanceBuffer);
+
+  glBindVertexArray(layer.vertexArray);
+
+  const std::vector<Raz::Vertex>& vertices = prototype.getVertices();
+  glBindBuffer(GL_ARRAY_BUFFER, layer.vertexBuffer);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(Raz::Vertex)), vertices.data(), GL_STATIC_DRAW);
+
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Raz::Vertex), reinterpret_cast<const void*>(offsetof(Raz::Vertex, position)));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Raz::Vertex), reinterpret_cast<const void*>(offsetof(Raz::Vertex, normal)));
+
+  const std::vector<unsigned int>& indices = prototype.getTriangleIndices();
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, layer.indexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(unsigned int)), indices.data(), GL_STATIC_DRAW);
+  layer.prototypeIndexCount = static_cast<unsigned int>(indices.size());
+
+  // The instances' attributes advance once per instance instead of once per vertex
+  glBindBuffer(GL_ARRAY_BUFFER, layer.instanceBuffer);
+  glEnableVertexAttribArray(2);
+  glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(ScatterInstance), reinterpret_cast<const void*>(offsetof(ScatterInstance, position)));
+  glVertexAttribDivisor(2, 1);
+  glEnableVertexAttribArray(3);
+  glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(ScatterInstance), reinterpret_cast<const void*>(offsetof(ScatterInstance, rotation)));
+  glVertexAttribDivisor(3, 1);
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TerrainScatter::uploadVisibleInstances(ScatterLayer& layer) {
+  ZoneScopedN("TerrainScatter::uploadVisibleInstances");
+
+  glBindBuffer(GL_ARRAY_BUFFER, layer.instanceBuffer);
+
+  // The buffer is only reallocated when growing, the visible instance count varying slightly each time the camera crosses a cell
+  if (layer.visibleInstances.size() > layer.instanceBufferCapacity) {
+    layer.instanceBufferCapacity = layer.visibleInstances.size() + layer.visibleInstances.size() / 2;
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(layer.instanceBufferCapacity * sizeof(ScatterInstance)), nullptr, GL_DYNAMIC_DRAW);
+  }
+
+  glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(layer.visibleInstances.size() * sizeof(ScatterInstance)), layer.visibleInstances.data());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  layer.areVisibleInstancesUploaded = true;
+}
@@ -0,0 +1,603 @@
+#include "Midgard/SlopeCompression.hpp"
+#include "Midgard/TerrainVirtualTexture.hpp"
+
+#include <RaZ/Entity.hpp>
+#include <RaZ/Math/PerlinNoise.hpp>
+#include <RaZ/Render/MeshRenderer.hpp>
+#include <RaZ/Render/RenderGraph.hpp>
+#include <RaZ/Render/Renderer.hpp>
+#include <RaZ/Utils/Logger.hpp>
+#include <RaZ/Utils/Threading.hpp>
+
+#include <tracy/Tracy.hpp>
+#include <GL/glew.h> // Needed by TracyOpenGL.hpp
+#include <tracy/TracyOpenGL.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <string>
+
+namespace {
+
+constexpr std::string_view virtualTextureSource = {
+#include "virtual_texture.glsl.embed"
+};
+
+constexpr std::string_view terrainShaderSource = {
+#include "terrain_virtual_texture.frag.embed"
+};
+
+constexpr std::string_view feedbackShaderSource = {
+#include "terrain_feedback.frag.embed"
+};
+
+constexpr unsigned int slotSize          = TerrainVirtualTexture::tileSize + TerrainVirtualTexture::tileBorder * 2;
+constexpr unsigned int maxTileCount      = 256; // Tiles' coordinates are written as bytes by the feedback pass
+constexpr unsigned int maxCacheTileCount = 255; // Slots' coordinates are stored as bytes in the page table
+constexpr unsigned int feedbackDivisor   = 8;   // The feedback is rendered at an eighth of the scene's resolution along each axis
+constexpr unsigned int feedbackInterval  = 2;   // Number of frames between two feedback read backs
+constexpr std::size_t maxBatchTileCount  = 16;  // Tiles generated at once; the smaller, the sooner the first ones are uploaded
+
+// Variation of the colors' brightness, adding details finer than the terrain's grid cells
+constexpr float detailAmplitude = 0.08f;
+constexpr float detailFrequency = 0.5f;
+constexpr int detailOctaveCount = 3;
+
+constexpr uint32_t computeTileId(unsigned int level, unsigned int tileX, unsigned int tileZ) noexcept {
+  return (level << 16u) | (tileZ << 8u) | tileX;
+}
+
+constexpr unsigned int recoverLevel(uint32_t tileId) noexcept { return (tileId >> 16u); }
+constexpr unsigned int recoverTileX(uint32_t tileId) noexcept { return (tileId & 255u); }
+constexpr unsigned int recoverTileZ(uint32_t tileId) noexcept { return ((tileId >> 8u) & 255u); }
+
+constexpr uint32_t computeParentId(uint32_t tileId) noexcept {
+  return computeTileId(recoverLevel(tileId) + 1, recoverTileX(tileId) / 2, recoverTileZ(tileId) / 2);
+}
+
+unsigned int computeNextPowerOfTwo(unsigned int value) noexcept {
+  unsigned int powerOfTwo = 1;
+  while (powerOfTwo < value)
+    powerOfTwo *= 2;
+  return powerOfTwo;
+}
+
+} // namespace
+
+struct TerrainVirtualTexture::TerrainSnapshot {
+  unsigned int width {};
+  unsigned int depth {};
+  float heightFactor {};
+  float invFlatness {};
+  unsigned int texelsPerCell {};
+  Raz::Image heightMap {};
+  BiomeTable biomeTable {};
+  Raz::Image ambientOcclusionMap {};
+  Raz::Image sunVisibilityMap {};
+
+  /// Computes the height at the given grid coordinates, bilinearly interpolated from the closest texels & clamped to the terrain's borders.
+  float computeHeight(float x, float z) const noexcept { return computeValue(static_cast<const float*>(heightMap.getDataPtr()), x, z); }
+  /// Computes the value of an horizon map at the given grid coordinates, between 0 & 1; if the map has not been baked, it is considered fully lit.
+  float computeHorizonValue(const Raz::Image& horizonMap, float x, float z) const noexcept {
+    return (horizonMap.isEmpty() ? 1.f : computeValue(static_cast<const uint8_t*>(horizonMap.getDataPtr()), x, z) / 255.f);
+  }
+  GeneratedTile generateTile(uint32_t tileId) const;
+
+private:
+  template <typename T>
+  float computeValue(const T* values, float x, float z) const noexcept {
+    x = std::clamp(x, 0.f, static_cast<float>(width - 1));
+    z = std::clamp(z, 0.f, static_cast<float>(depth - 1));
+
+    const auto x0 = static_cast<std::size_t>(x);
+    const auto z0 = static_cast<std::size_t>(z);
+    const std::size_t x1 = std::min(x0 + 1, static_cast<std::size_t>(width - 1));
+    const std::size_t z1 = std::min(z0 + 1, static_cast<std::size_t>(depth - 1));
+    const float xCoeff = x - static_cast<float>(x0);
+    const float zCoeff = z - static_cast<float>(z0);
+
+    const float topValue = static_cast<float>(values[z0 * width + x0]) * (1.f - xCoeff) + static_cast<float>(values[z0 * width + x1]) * xCoeff;
+    const float botValue = static_cast<float>(values[z1 * width + x0]) * (1.f - xCoeff) + static_cast<float>(values[z1 * width + x1]) * xCoeff;
+    return topValue * (1.f - zCoeff) + botValue * zCoeff;
+  }
+};
+
+TerrainVirtualTexture::GeneratedTile TerrainVirtualTexture::TerrainSnapshot::generateTile(uint32_t tileId) const {
+  ZoneScopedN("TerrainVirtualTexture::TerrainSnapshot::generateTile");
+
+  GeneratedTile tile { tileId, std::vector<uint8_t>(slotSize * slotSize * 4), std::vector<uint8_t>(slotSize * slotSize * 4) };
+
+  // Distance between two of the tile's texels, in grid cells
+  const float texelSpacing = static_cast<float>(1u << recoverLevel(tileId)) / static_cast<float>(texelsPerCell);
+  // Heights are sampled at least a cell apart to compute the slopes, which then match the slope map's at the finest levels & are filtered at the coarsest
+  const float slopeDistance  = std::max(texelSpacing, 1.f);
+  const float detailFactor   = detailAmplitude / slopeDistance;
+  const bool isMoistureUsed  = biomeTable.isMoistureUsed();
+  const float firstTexelX    = static_cast<float>(recoverTileX(tileId) * tileSize) - static_cast<float>(tileBorder) + 0.5f;
+  const float firstTexelZ    = static_cast<float>(recoverTileZ(tileId) * tileSize) - static_cast<float>(tileBorder) + 0.5f;
+
+  for (unsigned int texelZ = 0; texelZ < slotSize; ++texelZ) {
+    const float gridZ = (firstTexelZ + static_cast<float>(texelZ)) * texelSpacing;
+
+    for (unsigned int texelX = 0; texelX < slotSize; ++texelX) {
+      const float gridX = (firstTexelX + static_cast<float>(texelX)) * texelSpacing;
+
+      // Same slope strength as the slope map's, the length of the half gradient over a grid cell
+      const Raz::Vec2f heightDiffs((computeHeight(gridX - slopeDistance, gridZ) - computeHeight(gridX + slopeDistance, gridZ)) * heightFactor,
+                                   (computeHeight(gridX, gridZ - slopeDistance) - computeHeight(gridX, gridZ + slopeDistance)) * heightFactor);
+      const Raz::Vec2f cellHalfGradient = heightDiffs / (slopeDistance * 2.f);
+
+      const float moisture     = (isMoistureUsed ? biomeTable.computeMoisture(gridX, gridZ) : 0.f);
+      // Classified by the height before flattening, like the color map
+      const uint8_t* biomeData = biomeTable.classify(std::pow(computeHeight(gridX, gridZ), invFlatness), cellHalfGradient.computeLength(), moisture);
+      const float detail       = 1.f + (Raz::PerlinNoise::compute2D(gridX * detailFrequency, gridZ * detailFrequency, detailOctaveCount, true) * 2.f - 1.f) * detailFactor;
+
+      const std::size_t texelIndex = (static_cast<std::size_t>(texelZ) * slotSize + texelX) * 4;
+
+      for (std::size_t channelIndex = 0; channelIndex < 3; ++channelIndex)
+        tile.colors[texelIndex + channelIndex] = static_cast<uint8_t>(std::min(static_cast<float>(biomeData[channelIndex]) * detail, 255.f));
+      tile.colors[texelIndex + 3] = biomeData[3];
+
+      tile.surfaces[texelIndex]     = SlopeCompression::compressGradient(cellHalfGradient.x());
+      tile.surfaces[texelIndex + 1] = SlopeCompression::compressGradient(cellHalfGradient.y());
+      tile.surfaces[texelIndex + 2] = static_cast<uint8_t>(std::lround(computeHorizonValue(ambientOcclusionMap, gridX, gridZ) * 255.f));
+      tile.surfaces[texelIndex + 3] = static_cast<uint8_t>(std::lround(computeHorizonValue(sunVisibilityMap, gridX, gridZ) * 255.f));
+    }
+  }
+
+  return tile;
+}
+
+TerrainVirtualTexture::TerrainVirtualTexture(Raz::RenderGraph& renderGraph, const Raz::Texture2DPtr& depthBuffer, StaticTerrain& terrain,
+                                             unsigned int texelsPerCell, unsigned int cacheTileCount)
+  : m_terrain{ terrain },
+    m_feedbackPass{ renderGraph.addNode(Raz::FragmentShader::loadFromSource(std::string(virtualTextureSource) + std::string(feedbackShaderSource)),
+                                        "Virtual texture feedback") },
+    m_texelsPerCell{ texelsPerCell },
+    m_cacheTileCount{ cacheTileCount } {
+  ZoneScopedN("TerrainVirtualTexture::TerrainVirtualTexture");
+
+  if (m_texelsPerCell == 0) {
+    Raz::Logger::warn("[TerrainVirtualTexture] The number of texels per cell can't be 0; remapping to 1.");
+    m_texelsPerCell = 1;
+  }
+
+  if (m_cacheTileCount == 0 || m_cacheTileCount > maxCacheTileCount) {
+    Raz::Logger::warn("[TerrainVirtualTexture] The cache tile count must be between 1 & " + std::to_string(maxCacheTileCount)
+                    + "; remapping to " + std::to_string(std::clamp(m_cacheTileCount, 1u, maxCacheTileCount)) + '.');
+    m_cacheTileCount = std::clamp(m_cacheTileCount, 1u, maxCacheTileCount);
+  }
+
+  // The caches' size only depends on their number of tiles, whatever the virtual resolution
+  m_colorCache   = Raz::Texture2D::create(m_cacheTileCount * slotSize, m_cacheTileCount * slotSize, Raz::TextureColorspace::RGBA, Raz::TextureDataType::BYTE);
+  m_surfaceCache = Raz::Texture2D::create(m_cacheTileCount * slotSize, m_cacheTileCount * slotSize, Raz::TextureColorspace::RGBA, Raz::TextureDataType::BYTE);
+  m_pageTableTexture = Raz::Texture2D::create(1, 1, Raz::TextureColorspace::RGBA, Raz::TextureDataType::BYTE);
+  m_feedbackBuffer   = Raz::Texture2D::create(std::max(depthBuffer->getWidth() / feedbackDivisor, 1u),
+                                              std::max(depthBuffer->getHeight() / feedbackDivisor, 1u),
+                                              Raz::TextureColorspace::RGBA, Raz::TextureDataType::BYTE);
+
+#if !defined(USE_OPENGL_ES)
+  if (Raz::Renderer::checkVersion(4, 3)) {
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_colorCache->getIndex(), "Virtual texture color cache");
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_surfaceCache->getIndex(), "Virtual texture surface cache");
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_pageTableTexture->getIndex(), "Virtual texture page table");
+    Raz::Renderer::setLabel(Raz::RenderObjectType::TEXTURE, m_feedbackBuffer->getIndex(), "Virtual texture feedback buffer");
+  }
+#endif
+
+  m_feedbackPass.addReadTexture(depthBuffer, "uniSceneBuffers.depth");
+  m_feedbackPass.addWriteColorTexture(m_feedbackBuffer, 0);
+  m_feedbackPass.getProgram().setAttribute(static_cast<float>(feedbackDivisor), "uniFeedbackScale");
+  m_feedbackPass.enable(false);
+  renderGraph.getGeometryPass().addChildren(m_feedbackPass);
+
+  // The terrain keeps its own material, to which it uploads its maps; the virtual texture's is only selected while enabled
+  auto& meshRenderer = m_terrain.getEntity().getComponent<Raz::MeshRenderer>();
+  m_materialIndex    = meshRenderer.getMaterials().size();
+
+  Raz::RenderShaderProgram& terrainProgram = meshRenderer.addMaterial(Raz::Material(Raz::MaterialType::COOK_TORRANCE)).getProgram();
+  terrainProgram.setFragmentShader(Raz::FragmentShader::loadFromSource(std::string(virtualTextureSource) + std::string(terrainShaderSource)));
+  terrainProgram.link();
+  terrainProgram.setTexture(m_pageTableTexture, "uniVirtualTexture.pageTable");
+  terrainProgram.setTexture(m_colorCache, "uniVirtualTexture.colorCache");
+  terrainProgram.setTexture(m_surfaceCache, "uniVirtualTexture.surfaceCache");
+}
+
+void TerrainVirtualTexture::enable() {
+  m_isEnabled = true;
+  m_feedbackPass.enable(true);
+  m_terrain.getEntity().getComponent<Raz::MeshRenderer>().getSubmeshRenderers().front().setMaterialIndex(m_materialIndex);
+
+  if (m_isOutdated)
+    invalidate();
+}
+
+void TerrainVirtualTexture::disable() {
+  m_isEnabled = false;
+  m_feedbackPass.enable(false);
+  m_terrain.getEntity().getComponent<Raz::MeshRenderer>().getSubmeshRenderers().front().setMaterialIndex(0);
+}
+
+void TerrainVirtualTexture::setSunDirection(const Raz::Vec3f& sunDirection) {
+  ZoneScopedN("TerrainVirtualTexture::setSunDirection");
+
+  Raz::RenderShaderProgram& terrainProgram = m_terrain.getEntity().getComponent<Raz::MeshRenderer>().getMaterials()[m_materialIndex].getProgram();
+  terrainProgram.setAttribute(sunDirection, "uniSunDir");
+  terrainProgram.sendAttributes();
+}
+
+void TerrainVirtualTexture::resizeFeedbackBuffer(unsigned int sceneWidth, unsigned int sceneHeight) {
+  ZoneScopedN("TerrainVirtualTexture::resizeFeedbackBuffer");
+
+  m_feedbackBuffer->resize(std::max(sceneWidth / feedbackDivisor, 1u), std::max(sceneHeight / feedbackDivisor, 1u));
+}
+
+std::function<void()> TerrainVirtualTexture::prepareInvalidation(const StaticTerrain& terrain) {
+  ZoneScopedN("TerrainVirtualTexture::prepareInvalidation");
+
+  // While disabled, the terrain's data is only taken once enabled again; if it has been enabled meanwhile, it is taken from the rendered terrain
+  if (!m_isEnabled) {
+    return [this] () {
+      if (m_isEnabled)
+        invalidate();
+      else
+        m_isOutdated = true;
+    };
+  }
+
+  const unsigned int width = terrain.getWidth();
+  const unsigned int depth = terrain.getDepth();
+
+  // Tiles' coordinates being written as bytes, the finest level can't have more tiles than that per side
+  const unsigned int maxTexelsPerCell = std::max(maxTileCount * tileSize / std::max(width, depth), 1u);
+  unsigned int texelsPerCell = m_texelsPerCell;
+
+  if (texelsPerCell > maxTexelsPerCell) {
+    Raz::Logger::warn("[TerrainVirtualTexture] The number of texels per cell is too high for the terrain's size; remapping to "
+                    + std::to_string(maxTexelsPerCell) + '.');
+    texelsPerCell = maxTexelsPerCell;
+  }
+
+  // The finest level's tiles covering the whole terrain, their count is rounded up to a power of two so that each level has half as many as the previous one
+  const unsigned int tileCount = computeNextPowerOfTwo((std::max(width, depth) * texelsPerCell + tileSize - 1) / tileSize);
+  unsigned int mipCount = 1;
+  for (unsigned int levelTileCount = tileCount; levelTileCount > 1; levelTileCount /= 2)
+    ++mipCount;
+
+  auto snapshot = std::make_shared<TerrainSnapshot>();
+  snapshot->width               = width;
+  snapshot->depth               = depth;
+  snapshot->heightFactor        = terrain.getHeightFactor();
+  snapshot->invFlatness         = 1.f / terrain.getFlatness();
+  snapshot->texelsPerCell       = texelsPerCell;
+  snapshot->heightMap           = terrain.computeHeightMap();
+  snapshot->biomeTable          = terrain.getBiomeTable();
+  snapshot->ambientOcclusionMap = terrain.getAmbientOcclusionMap();
+  snapshot->sunVisibilityMap    = terrain.getSunVisibilityMap();
+
+  // The coarsest level's single tile is always resident, so that every tile has an ancestor to fall back on
+  GeneratedTile coarsestTile = snapshot->generateTile(computeTileId(mipCount - 1, 0, 0));
+
+  return [this, width, depth, texelsPerCell, tileCount, mipCount, snapshot = std::shared_ptr<const TerrainSnapshot>(std::move(snapshot)),
+          coarsestTile = std::move(coarsestTile)] () {
+    ZoneScopedN("TerrainVirtualTexture::applyInvalidation");
+
+    m_texelsPerCell = texelsPerCell;
+    m_tileCount     = tileCount;
+    m_mipCount      = mipCount;
+    m_snapshot      = snapshot;
+    m_isOutdated    = false;
+
+    // Tiles being generated from the previous snapshot are discarded once finished
+    m_residentTiles.clear();
+    m_pendingTiles.clear();
+    m_generatingTiles.clear();
+
+    m_freeSlots.resize(static_cast<std::size_t>(m_cacheTileCount) * m_cacheTileCount);
+    for (std::size_t slotIndex = 0; slotIndex < m_freeSlots.size(); ++slotIndex)
+      m_freeSlots[slotIndex] = static_cast<unsigned int>(m_freeSlots.size() - slotIndex - 1);
+
+    uploadTile(coarsestTile);
+    updatePageTable();
+
+    Raz::RenderShaderProgram& terrainProgram = m_terrain.getEntity().getComponent<Raz::MeshRenderer>().getMaterials()[m_materialIndex].getProgram();
+    terrainProgram.setAttribute(Raz::Vec2f(static_cast<float>(width * m_texelsPerCell), static_cast<float>(depth * m_texelsPerCell)), "uniVirtualSize");
+    terrainProgram.setAttribute(static_cast<int>(m_tileCount), "uniTileCount");
+    terrainProgram.setAttribute(static_cast<int>(m_mipCount), "uniMipCount");
+    terrainProgram.sendAttributes();
+
+    Raz::RenderShaderProgram& feedbackProgram = m_feedbackPass.getProgram();
+    feedbackProgram.setAttribute(Raz::Vec2f(static_cast<float>(width), static_cast<float>(depth)), "uniTerrainSize");
+    feedbackProgram.setAttribute(static_cast<float>(m_texelsPerCell), "uniTexelsPerCell");
+    feedbackProgram.setAttribute(static_cast<int>(m_mipCount), "uniMipCount");
+    feedbackProgram.sendAttributes();
+
+    Raz::Logger::debug("[TerrainVirtualTexture] Virtual resolution of " + std::to_string(getVirtualResolution()) + " texels with "
+                     + std::to_string(m_mipCount) + " mip levels.");
+  };
+}
+
+void TerrainVirtualTexture::update() {
+  ZoneScopedN("TerrainVirtualTexture::update");
+
+  if (!m_isEnabled)
+    return;
+
+  readFeedback();
+  collectGeneratedTiles();
+  launchGeneration();
+}
+
+std::vector<TerrainBufferMemory> TerrainVirtualTexture::computeMemoryUsage() const {
+  ZoneScopedN("TerrainVirtualTexture::computeMemoryUsage");
+
+  const auto computeImageByteCount = [] (const Raz::Image& image) -> std::size_t {
+    if (image.isEmpty())
+      return 0;
+
+    return static_cast<std::size_t>(image.getWidth()) * image.getHeight() * image.getChannelCount()
+         * (image.getDataType() == Raz::ImageDataType::FLOAT ? sizeof(float) : sizeof(uint8_t));
+  };
+
+  const std::size_t cacheByteCount     = static_cast<std::size_t>(m_cacheTileCount * slotSize) * (m_cacheTileCount * slotSize) * 4;
+  const std::size_t pageTableByteCount = computeImageByteCount(m_pageTable);
+  const std::size_t feedbackByteCount  = static_cast<std::size_t>(m_feedbackBuffer->getWidth()) * m_feedbackBuffer->getHeight() * 4;
+  const std::size_t snapshotByteCount  = (m_snapshot == nullptr ? 0 : computeImageByteCount(m_snapshot->heightMap)
+                                                                    + computeImageByteCount(m_snapshot->ambientOcclusionMap)
+                                                                    + computeImageByteCount(m_snapshot->sunVisibilityMap));
+
+  return {
+    { "Virtual texture color cache",      0,                  cacheByteCount },
+    { "Virtual texture surface cache",    0,                  cacheByteCount },
+    { "Virtual texture page table",       pageTableByteCount, pageTableByteCount },
+    { "Virtual texture feedback",         0,                  feedbackByteCount + m_feedbackPixelBufferByteCount },
+    { "Virtual texture terrain snapshot", snapshotByteCount,  0 }
+  };
+}
+
+TerrainVirtualTexture::~TerrainVirtualTexture() {
+  // The tiles being generated refer to the snapshot, which the batch keeps alive; its worker must simply be done before the batch is destroyed
+  if (m_generationBatch.result.valid())
+    m_generationBatch.result.wait();
+
+  if (m_feedbackFence != nullptr)
+    glDeleteSync(static_cast<GLsync>(m_feedbackFence));
+
+  if (m_feedbackPixelBuffer != 0)
+    glDeleteBuffers(1, &m_feedbackPixelBuffer);
+}
+
+void TerrainVirtualTexture::requestTiles(const uint8_t* feedbackData, std::size_t feedbackTexelCount) {
+  ZoneScopedN("TerrainVirtualTexture::requestTiles");
+
+  std::vector<uint32_t> requestedTiles;
+
+  for (std::size_t texelIndex = 0; texelIndex < feedbackTexelCount; ++texelIndex) {
+    const uint8_t* texelData = feedbackData + texelIndex * 4;
+
+    // Texels not covering the terrain are left empty
+    if (texelData[3] == 0)
+      continue;
+
+    const unsigned int level = std::min(static_cast<unsigned int>(texelData[2]), m_mipCount - 1);
+    const unsigned int levelTileCount = m_tileCount >> level;
+    requestedTiles.emplace_back(computeTileId(level, std::min(static_cast<unsigned int>(texelData[0]), levelTileCount - 1),
+                                                     std::min(static_cast<unsigned int>(texelData[1]), levelTileCount - 1)));
+  }
+
+  std::sort(requestedTiles.begin(), requestedTiles.end());
+  requestedTiles.erase(std::unique(requestedTiles.begin(), requestedTiles.end()), requestedTiles.end());
+
+  // Ancestors are requested as well, so that a coarser tile can always be sampled while a finer one is being generated
+  const std::size_t visibleTileCount = requestedTiles.size();
+  for (std::size_t tileIndex = 0; tileIndex < visibleTileCount; ++tileIndex) {
+    for (uint32_t tileId = requestedTiles[tileIndex]; recoverLevel(tileId) + 1 < m_mipCount;) {
+      tileId = computeParentId(tileId);
+      requestedTiles.emplace_back(tileId);
+    }
+  }
+
+  // Sorting in decreasing order, the tiles' identifiers starting with their level, lists the coarsest first
+  std::sort(requestedTiles.begin(), requestedTiles.end(), std::greater<>());
+  requestedTiles.erase(std::unique(requestedTiles.begin(), requestedTiles.end()), requestedTiles.end());
+
+  m_pendingTiles.clear();
+
+  for (const uint32_t tileId : requestedTiles) {
+    if (const auto residentIter = m_residentTiles.find(tileId); residentIter != m_residentTiles.end()) {
+      residentIter->second.lastFeedbackIndex = m_feedbackIndex;
+      continue;
+    }
+
+    if (std::find(m_generatingTiles.cbegin(), m_generatingTiles.cend(), tileId) == m_generatingTiles.cend())
+      m_pendingTiles.emplace_back(tileId);
+  }
+
+  // More tiles than the caches can hold would only evict each other; the finest ones are left out
+  m_pendingTiles.resize(std::min(m_pendingTiles.size(), static_cast<std::size_t>(m_cacheTileCount) * m_cacheTileCount));
+}
+
+void TerrainVirtualTexture::readFeedback() {
+  ZoneScopedN("TerrainVirtualTexture::readFeedback");
+  TracyGpuZone("TerrainVirtualTexture::readFeedback")
+
+  // RaZ wrapping neither pixel pack buffers, their mapping nor fences, those are directly handled through OpenGL
+
+  if (m_feedbackFence != nullptr) {
+    // The fence is only polled; the feedback is processed on a later frame if the copy is not done yet
+    const GLenum waitResult = glClientWaitSync(static_cast<GLsync>(m_feedbackFence), 0, 0);
+    if (waitResult != GL_ALREADY_SIGNALED && waitResult != GL_CONDITION_SATISFIED)
+      return;
+
+    glDeleteSync(static_cast<GLsync>(m_feedbackFence));
+    m_feedbackFence = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_feedbackPixelBuffer);
+    const auto* feedbackData = static_cast<const uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                                                            static_cast<GLsizeiptr>(m_feedbackPixelBufferByteCount), GL_MAP_READ_BIT));
+
+    if (feedbackData != nullptr) {
+      ++m_feedbackIndex;
+      requestTiles(feedbackData, m_feedbackPixelBufferByteCount / 4);
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return;
+  }
+
+  if (++m_frameCountSinceFeedback < feedbackInterval)
+    return;
+
+  m_frameCountSinceFeedback = 0;
+
+  if (m_feedbackPixelBuffer == 0)
+    glGenBuffers(1, &m_feedbackPixelBuffer);
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, m_feedbackPixelBuffer);
+
+  const std::size_t feedbackByteCount  = static_cast<std::size_t>(m_feedbackBuffer->getWidth()) * m_feedbackBuffer->getHeight() * 4;
+  if (feedbackByteCount != m_feedbackPixelBufferByteCount) {
+    glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(feedbackByteCount), nullptr, GL_STREAM_READ);
+    m_feedbackPixelBufferByteCount = feedbackByteCount;
+  }
+
+  // The copy into the pixel buffer is asynchronous; the fence tells once it is done, without stalling the rendering
+  m_feedbackBuffer->bind();
+  Raz::Renderer::recoverTextureData(Raz::TextureType::TEXTURE_2D, 0, Raz::TextureFormat::RGBA, Raz::PixelDataType::UBYTE, nullptr);
+  m_feedbackBuffer->unbind();
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  m_feedbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void TerrainVirtualTexture::collectGeneratedTiles() {
+  if (!m_generationBatch.result.valid() || m_generationBatch.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    return;
+
+  ZoneScopedN("TerrainVirtualTexture::collectGeneratedTiles");
+
+  const std::vector<GeneratedTile> generatedTiles = m_generationBatch.result.get();
+
+  // Tiles generated from a previous snapshot of the terrain are outdated
+  if (m_generationBatch.snapshot == m_snapshot) {
+    bool isPageTableOutdated = false;
+
+    for (const GeneratedTile& tile : generatedTiles)
+      isPageTableOutdated |= uploadTile(tile);
+
+    m_generatingTiles.clear();
+
+    if (isPageTableOutdated)
+      updatePageTable();
+  }
+
+  m_generationBatch = GenerationBatch();
+}
+
+void TerrainVirtualTexture::launchGeneration() {
+  if (m_generationBatch.result.valid() || m_pendingTiles.empty())
+    return;
+
+  ZoneScopedN("TerrainVirtualTexture::launchGeneration");
+
+  const std::size_t batchTileCount = std::min(m_pendingTiles.size(), maxBatchTileCount);
+  m_generatingTiles.assign(m_pendingTiles.cbegin(), m_pendingTiles.cbegin() + static_cast<std::ptrdiff_t>(batchTileCount));
+  m_pendingTiles.erase(m_pendingTiles.cbegin(), m_pendingTiles.cbegin() + static_cast<std::ptrdiff_t>(batchTileCount));
+
+  m_generationBatch.snapshot = m_snapshot;
+  m_generationBatch.result   = std::async(std::launch::async, [snapshot = m_snapshot, tileIds = m_generatingTiles] () {
+    ZoneScopedN("TerrainVirtualTexture::generateTiles");
+
+    std::vector<GeneratedTile> tiles(tileIds.size());
+
+    // One thread is left to the rendering, which keeps going while the tiles are generated
+    Raz::Threading::parallelize(0, tileIds.size(), [&snapshot, &tileIds, &tiles] (const Raz::Threading::IndexRange& range) noexcept {
+      for (std::size_t tileIndex = range.beginIndex; tileIndex < range.endIndex; ++tileIndex)
+        tiles[tileIndex] = snapshot->generateTile(tileIds[tileIndex]);
+    }, std::max<std::size_t>(Raz::Threading::getSystemThreadCount(), 2) - 1);
+
+    return tiles;
+  });
+}
+
+bool TerrainVirtualTexture::uploadTile(const GeneratedTile& tile) {
+  ZoneScopedN("TerrainVirtualTexture::uploadTile");
+
+  unsigned int slotIndex {};
+
+  if (!m_freeSlots.empty()) {
+    slotIndex = m_freeSlots.back();
+    m_freeSlots.pop_back();
+  } else {
+    // The least recently requested tile is evicted, unless it is still needed or is the coarsest level's
+    auto evictedIter = m_residentTiles.end();
+
+    for (auto residentIter = m_residentTiles.begin(); residentIter != m_residentTiles.end(); ++residentIter) {
+      if (recoverLevel(residentIter->first) + 1 == m_mipCount || residentIter->second.lastFeedbackIndex >= m_feedbackIndex)
+        continue;
+
+      if (evictedIter == m_residentTiles.end() || residentIter->second.lastFeedbackIndex < evictedIter->second.lastFeedbackIndex)
+        evictedIter = residentIter;
+    }
+
+    if (evictedIter == m_residentTiles.end())
+      return false;
+
+    slotIndex = evictedIter->second.slotIndex;
+    m_residentTiles.erase(evictedIter);
+  }
+
+  const unsigned int slotX = (slotIndex % m_cacheTileCount) * slotSize;
+  const unsigned int slotY = (slotIndex / m_cacheTileCount) * slotSize;
+
+  m_colorCache->bind();
+  Raz::Renderer::sendImageSubData2D(Raz::TextureType::TEXTURE_2D, 0, slotX, slotY, slotSize, slotSize,
+                                    Raz::TextureFormat::RGBA, Raz::PixelDataType::UBYTE, tile.colors.data());
+  m_surfaceCache->bind();
+  Raz::Renderer::sendImageSubData2D(Raz::TextureType::TEXTURE_2D, 0, slotX, slotY, slotSize, slotSize,
+                                    Raz::TextureFormat::RGBA, Raz::PixelDataType::UBYTE, tile.surfaces.data());
+  m_surfaceCache->unbind();
+
+  m_residentTiles[tile.tileId] = ResidentTile{ slotIndex, m_feedbackIndex };
+
+  return true;
+}
+
+void TerrainVirtualTexture::updatePageTable() {
+  ZoneScopedN("TerrainVirtualTexture::updatePageTable");
+
+  m_pageTable = Raz::Image(m_tileCount * 2 - 1, m_tileCount, Raz::ImageColorspace::RGBA);
+  auto* pageData = static_cast<uint8_t*>(m_pageTable.getDataPtr());
+
+  const auto computeEntryIndex = [this] (unsigned int level, unsigned int tileX, unsigned int tileZ) {
+    const unsigned int levelOffset = m_tileCount * 2 - ((m_tileCount * 2) >> level);
+    return (static_cast<std::size_t>(tileZ) * m_pageTable.getWidth() + levelOffset + tileX) * 4;
+  };
+
+  // Filled from the coarsest level, each tile not resident takes its parent's entry, itself either resident or inherited
+  for (unsigned int level = m_mipCount; level-- > 0;) {
+    const unsigned int levelTileCount = m_tileCount >> level;
+
+    for (unsigned int tileZ = 0; tileZ < levelTileCount; ++tileZ) {
+      for (unsigned int tileX = 0; tileX < levelTileCount; ++tileX) {
+        uint8_t* entryData = pageData + computeEntryIndex(level, tileX, tileZ);
+
+        if (const auto residentIter = m_residentTiles.find(computeTileId(level, tileX, tileZ)); residentIter != m_residentTiles.end()) {
+          entryData[0] = static_cast<uint8_t>(residentIter->second.slotIndex % m_cacheTileCount);
+          entryData[1] = static_cast<uint8_t>(residentIter->second.slotIndex / m_cacheTileCount);
+          entryData[2] = static_cast<uint8_t>(level);
+          entryData[3] = 255;
+          continue;
+        }
+
+        const uint8_t* parentData = pageData + computeEntryIndex(level + 1, tileX / 2, tileZ / 2);
+        std::copy(parentData, parentData + 4, entryData);
+      }
+    }
+  }
+
+  m_pageTableTexture->load(m_pageTable, false);
+}
@@ -0,0 +1,45 @@
+#include "Midgard/TimingHistory.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+void TimingHistory::addSample(float milliseconds) noexcept {
+  m_samples[m_nextIndex] = milliseconds;
+  m_nextIndex   = (m_nextIndex + 1) % capacity;
+  m_sampleCount = std::min(m_sampleCount + 1, capacity);
+}
+
+void TimingHistory::addSamples(const TimingHistory& history) noexcept {
+  const std::size_t firstIndex = (history.m_nextIndex + capacity - history.m_sampleCount) % capacity;
+
+  for (std::size_t sampleIndex = 0; sampleIndex < history.m_sampleCount; ++sampleIndex)
+    addSample(history.m_samples[(firstIndex + sampleIndex) % capacity]);
+}
+
+float TimingHistory::computeAverage() const noexcept {
+  if (m_sampleCount == 0)
+    return 0.f;
+
+  // While the history is not full, its samples are the first ones, the next index having not yet wrapped around
+  return std::accumulate(m_samples.cbegin(), m_samples.cbegin() + static_cast<std::ptrdiff_t>(m_sampleCount), 0.f) / static_cast<float>(m_sampleCount);
+}
+
+float TimingHistory::computePercentile(float percentile) const noexcept {
+  if (m_sampleCount == 0)
+    return 0.f;
+
+  std::array<float, capacity> sortedSamples = m_samples;
+  const auto sortedEnd = sortedSamples.begin() + static_cast<std::ptrdiff_t>(m_sampleCount);
+
+  const float rank = std::ceil(std::clamp(percentile, 0.f, 100.f) / 100.f * static_cast<float>(m_sampleCount));
+  const auto rankIter = sortedSamples.begin() + static_cast<std::ptrdiff_t>(std::max(rank, 1.f)) - 1;
+
+  std::nth_element(sortedSamples.begin(), rankIter, sortedEnd);
+  return *rankIter;
+}
+
+void TimingHistory::clear() noexcept {
+  m_sampleCount = 0;
+  m_nextIndex   = 0;
+}
@@ -0,0 +1,365 @@
+#include "Midgard/VolumetricTerrain.hpp"
+
+#include <RaZ/Entity.hpp>
+#include <RaZ/Data/Mesh.hpp>
+#include <RaZ/Math/PerlinNoise.hpp>
+#include <RaZ/Render/MeshRenderer.hpp>
+#include <RaZ/Utils/Logger.hpp>
+#include <RaZ/Utils/Threading.hpp>
+
+#include <tracy/Tracy.hpp>
+#if !defined(USE_OPENGL_ES)
+#include <GL/glew.h> // Needed by TracyOpenGL.hpp & to read the density field back
+#include <tracy/TracyOpenGL.hpp>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr float voxelSize   = 0.5f;
+constexpr float noiseFactor = 0.01f;
+constexpr uint8_t octaveCount = 4;
+
+constexpr Raz::Vec3f rockColor(0.5f, 0.45f, 0.4f);
+
+constexpr unsigned int invalidVertex = std::numeric_limits<unsigned int>::max();
+
+#if !defined(USE_OPENGL_ES)
+constexpr std::string_view noiseCompSource = {
+#include "perlin_noise_3d.comp.embed"
+};
+#endif
+
+// Corners of a cell, as offsets from its lowest corner. The index of each is made of its X, Y & Z offsets as bits, respectively 1, 2 & 4
+constexpr std::array<std::array<unsigned int, 3>, 8> cellCorners = {{
+  { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 },
+  { 0, 0, 1 }, { 1, 0, 1 }, { 0, 1, 1 }, { 1, 1, 1 }
+}};
+
+// Edges of a cell, as pairs of corner indices
+constexpr std::array<std::array<unsigned int, 2>, 12> cellEdges = {{
+  { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, // Along X
+  { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 }, // Along Y
+  { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }  // Along Z
+}};
+
+} // namespace
+
+VolumetricTerrain::VolumetricTerrain(Raz::Entity& entity, unsigned int width, unsigned int depth, float heightFactor, float flatness) : VolumetricTerrain(entity) {
+  ZoneScopedN("VolumetricTerrain::VolumetricTerrain");
+
+  VolumetricTerrain::generate(width, depth, heightFactor, flatness);
+}
+
+void VolumetricTerrain::setParameters(float heightFactor, float flatness) {
+  ZoneScopedN("VolumetricTerrain::setParameters");
+
+  // The density field depending on both parameters, the whole terrain has to be remeshed
+  generate(m_width, m_depth, heightFactor, flatness);
+}
+
+void VolumetricTerrain::setChunkSize(unsigned int chunkSize) {
+  if (chunkSize == 0) {
+    Raz::Logger::warn("[VolumetricTerrain] The chunk size can't be 0; remapping to 1.");
+    chunkSize = 1;
+  }
+
+  m_chunkSize = chunkSize;
+}
+
+void VolumetricTerrain::enableGpuDensity([[maybe_unused]] bool enabled) {
+#if !defined(USE_OPENGL_ES)
+  m_useGpuDensity = enabled;
+#else
+  Raz::Logger::warn("[VolumetricTerrain] The density field can't be evaluated on the GPU with OpenGL ES; the CPU will be used.");
+#endif
+}
+
+void VolumetricTerrain::generate(unsigned int width, unsigned int depth, float heightFactor, float flatness) {
+  ZoneScopedN("VolumetricTerrain::generate");
+
+  const auto startTime = std::chrono::steady_clock::now();
+
+  m_width = width;
+  m_depth = depth;
+  Terrain::setParameters(heightFactor, flatness);
+
+  // One more sample is added above the maximal height, so that the surface is always closed on top
+  m_sampleHeight = static_cast<unsigned int>(std::ceil(m_heightFactor / voxelSize)) + 2;
+
+  // Without GPU evaluation, the densities are computed directly by each chunk
+  if (m_useGpuDensity)
+    computeGpuNoise();
+  else
+    m_noiseValues.clear();
+
+  const unsigned int chunkCountX = (m_width + m_chunkSize - 1) / m_chunkSize;
+  const unsigned int chunkCountZ = (m_depth + m_chunkSize - 1) / m_chunkSize;
+  const std::size_t chunkCount   = static_cast<std::size_t>(chunkCountX) * chunkCountZ;
+
+  // Each chunk is stored in its own submesh, so that they can all be meshed at the same time without any synchronization
+  auto& mesh = m_entity.getComponent<Raz::Mesh>();
+  mesh.getSubmeshes().clear();
+  mesh.getSubmeshes().resize(chunkCount);
+
+  Raz::Threading::parallelize(0, chunkCount, [this, chunkCountX] (const Raz::Threading::IndexRange& range) noexcept {
+    ZoneScopedN("VolumetricTerrain::generate");
+
+    std::vector<float> chunkDensities;
+
+    for (std::size_t chunkIndex = range.beginIndex; chunkIndex < range.endIndex; ++chunkIndex) {
+      const auto chunkX = static_cast<unsigned int>(chunkIndex % chunkCountX);
+      const auto chunkZ = static_cast<unsigned int>(chunkIndex / chunkCountX);
+
+      computeChunkDensities(chunkX, chunkZ, m_noiseValues, chunkDensities);
+      meshChunk(chunkX, chunkZ, chunkDensities, chunkIndex);
+    }
+  });
+
+  if (m_entity.hasComponent<Raz::MeshRenderer>()) {
+    auto& meshRenderer = m_entity.getComponent<Raz::MeshRenderer>();
+    meshRenderer.load(mesh);
+    meshRenderer.getMaterials().front().getProgram().setAttribute(rockColor, Raz::MaterialAttribute::BaseColor);
+    meshRenderer.getMaterials().front().getProgram().sendAttributes();
+  }
+
+  const std::chrono::duration<float> generationTime = std::chrono::steady_clock::now() - startTime;
+  m_lastChunksPerSecond = static_cast<float>(chunkCount) / generationTime.count();
+
+  Raz::Logger::debug("[VolumetricTerrain] Generated " + std::to_string(chunkCount) + " chunks in " + std::to_string(generationTime.count() * 1000.f)
+                   + " ms (" + std::to_string(m_lastChunksPerSecond) + " chunks/s, density on the " + (m_useGpuDensity ? "GPU" : "CPU") + ").");
+}
+
+float VolumetricTerrain::computeDensity(float x, float y, float z) const {
+  // The density is positive inside the terrain & negative outside; the noise varying vertically as well, a column can cross the surface several times
+  const float noiseValue = Raz::PerlinNoise::compute3D(x * noiseFactor, y * noiseFactor, z * noiseFactor, octaveCount, true);
+  return std::pow(noiseValue, m_flatness) - (y * voxelSize) / m_heightFactor;
+}
+
+void VolumetricTerrain::computeGpuNoise() {
+#if !defined(USE_OPENGL_ES)
+  ZoneScopedN("VolumetricTerrain::computeGpuNoise");
+  TracyGpuZone("VolumetricTerrain::computeGpuNoise")
+
+  const unsigned int sampleCountY = m_sampleHeight + 1;
+
+  if (m_noiseProgram == nullptr) {
+    m_noiseMap = Raz::Texture3D::create(m_width, sampleCountY, m_depth, Raz::TextureColorspace::GRAY, Raz::TextureDataType::FLOAT16);
+
+    m_noiseProgram = std::make_unique<Raz::ComputeShaderProgram>(Raz::ComputeShader::loadFromSource(noiseCompSource));
+    m_noiseProgram->setAttribute(noiseFactor, "uniNoiseFactor");
+    m_noiseProgram->setAttribute(static_cast<int>(octaveCount), "uniOctaveCount");
+    m_noiseProgram->sendAttributes();
+    m_noiseProgram->setImageTexture(m_noiseMap, "uniNoiseMap", Raz::ImageTextureUsage::WRITE);
+  } else if (m_noiseMap->getWidth() != m_width || m_noiseMap->getHeight() != sampleCountY || m_noiseMap->getDepth() != m_depth) {
+    // The height factor changes the number of vertical samples; the texture is only reallocated in this case or if the terrain's size changes
+    m_noiseMap->resize(m_width, sampleCountY, m_depth);
+  }
+
+  m_noiseProgram->execute(m_width, sampleCountY, m_depth);
+
+  m_noiseValues.resize(static_cast<std::size_t>(m_width) * sampleCountY * m_depth);
+
+  // The meshing needs every value right away, there is thus nothing else to do while the shader is being executed & the read back has to wait for it
+  glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+  m_noiseMap->bind();
+  glGetTexImage(GL_TEXTURE_3D, 0, GL_RED, GL_FLOAT, m_noiseValues.data());
+  m_noiseMap->unbind();
+
+  // The noise values are converted to densities when copied into each chunk
+#endif
+}
+
+void VolumetricTerrain::computeChunkDensities(unsigned int chunkX, unsigned int chunkZ,
+                                              const std::vector<float>& volumeDensities, std::vector<float>& chunkDensities) const {
+  ZoneScopedN("VolumetricTerrain::computeChunkDensities");
+
+  // A chunk needs the samples of its own cells, plus one on each horizontal side to connect to its neighbors
+  const unsigned int sampleCountXZ = m_chunkSize + 2;
+  const unsigned int sampleCountY  = m_sampleHeight + 1;
+  chunkDensities.resize(static_cast<std::size_t>(sampleCountXZ) * sampleCountY * sampleCountXZ);
+
+  const int firstSampleX = static_cast<int>(chunkX * m_chunkSize) - 1;
+  const int firstSampleZ = static_cast<int>(chunkZ * m_chunkSize) - 1;
+
+  for (unsigned int localZ = 0; localZ < sampleCountXZ; ++localZ) {
+    const int sampleZ = firstSampleZ + static_cast<int>(localZ);
+
+    for (unsigned int y = 0; y < sampleCountY; ++y) {
+      const float heightOffset = (static_cast<float>(y) * voxelSize) / m_heightFactor;
+      float* densities = chunkDensities.data() + (static_cast<std::size_t>(localZ) * sampleCountY + y) * sampleCountXZ;
+
+      for (unsigned int localX = 0; localX < sampleCountXZ; ++localX) {
+        const int sampleX = firstSampleX + static_cast<int>(localX);
+
+        if (volumeDensities.empty()) {
+          densities[localX] = computeDensity(static_cast<float>(sampleX), static_cast<float>(y), static_cast<float>(sampleZ));
+          continue;
+        }
+
+        // Samples outside of the evaluated volume are only used to compute vertices of cells which won't be connected; clamping is enough
+        const auto clampedX = static_cast<std::size_t>(std::clamp(sampleX, 0, static_cast<int>(m_width) - 1));
+        const auto clampedZ = static_cast<std::size_t>(std::clamp(sampleZ, 0, static_cast<int>(m_depth) - 1));
+        const float noiseValue = volumeDensities[(clampedZ * sampleCountY + y) * m_width + clampedX];
+
+        densities[localX] = std::pow(noiseValue, m_flatness) - heightOffset;
+      }
+    }
+  }
+}
+
+void VolumetricTerrain::meshChunk(unsigned int chunkX, unsigned int chunkZ, const std::vector<float>& chunkDensities, std::size_t submeshIndex) {
+  ZoneScopedN("VolumetricTerrain::meshChunk");
+
+  // Surface nets: a single vertex is placed in each cell crossed by the surface, & each sample edge crossed by the surface is turned
+  //  into a quad joining the 4 cells around it. Vertices are thus shared by construction between all the faces of adjacent cells
+
+  const unsigned int sampleCountXZ = m_chunkSize + 2;
+  const unsigned int sampleCountY  = m_sampleHeight + 1;
+  const unsigned int cellCountXZ   = m_chunkSize + 1;
+  const unsigned int cellCountY    = m_sampleHeight;
+
+  const auto computeSampleIndex = [sampleCountXZ, sampleCountY] (unsigned int x, unsigned int y, unsigned int z) noexcept {
+    return (static_cast<std::size_t>(z) * sampleCountY + y) * sampleCountXZ + x;
+  };
+  const auto computeCellIndex = [cellCountXZ, cellCountY] (unsigned int x, unsigned int y, unsigned int z) noexcept {
+    return (static_cast<std::size_t>(z) * cellCountY + y) * cellCountXZ + x;
+  };
+
+  const int firstCellX = static_cast<int>(chunkX * m_chunkSize) - 1;
+  const int firstCellZ = static_cast<int>(chunkZ * m_chunkSize) - 1;
+
+  Raz::Submesh& submesh = m_entity.getComponent<Raz::Mesh>().getSubmeshes()[submeshIndex];
+  std::vector<Raz::Vertex>& vertices = submesh.getVertices();
+  std::vector<unsigned int>& indices = submesh.getTriangleIndices();
+
+  // Computing the vertex of each cell crossed by the surface
+
+  std::vector<unsigned int> cellVertexIndices(static_cast<std::size_t>(cellCountXZ) * cellCountY * cellCountXZ, invalidVertex);
+
+  for (unsigned int cellZ = 0; cellZ < cellCountXZ; ++cellZ) {
+    const int globalCellZ = firstCellZ + static_cast<int>(cellZ);
+
+    if (globalCellZ < 0 || globalCellZ >= static_cast<int>(m_depth) - 1)
+      continue;
+
+    for (unsigned int cellY = 0; cellY < cellCountY; ++cellY) {
+      for (unsigned int cellX = 0; cellX < cellCountXZ; ++cellX) {
+        const int globalCellX = firstCellX + static_cast<int>(cellX);
+
+        if (globalCellX < 0 || globalCellX >= static_cast<int>(m_width) - 1)
+          continue;
+
+        std::array<float, 8> cornerDensities {};
+        unsigned int insideCornerCount = 0;
+
+        for (std::size_t cornerIndex = 0; cornerIndex < cellCorners.size(); ++cornerIndex) {
+          const std::array<unsigned int, 3>& corner = cellCorners[cornerIndex];
+          cornerDensities[cornerIndex] = chunkDensities[computeSampleIndex(cellX + corner[0], cellY + corner[1], cellZ + corner[2])];
+          insideCornerCount += (cornerDensities[cornerIndex] > 0.f);
+        }
+
+        if (insideCornerCount == 0 || insideCornerCount == cellCorners.size())
+          continue;
+
+        // Placing the vertex at the average of the points where the surface crosses the cell's edges
+        Raz::Vec3f vertexOffset;
+        unsigned int crossingCount = 0;
+
+        for (const std::array<unsigned int, 2>& edge : cellEdges) {
+          const float firstDensity  = cornerDensities[edge[0]];
+          const float secondDensity = cornerDensities[edge[1]];
+
+          if ((firstDensity > 0.f) == (secondDensity > 0.f))
+            continue;
+
+          const float crossingCoeff = firstDensity / (firstDensity - secondDensity);
+          const std::array<unsigned int, 3>& firstCorner  = cellCorners[edge[0]];
+          const std::array<unsigned int, 3>& secondCorner = cellCorners[edge[1]];
+
+          vertexOffset += Raz::Vec3f(static_cast<float>(firstCorner[0]), static_cast<float>(firstCorner[1]), static_cast<float>(firstCorner[2]))
+                        + Raz::Vec3f(static_cast<float>(secondCorner[0]) - static_cast<float>(firstCorner[0]),
+                                     static_cast<float>(secondCorner[1]) - static_cast<float>(firstCorner[1]),
+                                     static_cast<float>(secondCorner[2]) - static_cast<float>(firstCorner[2])) * crossingCoeff;
+          ++crossingCount;
+        }
+
+        vertexOffset /= static_cast<float>(crossingCount);
+
+        // The normal points towards decreasing densities, that is outside of the terrain
+        const Raz::Vec3f densityGradient((cornerDensities[1] + cornerDensities[3] + cornerDensities[5] + cornerDensities[7])
+                                       - (cornerDensities[0] + cornerDensities[2] + cornerDensities[4] + cornerDensities[6]),
+                                         (cornerDensities[2] + cornerDensities[3] + cornerDensities[6] + cornerDensities[7])
+                                       - (cornerDensities[0] + cornerDensities[1] + cornerDensities[4] + cornerDensities[5]),
+                                         (cornerDensities[4] + cornerDensities[5] + cornerDensities[6] + cornerDensities[7])
+                                       - (cornerDensities[0] + cornerDensities[1] + cornerDensities[2] + cornerDensities[3]));
+        const float gradientLength = densityGradient.computeLength();
+
+        const float sampleX = static_cast<float>(globalCellX) + vertexOffset.x();
+        const float sampleY = static_cast<float>(cellY) + vertexOffset.y();
+        const float sampleZ = static_cast<float>(globalCellZ) + vertexOffset.z();
+
+        Raz::Vertex vertex;
+        vertex.position  = Raz::Vec3f((sampleX - static_cast<float>(m_width) * 0.5f) * voxelSize,
+                                      sampleY * voxelSize,
+                                      (sampleZ - static_cast<float>(m_depth) * 0.5f) * voxelSize);
+        vertex.texcoords = Raz::Vec2f(sampleX / static_cast<float>(m_width), sampleZ / static_cast<float>(m_depth));
+        vertex.normal    = (gradientLength > 0.f ? -densityGradient / gradientLength : Raz::Axis::Y);
+        vertex.tangent   = Raz::Vec3f(vertex.normal.z(), vertex.normal.x(), vertex.normal.y());
+
+        cellVertexIndices[computeCellIndex(cellX, cellY, cellZ)] = static_cast<unsigned int>(vertices.size());
+        vertices.emplace_back(vertex);
+      }
+    }
+  }
+
+  // Creating a quad for each edge crossed by the surface. A chunk only handles the edges starting from its own samples, so that none is created twice
+  //  The quad's cells are ordered counterclockwise around the edge's axis, & reversed if the edge goes from outside to inside the terrain
+
+  const auto addQuad = [&cellVertexIndices, &indices] (std::array<std::size_t, 4> cellIndices, bool startsInside) {
+    std::array<unsigned int, 4> quadIndices {};
+
+    for (std::size_t i = 0; i < 4; ++i) {
+      quadIndices[i] = cellVertexIndices[cellIndices[i]];
+
+      if (quadIndices[i] == invalidVertex)
+        return;
+    }
+
+    if (!startsInside)
+      std::swap(quadIndices[1], quadIndices[3]);
+
+    indices.insert(indices.end(), { quadIndices[0], quadIndices[1], quadIndices[2], quadIndices[0], quadIndices[2], quadIndices[3] });
+  };
+
+  for (unsigned int sampleZ = 1; sampleZ < sampleCountXZ - 1; ++sampleZ) {
+    for (unsigned int sampleY = 0; sampleY < sampleCountY; ++sampleY) {
+      for (unsigned int sampleX = 1; sampleX < sampleCountXZ - 1; ++sampleX) {
+        const bool isInside = (chunkDensities[computeSampleIndex(sampleX, sampleY, sampleZ)] > 0.f);
+
+        // Edge along X, surrounded by cells in the YZ plane
+        if (sampleY > 0 && sampleY < cellCountY && isInside != (chunkDensities[computeSampleIndex(sampleX + 1, sampleY, sampleZ)] > 0.f)) {
+          addQuad({ computeCellIndex(sampleX, sampleY - 1, sampleZ - 1), computeCellIndex(sampleX, sampleY, sampleZ - 1),
+                    computeCellIndex(sampleX, sampleY,     sampleZ),     computeCellIndex(sampleX, sampleY - 1, sampleZ) }, isInside);
+        }
+
+        // Edge along Y, surrounded by cells in the ZX plane
+        if (sampleY < cellCountY && isInside != (chunkDensities[computeSampleIndex(sampleX, sampleY + 1, sampleZ)] > 0.f)) {
+          addQuad({ computeCellIndex(sampleX - 1, sampleY, sampleZ - 1), computeCellIndex(sampleX - 1, sampleY, sampleZ),
+                    computeCellIndex(sampleX,     sampleY, sampleZ),     computeCellIndex(sampleX, sampleY, sampleZ - 1) }, isInside);
+        }
+
+        // Edge along Z, surrounded by cells in the XY plane
+        if (sampleY > 0 && sampleY < cellCountY && isInside != (chunkDensities[computeSampleIndex(sampleX, sampleY, sampleZ + 1)] > 0.f)) {
+          addQuad({ computeCellIndex(sampleX - 1, sampleY - 1, sampleZ), computeCellIndex(sampleX, sampleY - 1, sampleZ),
+                    computeCellIndex(sampleX,     sampleY,     sampleZ), computeCellIndex(sampleX - 1, sampleY, sampleZ) }, isInside);
+        }
+      }
+    }
+  }
+}